@@ -0,0 +1,375 @@
+/*
+   xxHash - Extremely Fast Hash algorithm
+   Cache-blocked Bloom filter, header-only companion module
+   Copyright (C) 2012-2016, Yann Collet.
+
+   BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are
+   met:
+
+       * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+       * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following disclaimer
+   in the documentation and/or other materials provided with the
+   distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+   You can contact the author at :
+   - xxHash source repository : https://github.com/Cyan4973/xxHash
+*/
+
+/* Usage :
+ *     XXH_bloom_t* const bf = XXH_bloom_create(nbKeys, 10, 0);   (10 bits per key : ~1% false positives)
+ *     XXH_bloom_add(bf, key, keyLength);
+ *     if (XXH_bloom_mayContain(bf, key, keyLength)) { ... }
+ *     XXH_bloom_free(bf);
+ *
+ * Each key is hashed once, with XXH64().
+ * The upper 32 bits select a 64-byte block (one cache line),
+ * the lower 32 bits drive all probes within this block, by double hashing.
+ * A lookup therefore costs one hash and one cache miss, whatever the number of probes,
+ * for a false positive rate slightly higher than a classic Bloom filter of the same size.
+ *
+ * Keys hashed by other means can be used with the *Hash() variants,
+ * as long as a given filter is always fed with the same 64-bit hash function.
+ * XXH64_auto() results may depend on the CPU : don't use them for serialized filters.
+ */
+
+#ifndef XXH_BLOOM_H_8273460291
+#define XXH_BLOOM_H_8273460291
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>   /* size_t */
+#include <stdlib.h>   /* malloc, free */
+#include <string.h>   /* memset, memcpy */
+#include "xxh_common.h"
+
+#ifdef XXH_NO_LONG_LONG
+#  error xxh_bloom.h requires XXH64
+#endif
+
+
+/* ****************************
+ *  Definitions
+ ******************************/
+#define XXH_BLOOM_BLOCK_SIZE   64   /* bytes : one cache line */
+#define XXH_BLOOM_BLOCK_WORDS  (XXH_BLOOM_BLOCK_SIZE / 4)
+#define XXH_BLOOM_MAX_PROBES   16
+#define XXH_BLOOM_HEADER_SIZE  24   /* serialized header */
+
+typedef struct {
+    XXH32_hash_t* blocks;      /* nbBlocks * XXH_BLOOM_BLOCK_WORDS, aligned on XXH_BLOOM_BLOCK_SIZE */
+    void*         allocation;  /* for free() */
+    size_t        nbBlocks;    /* < 2^32 */
+    unsigned      nbProbes;    /* bits set per key, 1 - XXH_BLOOM_MAX_PROBES */
+    unsigned long long seed;
+} XXH_bloom_t;
+
+
+/* ****************************
+ *  Creation
+ ******************************/
+XXH_HEADER_API XXH_bloom_t* XXH_bloom_createBlocks(size_t nbBlocks, unsigned nbProbes, unsigned long long seed)
+{
+    XXH_bloom_t* bf;
+    if ((nbBlocks == 0) || ((unsigned long long)nbBlocks > 0xFFFFFFFFULL)) return NULL;
+    if (nbBlocks > ((size_t)-1 - XXH_BLOOM_BLOCK_SIZE) / XXH_BLOOM_BLOCK_SIZE) return NULL;
+    if ((nbProbes == 0) || (nbProbes > XXH_BLOOM_MAX_PROBES)) return NULL;
+    bf = (XXH_bloom_t*)malloc(sizeof(XXH_bloom_t));
+    if (bf == NULL) return NULL;
+    bf->allocation = malloc(nbBlocks * XXH_BLOOM_BLOCK_SIZE + XXH_BLOOM_BLOCK_SIZE - 1);
+    if (bf->allocation == NULL) { free(bf); return NULL; }
+    {   size_t const misalign = (size_t)bf->allocation & (XXH_BLOOM_BLOCK_SIZE - 1);
+        void* const start = (char*)bf->allocation + (misalign ? XXH_BLOOM_BLOCK_SIZE - misalign : 0);
+        bf->blocks = (XXH32_hash_t*)start;
+    }
+    memset(bf->blocks, 0, nbBlocks * XXH_BLOOM_BLOCK_SIZE);
+    bf->nbBlocks = nbBlocks;
+    bf->nbProbes = nbProbes;
+    bf->seed = seed;
+    return bf;
+}
+
+/*! XXH_bloom_create() :
+ *  Sized for `nbKeys` keys, with `bitsPerKey` bits each (rounded up to whole blocks).
+ *  The number of probes is bitsPerKey * ln(2), which minimizes false positives.
+ *  As a guide : 8 bits per key give ~2.5% false positives, 10 ~1.2%, 16 ~0.1%.
+ *  @return : NULL on invalid parameters or allocation failure */
+XXH_HEADER_API XXH_bloom_t* XXH_bloom_create(size_t nbKeys, unsigned bitsPerKey, unsigned long long seed)
+{
+    unsigned nbProbes = (bitsPerKey * 69 + 50) / 100;
+    size_t nbBits;
+    if (bitsPerKey == 0) return NULL;
+    if (nbKeys > ((size_t)-1 - XXH_BLOOM_BLOCK_SIZE * 8) / bitsPerKey) return NULL;
+    nbBits = (nbKeys ? nbKeys : 1) * bitsPerKey;
+    if (nbProbes < 1) nbProbes = 1;
+    if (nbProbes > XXH_BLOOM_MAX_PROBES) nbProbes = XXH_BLOOM_MAX_PROBES;
+    return XXH_bloom_createBlocks((nbBits + XXH_BLOOM_BLOCK_SIZE * 8 - 1) / (XXH_BLOOM_BLOCK_SIZE * 8), nbProbes, seed);
+}
+
+XXH_HEADER_API void XXH_bloom_free(XXH_bloom_t* bf)
+{
+    if (bf == NULL) return;
+    free(bf->allocation);
+    free(bf);
+}
+
+XXH_HEADER_API void XXH_bloom_clear(XXH_bloom_t* bf)
+{
+    memset(bf->blocks, 0, bf->nbBlocks * XXH_BLOOM_BLOCK_SIZE);
+}
+
+
+/* ****************************
+ *  Block operations
+ ******************************/
+XXH_HEADER_API XXH32_hash_t* XXH_bloom_block(const XXH_bloom_t* bf, XXH64_hash_t hash)
+{
+    size_t const blockNb = (size_t)(((hash >> 32) * (unsigned long long)bf->nbBlocks) >> 32);
+    return bf->blocks + blockNb * XXH_BLOOM_BLOCK_WORDS;
+}
+
+/* XXH_bloom_mask() :
+ * sets nbProbes bits of a block-sized mask, from the lower 32 bits of `hash`,
+ * with enhanced double hashing (the stride also changes, limiting clustering) */
+XXH_HEADER_API void XXH_bloom_mask(XXH32_hash_t mask[XXH_BLOOM_BLOCK_WORDS], XXH64_hash_t hash, unsigned nbProbes)
+{
+    XXH32_hash_t a = (XXH32_hash_t)hash;
+    XXH32_hash_t b = (a >> 16) | 1;   /* odd : visits all positions */
+    unsigned i;
+    memset(mask, 0, XXH_BLOOM_BLOCK_SIZE);
+    for (i=0; i<nbProbes; i++) {
+        XXH32_hash_t const bit = a & (XXH_BLOOM_BLOCK_SIZE * 8 - 1);
+        mask[bit >> 5] |= (XXH32_hash_t)1 << (bit & 31);
+        a += b;
+        b += i;
+    }
+}
+
+XXH_HEADER_API void XXH_bloom_orBlock(XXH32_hash_t* block, const XXH32_hash_t* mask)
+{
+#if defined(XXH_COMMON_SSE2)
+    int w;
+    for (w=0; w<XXH_BLOOM_BLOCK_WORDS; w+=4) {
+        __m128i* const b = (__m128i*)(void*)(block + w);
+        _mm_store_si128(b, _mm_or_si128(_mm_load_si128(b), _mm_loadu_si128((const __m128i*)(const void*)(mask + w))));
+    }
+#elif defined(XXH_COMMON_NEON)
+    int w;
+    for (w=0; w<XXH_BLOOM_BLOCK_WORDS; w+=4)
+        vst1q_u32(block + w, vorrq_u32(vld1q_u32(block + w), vld1q_u32(mask + w)));
+#else
+    int w;
+    for (w=0; w<XXH_BLOOM_BLOCK_WORDS; w++) block[w] |= mask[w];
+#endif
+}
+
+/* XXH_bloom_testBlock() : @return : 1 if all bits of `mask` are set in `block` */
+XXH_HEADER_API int XXH_bloom_testBlock(const XXH32_hash_t* block, const XXH32_hash_t* mask)
+{
+#if defined(XXH_COMMON_SSE2)
+    __m128i missing = _mm_setzero_si128();
+    int w;
+    for (w=0; w<XXH_BLOOM_BLOCK_WORDS; w+=4) {
+        __m128i const m = _mm_loadu_si128((const __m128i*)(const void*)(mask + w));
+        missing = _mm_or_si128(missing, _mm_andnot_si128(_mm_load_si128((const __m128i*)(const void*)(block + w)), m));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) == 0xFFFF;
+#elif defined(XXH_COMMON_NEON)
+    uint32x4_t missing = vdupq_n_u32(0);
+    uint32x2_t folded;
+    int w;
+    for (w=0; w<XXH_BLOOM_BLOCK_WORDS; w+=4)
+        missing = vorrq_u32(missing, vbicq_u32(vld1q_u32(mask + w), vld1q_u32(block + w)));
+    folded = vorr_u32(vget_low_u32(missing), vget_high_u32(missing));
+    return (vget_lane_u32(folded, 0) | vget_lane_u32(folded, 1)) == 0;
+#else
+    XXH32_hash_t missing = 0;
+    int w;
+    for (w=0; w<XXH_BLOOM_BLOCK_WORDS; w++) missing |= mask[w] & ~block[w];
+    return missing == 0;
+#endif
+}
+
+
+/* ****************************
+ *  Insertion and lookup
+ ******************************/
+XXH_HEADER_API void XXH_bloom_addHash(XXH_bloom_t* bf, XXH64_hash_t hash)
+{
+    XXH32_hash_t mask[XXH_BLOOM_BLOCK_WORDS];
+    XXH_bloom_mask(mask, hash, bf->nbProbes);
+    XXH_bloom_orBlock(XXH_bloom_block(bf, hash), mask);
+}
+
+/*! XXH_bloom_mayContainHash() :
+ *  @return : 0 if `hash` was never added, 1 if it probably was */
+XXH_HEADER_API int XXH_bloom_mayContainHash(const XXH_bloom_t* bf, XXH64_hash_t hash)
+{
+    XXH32_hash_t mask[XXH_BLOOM_BLOCK_WORDS];
+    XXH_bloom_mask(mask, hash, bf->nbProbes);
+    return XXH_bloom_testBlock(XXH_bloom_block(bf, hash), mask);
+}
+
+XXH_HEADER_API void XXH_bloom_add(XXH_bloom_t* bf, const void* key, size_t length)
+{
+    XXH_bloom_addHash(bf, XXH64(key, length, bf->seed));
+}
+
+XXH_HEADER_API int XXH_bloom_mayContain(const XXH_bloom_t* bf, const void* key, size_t length)
+{
+    return XXH_bloom_mayContainHash(bf, XXH64(key, length, bf->seed));
+}
+
+/* XXH_bloom_prefetch() : block of `hash`, for XXH_hashBatch() */
+XXH_HEADER_API void XXH_bloom_prefetch(const void* bf, XXH64_hash_t hash)
+{
+    XXH_PREFETCH(XXH_bloom_block((const XXH_bloom_t*)bf, hash));
+}
+
+/*! XXH_bloom_addBatch() :
+ *  Same as XXH_bloom_add() over `nbKeys` keys.
+ *  Keys are hashed XXH_BATCH at a time, and their blocks prefetched before use,
+ *  so that cache misses overlap. */
+XXH_HEADER_API void XXH_bloom_addBatch(XXH_bloom_t* bf, const void* const* keys, const size_t* lengths, size_t nbKeys)
+{
+    XXH64_hash_t hashes[XXH_BATCH];
+    size_t start, end;
+    for (start=0; start<nbKeys; start=end) {
+        size_t n;
+        end = XXH_hashBatch(hashes, keys, lengths, nbKeys, start, bf->seed, XXH_bloom_prefetch, bf);
+        for (n=start; n<end; n++) XXH_bloom_addHash(bf, hashes[n-start]);
+    }
+}
+
+/*! XXH_bloom_mayContainBatch() :
+ *  Same as XXH_bloom_mayContain() over `nbKeys` keys, hashed and prefetched like XXH_bloom_addBatch().
+ *  `results` : one byte per key, set to XXH_bloom_mayContain() result.
+ *  @return : number of keys which may be contained */
+XXH_HEADER_API size_t XXH_bloom_mayContainBatch(const XXH_bloom_t* bf, const void* const* keys, const size_t* lengths,
+                                                size_t nbKeys, unsigned char* results)
+{
+    XXH64_hash_t hashes[XXH_BATCH];
+    size_t nbPositives = 0;
+    size_t start, end;
+    for (start=0; start<nbKeys; start=end) {
+        size_t n;
+        end = XXH_hashBatch(hashes, keys, lengths, nbKeys, start, bf->seed, XXH_bloom_prefetch, bf);
+        for (n=start; n<end; n++) {
+            int const r = XXH_bloom_mayContainHash(bf, hashes[n-start]);
+            results[n] = (unsigned char)r;
+            nbPositives += (size_t)r;
+    }   }
+    return nbPositives;
+}
+
+/*! XXH_bloom_merge() :
+ *  Adds all keys of `src` into `dst`. Both filters must have the same size, probes and seed.
+ *  @return : 0 on success, 1 if filters are not compatible */
+XXH_HEADER_API int XXH_bloom_merge(XXH_bloom_t* dst, const XXH_bloom_t* src)
+{
+    size_t b;
+    if ((dst->nbBlocks != src->nbBlocks) || (dst->nbProbes != src->nbProbes) || (dst->seed != src->seed)) return 1;
+    for (b=0; b<dst->nbBlocks; b++)
+        XXH_bloom_orBlock(dst->blocks + b * XXH_BLOOM_BLOCK_WORDS, src->blocks + b * XXH_BLOOM_BLOCK_WORDS);
+    return 0;
+}
+
+
+/* ****************************
+ *  Serialization
+ ******************************/
+/* Format, all values little endian :
+ *  4 bytes  magic "XXB1"
+ *  1 byte   nbProbes, followed by 3 zero bytes
+ *  8 bytes  seed
+ *  8 bytes  nbBlocks
+ *  nbBlocks * XXH_BLOOM_BLOCK_SIZE bytes : blocks, as 32-bit words */
+static const unsigned char XXH_bloom_magic[4] = { 'X', 'X', 'B', '1' };
+
+XXH_HEADER_API void XXH_bloom_writeLE64(unsigned char* dst, unsigned long long v)
+{
+    int i;
+    for (i=0; i<8; i++) dst[i] = (unsigned char)(v >> (8*i));
+}
+
+XXH_HEADER_API unsigned long long XXH_bloom_readLE64(const unsigned char* src)
+{
+    unsigned long long v = 0;
+    int i;
+    for (i=7; i>=0; i--) v = (v << 8) | src[i];
+    return v;
+}
+
+XXH_HEADER_API size_t XXH_bloom_serializedSize(const XXH_bloom_t* bf)
+{
+    return XXH_BLOOM_HEADER_SIZE + bf->nbBlocks * XXH_BLOOM_BLOCK_SIZE;
+}
+
+/*! XXH_bloom_serialize() :
+ *  @return : nb of bytes written into `dst`, or 0 if `dstCapacity` is too small */
+XXH_HEADER_API size_t XXH_bloom_serialize(const XXH_bloom_t* bf, void* dst, size_t dstCapacity)
+{
+    unsigned char* const out = (unsigned char*)dst;
+    size_t const nbWords = bf->nbBlocks * XXH_BLOOM_BLOCK_WORDS;
+    size_t w;
+    if (dstCapacity < XXH_bloom_serializedSize(bf)) return 0;
+    memcpy(out, XXH_bloom_magic, 4);
+    out[4] = (unsigned char)bf->nbProbes;
+    out[5] = out[6] = out[7] = 0;
+    XXH_bloom_writeLE64(out + 8, bf->seed);
+    XXH_bloom_writeLE64(out + 16, (unsigned long long)bf->nbBlocks);
+    for (w=0; w<nbWords; w++) {
+        unsigned char* const p = out + XXH_BLOOM_HEADER_SIZE + 4*w;
+        XXH32_hash_t const v = bf->blocks[w];
+        p[0] = (unsigned char)v; p[1] = (unsigned char)(v >> 8); p[2] = (unsigned char)(v >> 16); p[3] = (unsigned char)(v >> 24);
+    }
+    return XXH_bloom_serializedSize(bf);
+}
+
+/*! XXH_bloom_deserialize() :
+ *  @return : a new filter, to be released with XXH_bloom_free(),
+ *            or NULL if `src` is not a valid serialized filter, or on allocation failure */
+XXH_HEADER_API XXH_bloom_t* XXH_bloom_deserialize(const void* src, size_t srcSize)
+{
+    const unsigned char* const in = (const unsigned char*)src;
+    unsigned long long nbBlocks;
+    XXH_bloom_t* bf;
+    size_t w;
+    if (srcSize < XXH_BLOOM_HEADER_SIZE) return NULL;
+    if (memcmp(in, XXH_bloom_magic, 4) || in[5] || in[6] || in[7]) return NULL;
+    nbBlocks = XXH_bloom_readLE64(in + 16);
+    if ((nbBlocks == 0) || (nbBlocks > (srcSize - XXH_BLOOM_HEADER_SIZE) / XXH_BLOOM_BLOCK_SIZE)) return NULL;
+    if (srcSize != XXH_BLOOM_HEADER_SIZE + (size_t)nbBlocks * XXH_BLOOM_BLOCK_SIZE) return NULL;
+    bf = XXH_bloom_createBlocks((size_t)nbBlocks, in[4], XXH_bloom_readLE64(in + 8));
+    if (bf == NULL) return NULL;
+    for (w=0; w<bf->nbBlocks * XXH_BLOOM_BLOCK_WORDS; w++) {
+        const unsigned char* const p = in + XXH_BLOOM_HEADER_SIZE + 4*w;
+        bf->blocks[w] = (XXH32_hash_t)p[0] | ((XXH32_hash_t)p[1] << 8) | ((XXH32_hash_t)p[2] << 16) | ((XXH32_hash_t)p[3] << 24);
+    }
+    return bf;
+}
+
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* XXH_BLOOM_H_8273460291 */
@@ -0,0 +1,505 @@
+/*
+   xxHash - Extremely Fast Hash algorithm
+   Count-min sketch and top-k tracker, header-only companion module
+   Copyright (C) 2012-2016, Yann Collet.
+
+   BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are
+   met:
+
+       * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+       * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following disclaimer
+   in the documentation and/or other materials provided with the
+   distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+   You can contact the author at :
+   - xxHash source repository : https://github.com/Cyan4973/xxHash
+*/
+
+/* Usage :
+ *     XXH_cms_t* const cms = XXH_cms_create(1 << 16, 4, XXH_cms_countMin, 0);
+ *     XXH_cms_update(cms, item, itemLength, 1);
+ *     printf("~%lld occurrences \n", XXH_cms_estimate(cms, item, itemLength));
+ *     XXH_cms_free(cms);
+ *
+ * Each item is hashed once, with XXH64(), whatever the depth (number of rows).
+ * Row indexes are derived from the 2 halves of the hash by enhanced double hashing :
+ * row i uses the upper bits of g(i) = a + i*b + i(i-1)(i-2)/6 (32-bit arithmetic).
+ *
+ * Two kinds of sketches :
+ * - XXH_cms_countMin : counters only increase. Estimates never underestimate,
+ *                      and overestimate by at most e*N/width with probability 1 - e^-depth,
+ *                      N being the total of all counts. Conservative update reduces overestimation.
+ * - XXH_cms_countSketch : each row adds +count or -count, depending on one more bit of g(i).
+ *                      The estimate is the median of rows : unbiased, but can underestimate.
+ * Counters are 32-bit, and wrap around beyond 2^32.
+ *
+ * XXH_topk_t tracks the most frequent items of a stream with SpaceSaving :
+ * k monitored items, the least frequent one being replaced by each new item.
+ * Any item more frequent than N/k is monitored.
+ *
+ * The *Hash() variants take an XXH64() result computed by the caller,
+ * so that a single hash can feed a sketch and a top-k tracker.
+ * All sketches and trackers fed with the same items must use the same seed.
+ */
+
+#ifndef XXH_CMS_H_6193820457
+#define XXH_CMS_H_6193820457
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>   /* size_t */
+#include <stdlib.h>   /* malloc, calloc, free, qsort */
+#include <string.h>   /* memset, memcpy */
+#include "xxh_common.h"
+
+#ifdef XXH_NO_LONG_LONG
+#  error xxh_cms.h requires XXH64
+#endif
+
+
+/* ****************************
+ *  Count-min sketch
+ ******************************/
+#define XXH_CMS_MIN_WIDTH_LOG  4
+#define XXH_CMS_MAX_WIDTH_LOG 28
+#define XXH_CMS_MAX_DEPTH     16
+
+typedef enum { XXH_cms_countMin, XXH_cms_countSketch } XXH_cms_kind_e;
+
+typedef struct {
+    XXH32_hash_t* counters;   /* depth rows of width counters */
+    size_t   width;           /* power of 2 */
+    unsigned widthLog;
+    unsigned depth;           /* 1 - XXH_CMS_MAX_DEPTH */
+    XXH_cms_kind_e kind;
+    unsigned long long seed;
+} XXH_cms_t;
+
+/*! XXH_cms_create() :
+ *  `width` : counters per row, rounded up to a power of 2, from 2^4 to 2^28.
+ *            Overestimation of XXH_cms_countMin is ~ 2.7 * N / width (N : total of all counts).
+ *  `depth` : nb of rows, 1 - 16. Failure probability is ~ e^-depth (4 : ~2%).
+ *  @return : NULL on invalid parameters, if the counters don't fit in memory, or on allocation failure */
+XXH_HEADER_API XXH_cms_t* XXH_cms_create(size_t width, unsigned depth, XXH_cms_kind_e kind, unsigned long long seed)
+{
+    XXH_cms_t* cms;
+    unsigned widthLog = XXH_CMS_MIN_WIDTH_LOG;
+    if ((depth == 0) || (depth > XXH_CMS_MAX_DEPTH)) return NULL;
+    if ((kind != XXH_cms_countMin) && (kind != XXH_cms_countSketch)) return NULL;
+    while (((size_t)1 << widthLog) < width) {
+        if (widthLog == XXH_CMS_MAX_WIDTH_LOG) return NULL;
+        widthLog++;
+    }
+    if (((size_t)1 << widthLog) > (size_t)-1 / depth / sizeof(XXH32_hash_t)) return NULL;   /* 32-bit targets */
+    cms = (XXH_cms_t*)malloc(sizeof(XXH_cms_t));
+    if (cms == NULL) return NULL;
+    cms->widthLog = widthLog;
+    cms->width = (size_t)1 << widthLog;
+    cms->depth = depth;
+    cms->kind = kind;
+    cms->seed = seed;
+    cms->counters = (XXH32_hash_t*)calloc(cms->width * depth, sizeof(XXH32_hash_t));
+    if (cms->counters == NULL) { free(cms); return NULL; }
+    return cms;
+}
+
+XXH_HEADER_API void XXH_cms_free(XXH_cms_t* cms)
+{
+    if (cms == NULL) return;
+    free(cms->counters);
+    free(cms);
+}
+
+XXH_HEADER_API void XXH_cms_clear(XXH_cms_t* cms)
+{
+    memset(cms->counters, 0, cms->width * cms->depth * sizeof(XXH32_hash_t));
+}
+
+/* XXH_cms_positions() :
+ * counter of each row for `hash`, as an offset into cms->counters.
+ * With XXH_cms_countSketch, `signs` receives 1 for rows where the item subtracts.
+ * The sign is the bit right below the row index : widthLog <= 28 leaves it available. */
+XXH_HEADER_API void XXH_cms_positions(const XXH_cms_t* cms, XXH64_hash_t hash,
+                                      size_t positions[XXH_CMS_MAX_DEPTH], unsigned* signs)
+{
+    XXH32_hash_t a = (XXH32_hash_t)hash;
+    XXH32_hash_t b = (XXH32_hash_t)(hash >> 32) | 1;
+    unsigned const shift = 32 - cms->widthLog;
+    unsigned s = 0;
+    unsigned i;
+    for (i=0; i<cms->depth; i++) {
+        positions[i] = i * cms->width + (size_t)(a >> shift);
+        s |= ((a >> (shift - 1)) & 1) << i;
+        a += b;
+        b += i;
+    }
+    if (signs) *signs = s;
+}
+
+XXH_HEADER_API void XXH_cms_updateHash(XXH_cms_t* cms, XXH64_hash_t hash, XXH32_hash_t count)
+{
+    size_t positions[XXH_CMS_MAX_DEPTH];
+    unsigned signs;
+    unsigned i;
+    XXH_cms_positions(cms, hash, positions, &signs);
+    if (cms->kind == XXH_cms_countSketch) {
+        for (i=0; i<cms->depth; i++)
+            cms->counters[positions[i]] += ((signs >> i) & 1) ? (XXH32_hash_t)0 - count : count;
+    } else {
+        for (i=0; i<cms->depth; i++) cms->counters[positions[i]] += count;
+    }
+}
+
+/*! XXH_cms_updateConservativeHash() :
+ *  Conservative update : only raises the counters which are below the new estimate.
+ *  Estimates remain upper bounds, but overestimate much less on skewed streams.
+ *  Same as XXH_cms_updateHash() for XXH_cms_countSketch. */
+XXH_HEADER_API void XXH_cms_updateConservativeHash(XXH_cms_t* cms, XXH64_hash_t hash, XXH32_hash_t count)
+{
+    size_t positions[XXH_CMS_MAX_DEPTH];
+    XXH32_hash_t minCount;
+    unsigned i;
+    if (cms->kind != XXH_cms_countMin) { XXH_cms_updateHash(cms, hash, count); return; }
+    XXH_cms_positions(cms, hash, positions, NULL);
+    minCount = (XXH32_hash_t)-1;
+    for (i=0; i<cms->depth; i++)
+        if (cms->counters[positions[i]] < minCount) minCount = cms->counters[positions[i]];
+    minCount += count;
+    for (i=0; i<cms->depth; i++)
+        if (cms->counters[positions[i]] < minCount) cms->counters[positions[i]] = minCount;
+}
+
+/*! XXH_cms_estimateHash() :
+ *  @return : minimum of rows with XXH_cms_countMin, median of rows with XXH_cms_countSketch (can be negative) */
+XXH_HEADER_API long long XXH_cms_estimateHash(const XXH_cms_t* cms, XXH64_hash_t hash)
+{
+    size_t positions[XXH_CMS_MAX_DEPTH];
+    long long values[XXH_CMS_MAX_DEPTH];
+    unsigned signs;
+    unsigned i;
+    XXH_cms_positions(cms, hash, positions, &signs);
+    if (cms->kind == XXH_cms_countMin) {
+        XXH32_hash_t minCount = (XXH32_hash_t)-1;
+        for (i=0; i<cms->depth; i++)
+            if (cms->counters[positions[i]] < minCount) minCount = cms->counters[positions[i]];
+        return (long long)minCount;
+    }
+    for (i=0; i<cms->depth; i++) {   /* insertion sort of signed counters */
+        XXH32_hash_t const c = cms->counters[positions[i]];
+        long long v = (c >= 0x80000000U) ? (long long)c - 0x100000000LL : (long long)c;
+        unsigned j = i;
+        if ((signs >> i) & 1) v = -v;
+        while ((j > 0) && (values[j-1] > v)) { values[j] = values[j-1]; j--; }
+        values[j] = v;
+    }
+    if (cms->depth & 1) return values[cms->depth / 2];
+    return (values[cms->depth/2 - 1] + values[cms->depth/2]) / 2;
+}
+
+XXH_HEADER_API void XXH_cms_update(XXH_cms_t* cms, const void* item, size_t length, XXH32_hash_t count)
+{
+    XXH_cms_updateHash(cms, XXH64(item, length, cms->seed), count);
+}
+
+XXH_HEADER_API void XXH_cms_updateConservative(XXH_cms_t* cms, const void* item, size_t length, XXH32_hash_t count)
+{
+    XXH_cms_updateConservativeHash(cms, XXH64(item, length, cms->seed), count);
+}
+
+XXH_HEADER_API long long XXH_cms_estimate(const XXH_cms_t* cms, const void* item, size_t length)
+{
+    return XXH_cms_estimateHash(cms, XXH64(item, length, cms->seed));
+}
+
+/* XXH_cms_prefetch() : counters of all rows for `hash` */
+XXH_HEADER_API void XXH_cms_prefetch(const void* ctx, XXH64_hash_t hash)
+{
+    const XXH_cms_t* const cms = (const XXH_cms_t*)ctx;
+    size_t positions[XXH_CMS_MAX_DEPTH];
+    unsigned i;
+    XXH_cms_positions(cms, hash, positions, NULL);
+    for (i=0; i<cms->depth; i++) XXH_PREFETCH(cms->counters + positions[i]);
+}
+
+/*! XXH_cms_updateBatch(), XXH_cms_updateConservativeBatch(), XXH_cms_estimateBatch() :
+ *  Same as single-item functions over `nbItems` items, each counting for `count`.
+ *  Items are hashed XXH_BATCH at a time, and their counters prefetched before use,
+ *  so that cache misses overlap. */
+XXH_HEADER_API void XXH_cms_updateBatchInternal(XXH_cms_t* cms, const void* const* items, const size_t* lengths,
+                                                size_t nbItems, XXH32_hash_t count, int conservative)
+{
+    XXH64_hash_t hashes[XXH_BATCH];
+    size_t start, end;
+    for (start=0; start<nbItems; start=end) {
+        size_t n;
+        end = XXH_hashBatch(hashes, items, lengths, nbItems, start, cms->seed, XXH_cms_prefetch, cms);
+        for (n=start; n<end; n++) {
+            if (conservative) XXH_cms_updateConservativeHash(cms, hashes[n-start], count);
+            else XXH_cms_updateHash(cms, hashes[n-start], count);
+    }   }
+}
+
+XXH_HEADER_API void XXH_cms_updateBatch(XXH_cms_t* cms, const void* const* items, const size_t* lengths,
+                                        size_t nbItems, XXH32_hash_t count)
+{
+    XXH_cms_updateBatchInternal(cms, items, lengths, nbItems, count, 0);
+}
+
+XXH_HEADER_API void XXH_cms_updateConservativeBatch(XXH_cms_t* cms, const void* const* items, const size_t* lengths,
+                                                    size_t nbItems, XXH32_hash_t count)
+{
+    XXH_cms_updateBatchInternal(cms, items, lengths, nbItems, count, 1);
+}
+
+XXH_HEADER_API void XXH_cms_estimateBatch(const XXH_cms_t* cms, const void* const* items, const size_t* lengths,
+                                          size_t nbItems, long long* estimates)
+{
+    XXH64_hash_t hashes[XXH_BATCH];
+    size_t start, end;
+    for (start=0; start<nbItems; start=end) {
+        size_t n;
+        end = XXH_hashBatch(hashes, items, lengths, nbItems, start, cms->seed, XXH_cms_prefetch, cms);
+        for (n=start; n<end; n++) estimates[n] = XXH_cms_estimateHash(cms, hashes[n-start]);
+    }
+}
+
+/*! XXH_cms_merge() :
+ *  Adds all counts of `src` into `dst`. Both sketches must have the same kind, width, depth and seed.
+ *  @return : 0 on success, 1 if sketches are not compatible */
+XXH_HEADER_API int XXH_cms_merge(XXH_cms_t* dst, const XXH_cms_t* src)
+{
+    size_t const nbCounters = dst->width * dst->depth;
+    size_t n;
+    if ((dst->kind != src->kind) || (dst->width != src->width) || (dst->depth != src->depth) || (dst->seed != src->seed))
+        return 1;
+    for (n=0; n<nbCounters; n++) dst->counters[n] += src->counters[n];
+    return 0;
+}
+
+
+/* ****************************
+ *  Top-k tracker (SpaceSaving)
+ ******************************/
+/* Monitored items are identified by their 64-bit hash.
+ * Their first maxKeyLength bytes are kept, for display.
+ * An index (open addressing, linear probing) finds the entry of a hash,
+ * and a binary min-heap of entries, by count, finds the one to replace. */
+typedef struct {
+    const void* key;             /* first bytes of the item, up to maxKeyLength */
+    size_t length;               /* stored length */
+    XXH64_hash_t hash;
+    unsigned long long count;    /* upper bound of the item's frequency */
+    unsigned long long error;    /* overestimation bound : count - error <= frequency */
+} XXH_topk_entry_t;
+
+typedef struct {
+    XXH_topk_entry_t* entries;   /* k, unordered */
+    unsigned char* keyArena;     /* k * maxKeyLength */
+    unsigned* heap;              /* entry numbers, min-heap by count */
+    unsigned* heapPos;           /* position of each entry in heap */
+    unsigned* index;             /* entry number + 1, 0 : empty. indexMask + 1 slots */
+    size_t indexMask;
+    size_t k;
+    size_t nbEntries;
+    size_t maxKeyLength;
+    unsigned long long seed;
+} XXH_topk_t;
+
+/*! XXH_topk_create() :
+ *  Tracks `k` items (k < 2^30), keeping up to `maxKeyLength` bytes of each.
+ *  @return : NULL on invalid parameters or allocation failure */
+XXH_HEADER_API XXH_topk_t* XXH_topk_create(size_t k, size_t maxKeyLength, unsigned long long seed)
+{
+    XXH_topk_t* tk;
+    size_t indexSize = 4;
+    if ((k == 0) || (k >= ((size_t)1 << 30))) return NULL;
+    if ((maxKeyLength != 0) && (k > ((size_t)-1 - 1) / maxKeyLength)) return NULL;
+    while (indexSize < 2*k) indexSize *= 2;   /* load <= 0.5 */
+    tk = (XXH_topk_t*)calloc(1, sizeof(XXH_topk_t));
+    if (tk == NULL) return NULL;
+    tk->entries = (XXH_topk_entry_t*)malloc(k * sizeof(XXH_topk_entry_t));
+    tk->keyArena = (unsigned char*)malloc(k * maxKeyLength + 1);
+    tk->heap = (unsigned*)malloc(k * sizeof(unsigned));
+    tk->heapPos = (unsigned*)malloc(k * sizeof(unsigned));
+    tk->index = (unsigned*)calloc(indexSize, sizeof(unsigned));
+    tk->indexMask = indexSize - 1;
+    tk->k = k;
+    tk->maxKeyLength = maxKeyLength;
+    tk->seed = seed;
+    if (!tk->entries || !tk->keyArena || !tk->heap || !tk->heapPos || !tk->index) {
+        free(tk->entries); free(tk->keyArena); free(tk->heap); free(tk->heapPos); free(tk->index);
+        free(tk);
+        return NULL;
+    }
+    return tk;
+}
+
+XXH_HEADER_API void XXH_topk_free(XXH_topk_t* tk)
+{
+    if (tk == NULL) return;
+    free(tk->entries);
+    free(tk->keyArena);
+    free(tk->heap);
+    free(tk->heapPos);
+    free(tk->index);
+    free(tk);
+}
+
+XXH_HEADER_API void XXH_topk_clear(XXH_topk_t* tk)
+{
+    memset(tk->index, 0, (tk->indexMask + 1) * sizeof(unsigned));
+    tk->nbEntries = 0;
+}
+
+/* XXH_topk_slot() : index slot of `hash`, or the empty slot where it would be inserted */
+XXH_HEADER_API size_t XXH_topk_slot(const XXH_topk_t* tk, XXH64_hash_t hash)
+{
+    size_t slot = (size_t)(hash >> 32) & tk->indexMask;
+    while (tk->index[slot] && (tk->entries[tk->index[slot] - 1].hash != hash))
+        slot = (slot + 1) & tk->indexMask;
+    return slot;
+}
+
+/* XXH_topk_unindex() : removes the index slot of `hash`, with backward shift deletion */
+XXH_HEADER_API void XXH_topk_unindex(XXH_topk_t* tk, XXH64_hash_t hash)
+{
+    size_t hole = XXH_topk_slot(tk, hash);
+    size_t slot = hole;
+    tk->index[hole] = 0;
+    for (;;) {
+        size_t home;
+        slot = (slot + 1) & tk->indexMask;
+        if (tk->index[slot] == 0) return;
+        home = (size_t)(tk->entries[tk->index[slot] - 1].hash >> 32) & tk->indexMask;
+        /* move back the entry if its home is not in (hole, slot] */
+        if (((slot - home) & tk->indexMask) >= ((slot - hole) & tk->indexMask)) {
+            tk->index[hole] = tk->index[slot];
+            tk->index[slot] = 0;
+            hole = slot;
+    }   }
+}
+
+XXH_HEADER_API void XXH_topk_heapSwap(XXH_topk_t* tk, size_t p1, size_t p2)
+{
+    unsigned const e1 = tk->heap[p1], e2 = tk->heap[p2];
+    tk->heap[p1] = e2; tk->heapPos[e2] = (unsigned)p1;
+    tk->heap[p2] = e1; tk->heapPos[e1] = (unsigned)p2;
+}
+
+/* XXH_topk_siftDown() : restores the heap after the count of heap[pos] increased */
+XXH_HEADER_API void XXH_topk_siftDown(XXH_topk_t* tk, size_t pos)
+{
+    for (;;) {
+        size_t const left = 2*pos + 1;
+        size_t smallest = pos;
+        if ((left < tk->nbEntries) && (tk->entries[tk->heap[left]].count < tk->entries[tk->heap[smallest]].count))
+            smallest = left;
+        if ((left+1 < tk->nbEntries) && (tk->entries[tk->heap[left+1]].count < tk->entries[tk->heap[smallest]].count))
+            smallest = left+1;
+        if (smallest == pos) return;
+        XXH_topk_heapSwap(tk, pos, smallest);
+        pos = smallest;
+    }
+}
+
+XXH_HEADER_API void XXH_topk_siftUp(XXH_topk_t* tk, size_t pos)
+{
+    while (pos > 0) {
+        size_t const parent = (pos - 1) / 2;
+        if (tk->entries[tk->heap[parent]].count <= tk->entries[tk->heap[pos]].count) return;
+        XXH_topk_heapSwap(tk, pos, parent);
+        pos = parent;
+    }
+}
+
+/*! XXH_topk_addHash() :
+ *  Counts `count` occurrences of the item `key`, of hash `hash` (XXH64(key, length, seed)).
+ *  `key` is only read when the item becomes monitored. */
+XXH_HEADER_API void XXH_topk_addHash(XXH_topk_t* tk, XXH64_hash_t hash, const void* key, size_t length,
+                                     unsigned long long count)
+{
+    size_t const slot = XXH_topk_slot(tk, hash);
+    int replaced = 0;
+    unsigned e;
+    if (tk->index[slot]) {   /* monitored */
+        e = tk->index[slot] - 1;
+        tk->entries[e].count += count;
+        XXH_topk_siftDown(tk, tk->heapPos[e]);
+        return;
+    }
+    if (tk->nbEntries < tk->k) {   /* free entry */
+        e = (unsigned)tk->nbEntries++;
+        tk->entries[e].count = count;
+        tk->entries[e].error = 0;
+        tk->heap[tk->nbEntries - 1] = e;
+        tk->heapPos[e] = (unsigned)(tk->nbEntries - 1);
+        tk->entries[e].key = tk->keyArena + (size_t)e * tk->maxKeyLength;
+        tk->index[slot] = e + 1;
+    } else {   /* replaces the least frequent item */
+        e = tk->heap[0];
+        replaced = 1;
+        XXH_topk_unindex(tk, tk->entries[e].hash);
+        tk->entries[e].error = tk->entries[e].count;
+        tk->entries[e].count += count;
+        tk->index[XXH_topk_slot(tk, hash)] = e + 1;
+    }
+    tk->entries[e].hash = hash;
+    tk->entries[e].length = (length < tk->maxKeyLength) ? length : tk->maxKeyLength;
+    if (tk->entries[e].length) memcpy(tk->keyArena + (size_t)e * tk->maxKeyLength, key, tk->entries[e].length);
+    if (replaced) XXH_topk_siftDown(tk, tk->heapPos[e]);
+    else XXH_topk_siftUp(tk, tk->heapPos[e]);
+}
+
+XXH_HEADER_API void XXH_topk_add(XXH_topk_t* tk, const void* key, size_t length, unsigned long long count)
+{
+    XXH_topk_addHash(tk, XXH64(key, length, tk->seed), key, length, count);
+}
+
+XXH_HEADER_API int XXH_topk_compareEntries(const void* a, const void* b)
+{
+    unsigned long long const ca = ((const XXH_topk_entry_t*)a)->count;
+    unsigned long long const cb = ((const XXH_topk_entry_t*)b)->count;
+    return (ca < cb) - (ca > cb);   /* decreasing counts */
+}
+
+/*! XXH_topk_list() :
+ *  Copies up to `maxEntries` monitored items into `entries`, by decreasing count.
+ *  Entry keys point into `tk` : they remain valid until the next addition.
+ *  @return : nb of entries written */
+XXH_HEADER_API size_t XXH_topk_list(const XXH_topk_t* tk, XXH_topk_entry_t* entries, size_t maxEntries)
+{
+    XXH_topk_entry_t* const sorted = (XXH_topk_entry_t*)malloc((tk->nbEntries + 1) * sizeof(XXH_topk_entry_t));
+    size_t const nb = (tk->nbEntries < maxEntries) ? tk->nbEntries : maxEntries;
+    if (sorted == NULL) return 0;
+    memcpy(sorted, tk->entries, tk->nbEntries * sizeof(XXH_topk_entry_t));
+    qsort(sorted, tk->nbEntries, sizeof(XXH_topk_entry_t), XXH_topk_compareEntries);
+    memcpy(entries, sorted, nb * sizeof(XXH_topk_entry_t));
+    free(sorted);
+    return nb;
+}
+
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* XXH_CMS_H_6193820457 */
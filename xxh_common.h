@@ -0,0 +1,130 @@
+/*
+   xxHash - Extremely Fast Hash algorithm
+   Definitions shared by the header-only companion modules
+   Copyright (C) 2012-2016, Yann Collet.
+
+   BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are
+   met:
+
+       * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+       * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following disclaimer
+   in the documentation and/or other materials provided with the
+   distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+   You can contact the author at :
+   - xxHash source repository : https://github.com/Cyan4973/xxHash
+*/
+
+/* Internal header, included by xxh_bloom.h, xxh_map.h, xxh_hll.h, xxh_cms.h and xxh_minhash.h.
+ * Not meant to be included directly.
+ *
+ * Companion modules only define `static` functions : they can be included in multiple units.
+ * xxhash.c must be linked, or included through XXH_INLINE_ALL.
+ */
+
+#ifndef XXH_COMMON_H_4719258036
+#define XXH_COMMON_H_4719258036
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>   /* size_t */
+#include "xxhash.h"
+
+
+/* ****************************
+ *  Compiler specifics
+ ******************************/
+#ifndef XXH_HEADER_API
+#  if defined(__GNUC__)
+#    define XXH_HEADER_API static __inline __attribute__((unused))
+#  elif defined (__cplusplus) || (defined (__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L) /* C99 */)
+#    define XXH_HEADER_API static inline
+#  elif defined(_MSC_VER)
+#    define XXH_HEADER_API static __inline
+#  else
+#    define XXH_HEADER_API static   /* this version may generate warnings for unused static functions */
+#  endif
+#endif
+
+/* XXH_HEADER_FORCE_INLINE : for helpers taking a function pointer, so that the call is resolved at compile time */
+#ifndef XXH_HEADER_FORCE_INLINE
+#  if defined(__GNUC__)
+#    define XXH_HEADER_FORCE_INLINE static __inline __attribute__((always_inline, unused))
+#  elif defined(_MSC_VER)
+#    define XXH_HEADER_FORCE_INLINE static __forceinline
+#  else
+#    define XXH_HEADER_FORCE_INLINE XXH_HEADER_API
+#  endif
+#endif
+
+#ifndef XXH_PREFETCH
+#  if defined(__GNUC__)
+#    define XXH_PREFETCH(p) __builtin_prefetch(p)
+#  else
+#    define XXH_PREFETCH(p) ((void)(p))
+#  endif
+#endif
+
+/* XXH_COMMON_SSE2, XXH_COMMON_NEON : vector code paths of companion modules */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#  include <emmintrin.h>
+#  define XXH_COMMON_SSE2 1
+#elif defined(__GNUC__) && (defined(__ARM_NEON__) || defined(__ARM_NEON))
+#  include <arm_neon.h>
+#  define XXH_COMMON_NEON 1
+#endif
+
+
+/* ****************************
+ *  Batch hashing
+ ******************************/
+#ifndef XXH_NO_LONG_LONG
+
+#define XXH_BATCH 16   /* items hashed, and their memory prefetched, ahead by batch functions */
+
+typedef void (*XXH_prefetch_f)(const void* ctx, XXH64_hash_t hash);
+
+/* XXH_hashBatch() :
+ * hashes items from `start`, up to XXH_BATCH of them, into `hashes` (indexed from 0),
+ * calling `prefetch` (if not NULL) right after each hash, so that cache misses overlap.
+ * @return : end of the batch (at most nbItems) */
+XXH_HEADER_FORCE_INLINE size_t XXH_hashBatch(XXH64_hash_t* hashes, const void* const* items, const size_t* lengths,
+                                             size_t nbItems, size_t start, unsigned long long seed,
+                                             XXH_prefetch_f prefetch, const void* ctx)
+{
+    size_t const end = (nbItems - start < XXH_BATCH) ? nbItems : start + XXH_BATCH;
+    size_t n;
+    for (n=start; n<end; n++) {
+        hashes[n-start] = XXH64(items[n], lengths[n], seed);
+        if (prefetch) prefetch(ctx, hashes[n-start]);
+    }
+    return end;
+}
+
+#endif   /* XXH_NO_LONG_LONG */
+
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* XXH_COMMON_H_4719258036 */
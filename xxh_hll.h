@@ -0,0 +1,574 @@
+/*
+   xxHash - Extremely Fast Hash algorithm
+   HyperLogLog cardinality estimator, header-only companion module
+   Copyright (C) 2012-2016, Yann Collet.
+
+   BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are
+   met:
+
+       * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+       * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following disclaimer
+   in the documentation and/or other materials provided with the
+   distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+   You can contact the author at :
+   - xxHash source repository : https://github.com/Cyan4973/xxHash
+*/
+
+/* Usage :
+ *     XXH_hll_t* const hll = XXH_hll_create(14, 0);   (2^14 registers : ~0.8% standard error)
+ *     XXH_hll_add(hll, item, itemLength);
+ *     XXH_hll_merge(hll, otherShard);
+ *     printf("~%.0f distinct items \n", XXH_hll_estimate(hll));
+ *     XXH_hll_free(hll);
+ *
+ * Each item is hashed once, with XXH64().
+ * The upper `precision` bits select a register,
+ * which keeps the highest rank (position of the first set bit) among the remaining bits.
+ *
+ * A sketch starts sparse : a list of (register, rank) entries, no larger than the dense form.
+ * It becomes dense (one byte per register) once the list would use more memory.
+ * Dense merge and estimation process 16 registers at a time with SSE2 or NEON.
+ *
+ * Items hashed by other means can be used with XXH_hll_addHash(),
+ * as long as all merged sketches use the same 64-bit hash function.
+ * XXH64_auto() results may depend on the CPU : don't use them for serialized sketches.
+ */
+
+#ifndef XXH_HLL_H_5820473169
+#define XXH_HLL_H_5820473169
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>   /* size_t */
+#include <stdlib.h>   /* malloc, calloc, free, qsort */
+#include <string.h>   /* memset, memcpy, memcmp */
+#include "xxh_common.h"
+
+#ifdef XXH_NO_LONG_LONG
+#  error xxh_hll.h requires XXH64
+#endif
+
+
+/* ****************************
+ *  Definitions
+ ******************************/
+#define XXH_HLL_MIN_PRECISION  4
+#define XXH_HLL_MAX_PRECISION 18
+#define XXH_HLL_HEADER_SIZE   16   /* serialized header */
+#define XXH_HLL_RANK_BITS      6   /* ranks are <= 65 - XXH_HLL_MIN_PRECISION */
+
+typedef struct {
+    unsigned char* registers;  /* dense : 2^precision bytes, NULL while sparse */
+    XXH32_hash_t*  sparse;     /* sparse : (register << XXH_HLL_RANK_BITS) | rank, NULL once dense */
+    size_t nbSparse;           /* entries in `sparse`, possibly unsorted and duplicated */
+    unsigned precision;
+    unsigned long long seed;
+} XXH_hll_t;
+
+
+/* ****************************
+ *  Creation
+ ******************************/
+XXH_HEADER_API size_t XXH_hll_nbRegisters(const XXH_hll_t* hll) { return (size_t)1 << hll->precision; }
+
+/* sparse entries take 4 bytes : the list is never larger than the dense form */
+XXH_HEADER_API size_t XXH_hll_sparseCapacity(const XXH_hll_t* hll) { return XXH_hll_nbRegisters(hll) / 4; }
+
+/*! XXH_hll_create() :
+ *  `precision` : 4 - 18. 2^precision registers, for a standard error of 1.04 / sqrt(2^precision) :
+ *                10 ~3.2%, 12 ~1.6%, 14 ~0.8%, 16 ~0.4%.
+ *  Sketches can only be merged with sketches of same precision and seed.
+ *  @return : NULL on invalid parameters or allocation failure */
+XXH_HEADER_API XXH_hll_t* XXH_hll_create(unsigned precision, unsigned long long seed)
+{
+    XXH_hll_t* hll;
+    if ((precision < XXH_HLL_MIN_PRECISION) || (precision > XXH_HLL_MAX_PRECISION)) return NULL;
+    hll = (XXH_hll_t*)malloc(sizeof(XXH_hll_t));
+    if (hll == NULL) return NULL;
+    hll->precision = precision;
+    hll->seed = seed;
+    hll->registers = NULL;
+    hll->nbSparse = 0;
+    hll->sparse = (XXH32_hash_t*)malloc(XXH_hll_sparseCapacity(hll) * sizeof(XXH32_hash_t));
+    if (hll->sparse == NULL) { free(hll); return NULL; }
+    return hll;
+}
+
+XXH_HEADER_API void XXH_hll_free(XXH_hll_t* hll)
+{
+    if (hll == NULL) return;
+    free(hll->registers);
+    free(hll->sparse);
+    free(hll);
+}
+
+/*! XXH_hll_clear() : removes all items. A dense sketch remains dense. */
+XXH_HEADER_API void XXH_hll_clear(XXH_hll_t* hll)
+{
+    if (hll->registers) memset(hll->registers, 0, XXH_hll_nbRegisters(hll));
+    hll->nbSparse = 0;
+}
+
+
+/* ****************************
+ *  Sparse representation
+ ******************************/
+XXH_HEADER_API int XXH_hll_compareEntries(const void* a, const void* b)
+{
+    XXH32_hash_t const ea = *(const XXH32_hash_t*)a;
+    XXH32_hash_t const eb = *(const XXH32_hash_t*)b;
+    return (ea > eb) - (ea < eb);
+}
+
+/* XXH_hll_compact() :
+ * sorts sparse entries by register, keeping only the highest rank of each register */
+XXH_HEADER_API void XXH_hll_compact(XXH_hll_t* hll)
+{
+    size_t in, out = 0;
+    if (hll->nbSparse < 2) return;
+    qsort(hll->sparse, hll->nbSparse, sizeof(XXH32_hash_t), XXH_hll_compareEntries);
+    for (in=0; in<hll->nbSparse; in++) {
+        XXH32_hash_t const e = hll->sparse[in];
+        /* sorted : for a given register, the last entry has the highest rank */
+        if ((in+1 < hll->nbSparse) && ((hll->sparse[in+1] >> XXH_HLL_RANK_BITS) == (e >> XXH_HLL_RANK_BITS))) continue;
+        hll->sparse[out++] = e;
+    }
+    hll->nbSparse = out;
+}
+
+/*! XXH_hll_densify() :
+ *  Converts a sparse sketch to the dense representation. Does nothing on a dense sketch.
+ *  Useful for sketches which will receive many merges.
+ *  @return : 0 on success, 1 on allocation failure (the sketch remains sparse) */
+XXH_HEADER_API int XXH_hll_densify(XXH_hll_t* hll)
+{
+    size_t n;
+    if (hll->registers) return 0;
+    hll->registers = (unsigned char*)calloc(XXH_hll_nbRegisters(hll), 1);
+    if (hll->registers == NULL) return 1;
+    for (n=0; n<hll->nbSparse; n++) {
+        XXH32_hash_t const e = hll->sparse[n];
+        unsigned char const rank = (unsigned char)(e & ((1 << XXH_HLL_RANK_BITS) - 1));
+        unsigned char* const r = hll->registers + (e >> XXH_HLL_RANK_BITS);
+        if (rank > *r) *r = rank;
+    }
+    free(hll->sparse);
+    hll->sparse = NULL;
+    hll->nbSparse = 0;
+    return 0;
+}
+
+XXH_HEADER_API int XXH_hll_addEntry(XXH_hll_t* hll, XXH32_hash_t index, unsigned rank)
+{
+    if (hll->registers) {
+        if (rank > hll->registers[index]) hll->registers[index] = (unsigned char)rank;
+        return 0;
+    }
+    if (hll->nbSparse == XXH_hll_sparseCapacity(hll)) {
+        XXH_hll_compact(hll);
+        /* still more than half full : the dense form is now cheaper */
+        if ((hll->nbSparse > XXH_hll_sparseCapacity(hll) / 2) && !XXH_hll_densify(hll))
+            return XXH_hll_addEntry(hll, index, rank);
+        if (hll->nbSparse == XXH_hll_sparseCapacity(hll)) return 1;
+    }
+    hll->sparse[hll->nbSparse++] = (index << XXH_HLL_RANK_BITS) | rank;
+    return 0;
+}
+
+
+/* ****************************
+ *  Insertion
+ ******************************/
+XXH_HEADER_API unsigned XXH_hll_clz64(unsigned long long v)   /* v != 0 */
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_clzll(v);
+#else
+    unsigned n = 0;
+    if (!(v >> 32)) { n += 32; v <<= 32; }
+    if (!(v >> 48)) { n += 16; v <<= 16; }
+    if (!(v >> 56)) { n +=  8; v <<=  8; }
+    if (!(v >> 60)) { n +=  4; v <<=  4; }
+    if (!(v >> 62)) { n +=  2; v <<=  2; }
+    if (!(v >> 63)) { n +=  1; }
+    return n;
+#endif
+}
+
+/*! XXH_hll_addHash() :
+ *  @return : 0, or 1 on allocation failure (the item is not added) */
+XXH_HEADER_API int XXH_hll_addHash(XXH_hll_t* hll, XXH64_hash_t hash)
+{
+    XXH32_hash_t const index = (XXH32_hash_t)(hash >> (64 - hll->precision));
+    unsigned long long const w = hash << hll->precision;
+    unsigned const rank = w ? XXH_hll_clz64(w) + 1 : 65 - hll->precision;
+    return XXH_hll_addEntry(hll, index, rank);
+}
+
+XXH_HEADER_API int XXH_hll_add(XXH_hll_t* hll, const void* item, size_t length)
+{
+    return XXH_hll_addHash(hll, XXH64(item, length, hll->seed));
+}
+
+/* XXH_hll_prefetch() : dense register of `hash`, for XXH_hashBatch() */
+XXH_HEADER_API void XXH_hll_prefetch(const void* hll, XXH64_hash_t hash)
+{
+    const XXH_hll_t* const h = (const XXH_hll_t*)hll;
+    XXH_PREFETCH(h->registers + (size_t)(hash >> (64 - h->precision)));
+}
+
+/*! XXH_hll_addBatch() :
+ *  Same as XXH_hll_add() over `nbItems` items.
+ *  Items are hashed XXH_BATCH at a time, and their dense registers prefetched before use.
+ *  @return : 0, or 1 on allocation failure (some items may not be added) */
+XXH_HEADER_API int XXH_hll_addBatch(XXH_hll_t* hll, const void* const* items, const size_t* lengths, size_t nbItems)
+{
+    XXH64_hash_t hashes[XXH_BATCH];
+    int error = 0;
+    size_t start, end;
+    for (start=0; start<nbItems; start=end) {
+        size_t n;
+        end = XXH_hashBatch(hashes, items, lengths, nbItems, start, hll->seed,
+                            hll->registers ? XXH_hll_prefetch : NULL, hll);
+        for (n=start; n<end; n++) error |= XXH_hll_addHash(hll, hashes[n-start]);
+    }
+    return error;
+}
+
+
+/* ****************************
+ *  Merge and estimation
+ ******************************/
+/*! XXH_hll_merge() :
+ *  Adds all items of `src` into `dst`. Both sketches must have the same precision and seed.
+ *  A dense `src` makes `dst` dense.
+ *  @return : 0 on success, 1 if sketches are not compatible, or on allocation failure */
+XXH_HEADER_API int XXH_hll_merge(XXH_hll_t* dst, const XXH_hll_t* src)
+{
+    size_t const nbRegisters = XXH_hll_nbRegisters(dst);
+    size_t n;
+    if ((dst->precision != src->precision) || (dst->seed != src->seed)) return 1;
+    if (src->registers == NULL) {
+        int error = 0;
+        for (n=0; n<src->nbSparse; n++) {
+            XXH32_hash_t const e = src->sparse[n];
+            error |= XXH_hll_addEntry(dst, e >> XXH_HLL_RANK_BITS, e & ((1 << XXH_HLL_RANK_BITS) - 1));
+        }
+        return error;
+    }
+    if (XXH_hll_densify(dst)) return 1;
+    /* nbRegisters is a multiple of 16 */
+#if defined(XXH_COMMON_SSE2)
+    for (n=0; n<nbRegisters; n+=16) {
+        __m128i* const d = (__m128i*)(void*)(dst->registers + n);
+        __m128i const s = _mm_loadu_si128((const __m128i*)(const void*)(src->registers + n));
+        _mm_storeu_si128(d, _mm_max_epu8(_mm_loadu_si128(d), s));
+    }
+#elif defined(XXH_COMMON_NEON)
+    for (n=0; n<nbRegisters; n+=16)
+        vst1q_u8(dst->registers + n, vmaxq_u8(vld1q_u8(dst->registers + n), vld1q_u8(src->registers + n)));
+#else
+    for (n=0; n<nbRegisters; n++)
+        if (src->registers[n] > dst->registers[n]) dst->registers[n] = src->registers[n];
+#endif
+    return 0;
+}
+
+/* XXH_hll_log() : natural logarithm of x >= 1, avoids a dependency on libm */
+XXH_HEADER_API double XXH_hll_log(double x)
+{
+    double const ln2 = 0.69314718055994530942;
+    double result = 0., z, z2, term;
+    int k;
+    while (x >= 2.) { x *= 0.5; result += ln2; }
+    /* ln(x) = 2 atanh((x-1)/(x+1)), with |z| <= 1/3 */
+    z = (x - 1.) / (x + 1.);
+    z2 = z * z;
+    term = z;
+    for (k=1; k<40; k+=2) {
+        result += 2. * term / k;
+        term *= z2;
+    }
+    return result;
+}
+
+/* XXH_hll_sumDense() :
+ * sum of 2^-register over all dense registers, and nb of zero registers.
+ * The SIMD versions build 2^-r as floats from their exponent field (127 - r),
+ * and flush float lanes into a double every 256 registers, to bound rounding errors. */
+XXH_HEADER_API double XXH_hll_sumDense(const XXH_hll_t* hll, size_t* nbZeros)
+{
+    size_t const nbRegisters = XXH_hll_nbRegisters(hll);
+    const unsigned char* const reg = hll->registers;
+    double sum = 0.;
+    size_t zeros = 0;
+    size_t n;
+#if defined(XXH_COMMON_SSE2)
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const bias = _mm_set1_epi32(127);
+    size_t chunk;
+    for (chunk=0; chunk<nbRegisters; chunk+=256) {
+        size_t const end = (nbRegisters - chunk < 256) ? nbRegisters : chunk + 256;
+        __m128 acc = _mm_setzero_ps();
+        float lanes[4];
+        for (n=chunk; n<end; n+=16) {
+            __m128i const r = _mm_loadu_si128((const __m128i*)(const void*)(reg + n));
+            __m128i const lo = _mm_unpacklo_epi8(r, zero);
+            __m128i const hi = _mm_unpackhi_epi8(r, zero);
+            __m128i const e0 = _mm_sub_epi32(bias, _mm_unpacklo_epi16(lo, zero));
+            __m128i const e1 = _mm_sub_epi32(bias, _mm_unpackhi_epi16(lo, zero));
+            __m128i const e2 = _mm_sub_epi32(bias, _mm_unpacklo_epi16(hi, zero));
+            __m128i const e3 = _mm_sub_epi32(bias, _mm_unpackhi_epi16(hi, zero));
+            acc = _mm_add_ps(acc, _mm_add_ps(_mm_add_ps(_mm_castsi128_ps(_mm_slli_epi32(e0, 23)), _mm_castsi128_ps(_mm_slli_epi32(e1, 23))),
+                                             _mm_add_ps(_mm_castsi128_ps(_mm_slli_epi32(e2, 23)), _mm_castsi128_ps(_mm_slli_epi32(e3, 23)))));
+            {   unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(r, zero));
+                while (mask) { zeros++; mask &= mask - 1; }
+        }   }
+        _mm_storeu_ps(lanes, acc);
+        sum += ((double)lanes[0] + (double)lanes[1]) + ((double)lanes[2] + (double)lanes[3]);
+    }
+#elif defined(XXH_COMMON_NEON)
+    uint32x4_t const bias = vdupq_n_u32(127);
+    size_t chunk;
+    for (chunk=0; chunk<nbRegisters; chunk+=256) {
+        size_t const end = (nbRegisters - chunk < 256) ? nbRegisters : chunk + 256;
+        float32x4_t acc = vdupq_n_f32(0.f);
+        uint8x16_t zeroCount = vdupq_n_u8(0);   /* at most 16 per lane within a chunk */
+        for (n=chunk; n<end; n+=16) {
+            uint8x16_t const r = vld1q_u8(reg + n);
+            uint16x8_t const lo = vmovl_u8(vget_low_u8(r));
+            uint16x8_t const hi = vmovl_u8(vget_high_u8(r));
+            uint32x4_t const e0 = vsubq_u32(bias, vmovl_u16(vget_low_u16(lo)));
+            uint32x4_t const e1 = vsubq_u32(bias, vmovl_u16(vget_high_u16(lo)));
+            uint32x4_t const e2 = vsubq_u32(bias, vmovl_u16(vget_low_u16(hi)));
+            uint32x4_t const e3 = vsubq_u32(bias, vmovl_u16(vget_high_u16(hi)));
+            acc = vaddq_f32(acc, vaddq_f32(vaddq_f32(vreinterpretq_f32_u32(vshlq_n_u32(e0, 23)), vreinterpretq_f32_u32(vshlq_n_u32(e1, 23))),
+                                           vaddq_f32(vreinterpretq_f32_u32(vshlq_n_u32(e2, 23)), vreinterpretq_f32_u32(vshlq_n_u32(e3, 23)))));
+            zeroCount = vsubq_u8(zeroCount, vceqq_u8(r, vdupq_n_u8(0)));   /* 0xFF == -1 */
+        }
+        {   float lanes[4];
+            unsigned char counts[16];
+            int i;
+            vst1q_f32(lanes, acc);
+            vst1q_u8(counts, zeroCount);
+            sum += ((double)lanes[0] + (double)lanes[1]) + ((double)lanes[2] + (double)lanes[3]);
+            for (i=0; i<16; i++) zeros += counts[i];
+    }   }
+#else
+    double inversePow2[65];
+    int k;
+    inversePow2[0] = 1.;
+    for (k=1; k<65; k++) inversePow2[k] = inversePow2[k-1] * 0.5;
+    for (n=0; n<nbRegisters; n++) {
+        sum += inversePow2[reg[n]];
+        zeros += (reg[n] == 0);
+    }
+#endif
+    *nbZeros = zeros;
+    return sum;
+}
+
+/*! XXH_hll_estimate() :
+ *  @return : estimated nb of distinct items.
+ *  Uses linear counting while many registers are empty, and the raw HyperLogLog estimate otherwise.
+ *  Compacts the entries of a sparse sketch, hence the non-const argument. */
+XXH_HEADER_API double XXH_hll_estimate(XXH_hll_t* hll)
+{
+    size_t const nbRegisters = XXH_hll_nbRegisters(hll);
+    double const m = (double)nbRegisters;
+    double const alpha = (nbRegisters == 16) ? 0.673 : (nbRegisters == 32) ? 0.697 : (nbRegisters == 64) ? 0.709
+                       : 0.7213 / (1. + 1.079 / m);
+    double sum, estimate;
+    size_t nbZeros;
+    if (hll->registers == NULL) {
+        /* sparse : one entry per non-zero register, at most m/4 of them */
+        XXH_hll_compact(hll);
+        return m * XXH_hll_log(m / (m - (double)hll->nbSparse));
+    }
+    sum = XXH_hll_sumDense(hll, &nbZeros);
+    estimate = alpha * m * m / sum;
+    if ((estimate <= 2.5 * m) && (nbZeros > 0))
+        return m * XXH_hll_log(m / (double)nbZeros);
+    return estimate;
+}
+
+
+/* ****************************
+ *  Serialization
+ ******************************/
+/* Format, all values little endian :
+ *  4 bytes  magic "XXL1"
+ *  1 byte   precision
+ *  1 byte   encoding : 0 sparse, 1 dense
+ *  2 bytes  zero
+ *  8 bytes  seed
+ * sparse :  4 bytes  nbEntries, then for each entry, by increasing register :
+ *                    register - previous register (varint, 7 bits per byte, low bits first), then 1 byte rank
+ * dense  :  registers packed on 6 bits, 4 registers per 3 bytes, first register in lowest bits */
+static const unsigned char XXH_hll_magic[4] = { 'X', 'X', 'L', '1' };
+
+XXH_HEADER_API size_t XXH_hll_denseSize(const XXH_hll_t* hll)
+{
+    return XXH_HLL_HEADER_SIZE + XXH_hll_nbRegisters(hll) / 4 * 3;
+}
+
+/*! XXH_hll_serializedSize() :
+ *  @return : maximum size of XXH_hll_serialize() output */
+XXH_HEADER_API size_t XXH_hll_serializedSize(const XXH_hll_t* hll)
+{
+    /* registers < 2^18 : at most 3 varint bytes */
+    size_t const sparseBound = XXH_HLL_HEADER_SIZE + 4 + hll->nbSparse * 4;
+    if ((hll->registers == NULL) && (sparseBound < XXH_hll_denseSize(hll))) return sparseBound;
+    return XXH_hll_denseSize(hll);
+}
+
+/*! XXH_hll_serialize() :
+ *  Writes the smallest of the sparse and dense encodings.
+ *  Compacts the entries of a sparse sketch, hence the non-const argument.
+ *  @return : nb of bytes written into `dst`, or 0 if `dstCapacity` is too small */
+XXH_HEADER_API size_t XXH_hll_serialize(XXH_hll_t* hll, void* dst, size_t dstCapacity)
+{
+    unsigned char* const out = (unsigned char*)dst;
+    size_t const nbRegisters = XXH_hll_nbRegisters(hll);
+    size_t sparseSize = 0;
+    size_t pos, n;
+    int i;
+    if (hll->registers == NULL) {
+        XXH32_hash_t prev = 0;
+        XXH_hll_compact(hll);
+        sparseSize = XXH_HLL_HEADER_SIZE + 4;
+        for (n=0; n<hll->nbSparse; n++) {
+            XXH32_hash_t const index = hll->sparse[n] >> XXH_HLL_RANK_BITS;
+            XXH32_hash_t const delta = index - prev;
+            sparseSize += (delta < (1 << 7)) ? 2 : (delta < (1 << 14)) ? 3 : 4;
+            prev = index;
+        }
+        if (sparseSize >= XXH_hll_denseSize(hll)) sparseSize = 0;
+    }
+    if (dstCapacity < (sparseSize ? sparseSize : XXH_hll_denseSize(hll))) return 0;
+
+    memcpy(out, XXH_hll_magic, 4);
+    out[4] = (unsigned char)hll->precision;
+    out[5] = (unsigned char)(sparseSize == 0);
+    out[6] = out[7] = 0;
+    for (i=0; i<8; i++) out[8+i] = (unsigned char)(hll->seed >> (8*i));
+    pos = XXH_HLL_HEADER_SIZE;
+
+    if (sparseSize) {
+        XXH32_hash_t prev = 0;
+        for (i=0; i<4; i++) out[pos++] = (unsigned char)(hll->nbSparse >> (8*i));
+        for (n=0; n<hll->nbSparse; n++) {
+            XXH32_hash_t const index = hll->sparse[n] >> XXH_HLL_RANK_BITS;
+            XXH32_hash_t delta = index - prev;
+            while (delta >= (1 << 7)) { out[pos++] = (unsigned char)(delta | 0x80); delta >>= 7; }
+            out[pos++] = (unsigned char)delta;
+            out[pos++] = (unsigned char)(hll->sparse[n] & ((1 << XXH_HLL_RANK_BITS) - 1));
+            prev = index;
+        }
+        return pos;
+    }
+
+    {   unsigned char* const reg = hll->registers;
+        unsigned char* expanded = NULL;
+        const unsigned char* src = reg;
+        if (reg == NULL) {   /* sparse sketch, for which the dense encoding is smaller */
+            expanded = (unsigned char*)calloc(nbRegisters, 1);
+            if (expanded == NULL) return 0;
+            for (n=0; n<hll->nbSparse; n++)
+                expanded[hll->sparse[n] >> XXH_HLL_RANK_BITS] = (unsigned char)(hll->sparse[n] & ((1 << XXH_HLL_RANK_BITS) - 1));
+            src = expanded;
+        }
+        for (n=0; n<nbRegisters; n+=4) {
+            XXH32_hash_t const v = (XXH32_hash_t)src[n] | ((XXH32_hash_t)src[n+1] << 6)
+                                 | ((XXH32_hash_t)src[n+2] << 12) | ((XXH32_hash_t)src[n+3] << 18);
+            out[pos++] = (unsigned char)v; out[pos++] = (unsigned char)(v >> 8); out[pos++] = (unsigned char)(v >> 16);
+        }
+        free(expanded);
+    }
+    return pos;
+}
+
+/*! XXH_hll_deserialize() :
+ *  @return : a new sketch, to be released with XXH_hll_free(),
+ *            or NULL if `src` is not a valid serialized sketch, or on allocation failure */
+XXH_HEADER_API XXH_hll_t* XXH_hll_deserialize(const void* src, size_t srcSize)
+{
+    const unsigned char* const in = (const unsigned char*)src;
+    unsigned long long seed = 0;
+    unsigned maxRank;
+    XXH_hll_t* hll;
+    size_t pos = XXH_HLL_HEADER_SIZE, n;
+    int i;
+    if (srcSize < XXH_HLL_HEADER_SIZE) return NULL;
+    if (memcmp(in, XXH_hll_magic, 4) || (in[5] > 1) || in[6] || in[7]) return NULL;
+    for (i=7; i>=0; i--) seed = (seed << 8) | in[8+i];
+    hll = XXH_hll_create(in[4], seed);
+    if (hll == NULL) return NULL;
+    maxRank = 65 - hll->precision;
+
+    if (in[5]) {   /* dense */
+        size_t const nbRegisters = XXH_hll_nbRegisters(hll);
+        if ((srcSize != XXH_hll_denseSize(hll)) || XXH_hll_densify(hll)) { XXH_hll_free(hll); return NULL; }
+        for (n=0; n<nbRegisters; n+=4) {
+            XXH32_hash_t const v = (XXH32_hash_t)in[pos] | ((XXH32_hash_t)in[pos+1] << 8) | ((XXH32_hash_t)in[pos+2] << 16);
+            unsigned r;
+            pos += 3;
+            for (r=0; r<4; r++) {
+                unsigned const rank = (v >> (6*r)) & 63;
+                if (rank > maxRank) { XXH_hll_free(hll); return NULL; }
+                hll->registers[n+r] = (unsigned char)rank;
+        }   }
+        return hll;
+    }
+
+    {   XXH32_hash_t nbEntries = 0, index = 0;
+        if (srcSize < XXH_HLL_HEADER_SIZE + 4) { XXH_hll_free(hll); return NULL; }
+        for (i=3; i>=0; i--) nbEntries = (nbEntries << 8) | in[pos+(size_t)i];
+        pos += 4;
+        for (n=0; n<nbEntries; n++) {
+            XXH32_hash_t delta = 0;
+            unsigned shift = 0;
+            unsigned rank;
+            do {
+                if ((pos >= srcSize) || (shift > 14)) { XXH_hll_free(hll); return NULL; }
+                delta |= (XXH32_hash_t)(in[pos] & 0x7F) << shift;
+                shift += 7;
+            } while (in[pos++] & 0x80);
+            if ((pos >= srcSize) || ((n > 0) && (delta == 0))) { XXH_hll_free(hll); return NULL; }
+            index += delta;
+            rank = in[pos++];
+            if ((index >= XXH_hll_nbRegisters(hll)) || (rank == 0) || (rank > maxRank)
+              || XXH_hll_addEntry(hll, index, rank)) {
+                XXH_hll_free(hll); return NULL;
+        }   }
+        if (pos != srcSize) { XXH_hll_free(hll); return NULL; }
+    }
+    return hll;
+}
+
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* XXH_HLL_H_5820473169 */
@@ -0,0 +1,508 @@
+/*
+   xxHash - Extremely Fast Hash algorithm
+   Open-addressing hash map with SIMD group probing, header-only companion module
+   Copyright (C) 2012-2016, Yann Collet.
+
+   BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are
+   met:
+
+       * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+       * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following disclaimer
+   in the documentation and/or other materials provided with the
+   distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+   You can contact the author at :
+   - xxHash source repository : https://github.com/Cyan4973/xxHash
+*/
+
+/* Usage :
+ *     XXH_map_t* const map = XXH_map_create(0, 0, 0);   (byte-string keys)
+ *     XXH_map_insert(map, key, keyLength, value);
+ *     {   void** const v = XXH_map_find(map, key, keyLength);
+ *         if (v != NULL) { ... *v ... }
+ *     }
+ *     XXH_map_free(map);
+ *
+ * Swiss table layout : each slot has a control byte, either EMPTY, DELETED,
+ * or the 7 lowest bits of the key's hash (H2). The remaining bits (H1) select the first slot.
+ * Lookups compare H2 with a whole group of control bytes at once
+ * (16 with SSE2, 8 with NEON or 64-bit integers, 4 otherwise),
+ * so that keys are only compared when their tag matches,
+ * and groups are probed quadratically until one contains an EMPTY slot.
+ * The map holds at most 7/8 of its capacity, tombstones included.
+ *
+ * Two kinds of keys :
+ * - keySize == 0 : byte strings of any length. Keys are referenced, not copied :
+ *                  they must remain valid and unchanged while in the map.
+ * - keySize  > 0 : fixed-size keys (integers, structures without padding), copied into the map.
+ *                  `length` must then be keySize.
+ * Values are `void*`.
+ *
+ * Keys are hashed with XXH_auto() (XXH32_auto() with XXH_NO_LONG_LONG) :
+ * map contents are valid within a process only.
+ */
+
+#ifndef XXH_MAP_H_3096127485
+#define XXH_MAP_H_3096127485
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>   /* size_t */
+#include <stdlib.h>   /* malloc, free */
+#include <string.h>   /* memset, memcpy, memcmp */
+#include "xxh_common.h"
+
+
+/* Group probing :
+ * a match mask has one bit per control byte with SSE2 (XXH_MAP_MASK_SHIFT 0),
+ * or the top bit of each byte otherwise (XXH_MAP_MASK_SHIFT 3) */
+#if defined(XXH_COMMON_SSE2)
+#  define XXH_MAP_SSE2 1
+#  define XXH_MAP_GROUP_WIDTH 16
+#  define XXH_MAP_MASK_SHIFT  0
+   typedef unsigned XXH_map_mask_t;
+#elif defined(XXH_COMMON_NEON) && !defined(XXH_NO_LONG_LONG) \
+   && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#  define XXH_MAP_NEON 1
+#  define XXH_MAP_GROUP_WIDTH 8
+#  define XXH_MAP_MASK_SHIFT  3
+   typedef unsigned long long XXH_map_mask_t;
+#elif !defined(XXH_NO_LONG_LONG)
+#  define XXH_MAP_GROUP_WIDTH 8
+#  define XXH_MAP_MASK_SHIFT  3
+   typedef unsigned long long XXH_map_mask_t;
+#else
+#  define XXH_MAP_GROUP_WIDTH 4
+#  define XXH_MAP_MASK_SHIFT  3
+   typedef XXH32_hash_t XXH_map_mask_t;
+#endif
+
+
+/* ****************************
+ *  Definitions
+ ******************************/
+#define XXH_MAP_MIN_CAPACITY 16   /* >= XXH_MAP_GROUP_WIDTH, and capacity / 8 >= 1 : there is always an EMPTY slot */
+#define XXH_MAP_EMPTY    0x80
+#define XXH_MAP_DELETED  0xFE
+#define XXH_MAP_H1(h)    ((h) >> 7)
+#define XXH_MAP_H2(h)    ((unsigned char)((h) & 0x7F))
+
+typedef struct {
+    const void* ptr;
+    size_t length;
+    size_t hash;       /* kept, so that growing doesn't read keys again */
+} XXH_map_strKey_t;
+
+typedef struct {
+    unsigned char*    ctrl;       /* capacity + XXH_MAP_GROUP_WIDTH : the first group is cloned at the end */
+    XXH_map_strKey_t* strKeys;    /* keySize == 0 */
+    unsigned char*    fixedKeys;  /* keySize > 0 : capacity * keySize */
+    void**            values;
+    size_t capacity;              /* power of 2, >= XXH_MAP_MIN_CAPACITY */
+    size_t size;
+    size_t growthLeft;            /* insertions into EMPTY slots before a rehash */
+    size_t keySize;
+    size_t seed;
+} XXH_map_t;
+
+
+/* ****************************
+ *  Group operations
+ ******************************/
+#if !defined(XXH_MAP_SSE2) && !defined(XXH_MAP_NEON)
+XXH_HEADER_API XXH_map_mask_t XXH_map_loadGroup(const unsigned char* ctrl)
+{
+    const union { XXH32_hash_t u; unsigned char c[4]; } one = { 1 };
+    XXH_map_mask_t v = 0;
+    if (one.c[0]) {   /* little endian : byte i in bits 8i-8i+7 */
+        memcpy(&v, ctrl, sizeof(v));
+    } else {
+        int i;
+        for (i=XXH_MAP_GROUP_WIDTH-1; i>=0; i--) v = (v << 8) | ctrl[i];
+    }
+    return v;
+}
+#  define XXH_MAP_LSBS ((XXH_map_mask_t)-1 / 0xFF)
+#  define XXH_MAP_MSBS (XXH_MAP_LSBS << 7)
+#endif
+
+/* XXH_map_matchH2() : control bytes equal to `h2`.
+ * The portable version may report false positives, which key comparison eliminates. */
+XXH_HEADER_API XXH_map_mask_t XXH_map_matchH2(const unsigned char* ctrl, unsigned char h2)
+{
+#if defined(XXH_MAP_SSE2)
+    __m128i const group = _mm_loadu_si128((const __m128i*)(const void*)ctrl);
+    return (XXH_map_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+#elif defined(XXH_MAP_NEON)
+    uint8x8_t const eq = vceq_u8(vld1_u8(ctrl), vdup_n_u8(h2));
+    return vget_lane_u64(vreinterpret_u64_u8(eq), 0) & 0x8080808080808080ULL;
+#else
+    XXH_map_mask_t const x = XXH_map_loadGroup(ctrl) ^ (XXH_MAP_LSBS * h2);
+    return (x - XXH_MAP_LSBS) & ~x & XXH_MAP_MSBS;
+#endif
+}
+
+/* XXH_map_matchEmpty() : EMPTY control bytes */
+XXH_HEADER_API XXH_map_mask_t XXH_map_matchEmpty(const unsigned char* ctrl)
+{
+#if defined(XXH_MAP_SSE2)
+    __m128i const group = _mm_loadu_si128((const __m128i*)(const void*)ctrl);
+    return (XXH_map_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)XXH_MAP_EMPTY)));
+#elif defined(XXH_MAP_NEON)
+    uint8x8_t const eq = vceq_u8(vld1_u8(ctrl), vdup_n_u8(XXH_MAP_EMPTY));
+    return vget_lane_u64(vreinterpret_u64_u8(eq), 0) & 0x8080808080808080ULL;
+#else
+    XXH_map_mask_t const g = XXH_map_loadGroup(ctrl);
+    return g & ~(g << 6) & XXH_MAP_MSBS;   /* top bit set, bit 1 clear */
+#endif
+}
+
+/* XXH_map_matchFree() : EMPTY or DELETED control bytes (top bit set) */
+XXH_HEADER_API XXH_map_mask_t XXH_map_matchFree(const unsigned char* ctrl)
+{
+#if defined(XXH_MAP_SSE2)
+    return (XXH_map_mask_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(const void*)ctrl));
+#elif defined(XXH_MAP_NEON)
+    return vget_lane_u64(vreinterpret_u64_u8(vld1_u8(ctrl)), 0) & 0x8080808080808080ULL;
+#else
+    return XXH_map_loadGroup(ctrl) & XXH_MAP_MSBS;
+#endif
+}
+
+/* XXH_map_firstMatch() : index, within its group, of the first control byte of non-zero `mask` */
+XXH_HEADER_API size_t XXH_map_firstMatch(XXH_map_mask_t mask)
+{
+#if defined(__GNUC__) && !defined(XXH_NO_LONG_LONG)
+    return (size_t)__builtin_ctzll(mask) >> XXH_MAP_MASK_SHIFT;
+#elif defined(__GNUC__)
+    return (size_t)__builtin_ctz(mask) >> XXH_MAP_MASK_SHIFT;
+#else
+    size_t n = 0;
+    while (!(mask & 1)) { mask >>= 1; n++; }
+    return n >> XXH_MAP_MASK_SHIFT;
+#endif
+}
+
+
+/* ****************************
+ *  Internal functions
+ ******************************/
+XXH_HEADER_API size_t XXH_map_hash(const XXH_map_t* map, const void* key, size_t length)
+{
+#ifndef XXH_NO_LONG_LONG
+    return XXH_auto(key, length, map->seed);
+#else
+    return XXH32_auto(key, length, (unsigned)map->seed);
+#endif
+}
+
+XXH_HEADER_API void XXH_map_setCtrl(XXH_map_t* map, size_t slot, unsigned char c)
+{
+    map->ctrl[slot] = c;
+    if (slot < XXH_MAP_GROUP_WIDTH) map->ctrl[map->capacity + slot] = c;
+}
+
+XXH_HEADER_API int XXH_map_keyEqual(const XXH_map_t* map, size_t slot, const void* key, size_t length, size_t hash)
+{
+    if (map->keySize) {
+        const unsigned char* const k = map->fixedKeys + slot * map->keySize;
+#ifndef XXH_NO_LONG_LONG
+        if (map->keySize == 8) {
+            unsigned long long a, b;
+            memcpy(&a, k, 8); memcpy(&b, key, 8);
+            return a == b;
+        }
+#endif
+        if (map->keySize == 4) {
+            XXH32_hash_t a, b;
+            memcpy(&a, k, 4); memcpy(&b, key, 4);
+            return a == b;
+        }
+        return !memcmp(k, key, map->keySize);
+    } else {
+        const XXH_map_strKey_t* const k = map->strKeys + slot;
+        return (k->hash == hash) && (k->length == length) && !memcmp(k->ptr, key, length);
+    }
+}
+
+/* XXH_map_findSlot() : @return : slot of `key`, or capacity if absent */
+XXH_HEADER_API size_t XXH_map_findSlot(const XXH_map_t* map, const void* key, size_t length, size_t hash)
+{
+    size_t const mask = map->capacity - 1;
+    unsigned char const h2 = XXH_MAP_H2(hash);
+    size_t pos = XXH_MAP_H1(hash) & mask;
+    size_t step = 0;
+    for (;;) {
+        const unsigned char* const group = map->ctrl + pos;
+        XXH_map_mask_t m = XXH_map_matchH2(group, h2);
+        while (m) {
+            size_t const slot = (pos + XXH_map_firstMatch(m)) & mask;
+            if (XXH_map_keyEqual(map, slot, key, length, hash)) return slot;
+            m &= m - 1;
+        }
+        if (XXH_map_matchEmpty(group)) return map->capacity;
+        step += XXH_MAP_GROUP_WIDTH;   /* triangular progression over groups : visits all of them */
+        pos = (pos + step) & mask;
+    }
+}
+
+/* XXH_map_findSlotOrFree() : same as XXH_map_findSlot(), in the same pass,
+ * `*freeSlot` receives the first EMPTY or DELETED slot on the probe sequence of `hash`
+ * (only meaningful when `key` is absent) */
+XXH_HEADER_API size_t XXH_map_findSlotOrFree(const XXH_map_t* map, const void* key, size_t length, size_t hash, size_t* freeSlot)
+{
+    size_t const mask = map->capacity - 1;
+    unsigned char const h2 = XXH_MAP_H2(hash);
+    size_t pos = XXH_MAP_H1(hash) & mask;
+    size_t step = 0;
+    int freeFound = 0;
+    for (;;) {
+        const unsigned char* const group = map->ctrl + pos;
+        XXH_map_mask_t m = XXH_map_matchH2(group, h2);
+        while (m) {
+            size_t const slot = (pos + XXH_map_firstMatch(m)) & mask;
+            if (XXH_map_keyEqual(map, slot, key, length, hash)) return slot;
+            m &= m - 1;
+        }
+        if (!freeFound) {
+            XXH_map_mask_t const f = XXH_map_matchFree(group);
+            if (f) { *freeSlot = (pos + XXH_map_firstMatch(f)) & mask; freeFound = 1; }
+        }
+        if (XXH_map_matchEmpty(group)) return map->capacity;   /* implies freeFound */
+        step += XXH_MAP_GROUP_WIDTH;
+        pos = (pos + step) & mask;
+    }
+}
+
+/* XXH_map_findFree() : @return : first EMPTY or DELETED slot on the probe sequence of `hash` */
+XXH_HEADER_API size_t XXH_map_findFree(const XXH_map_t* map, size_t hash)
+{
+    size_t const mask = map->capacity - 1;
+    size_t pos = XXH_MAP_H1(hash) & mask;
+    size_t step = 0;
+    for (;;) {
+        XXH_map_mask_t const m = XXH_map_matchFree(map->ctrl + pos);
+        if (m) return (pos + XXH_map_firstMatch(m)) & mask;
+        step += XXH_MAP_GROUP_WIDTH;
+        pos = (pos + step) & mask;
+    }
+}
+
+/* XXH_map_allocSlots() : allocates empty slots for `capacity`, replacing current ones (not freed).
+ * @return : 0 on success, 1 on allocation failure or size overflow (map unchanged) */
+XXH_HEADER_API int XXH_map_allocSlots(XXH_map_t* map, size_t capacity)
+{
+    size_t const slotSize = 1 + sizeof(void*) + (map->keySize ? map->keySize : sizeof(XXH_map_strKey_t));
+    unsigned char* ctrl;
+    void** values;
+    XXH_map_strKey_t* strKeys = NULL;
+    unsigned char* fixedKeys = NULL;
+    if ((capacity == 0) || (capacity > ((size_t)-1 >> 1) / slotSize)) return 1;
+    ctrl = (unsigned char*)malloc(capacity + XXH_MAP_GROUP_WIDTH);
+    values = (void**)malloc(capacity * sizeof(void*));
+    if (map->keySize) fixedKeys = (unsigned char*)malloc(capacity * map->keySize);
+    else strKeys = (XXH_map_strKey_t*)malloc(capacity * sizeof(XXH_map_strKey_t));
+    if (!ctrl || !values || (!strKeys && !fixedKeys)) {
+        free(ctrl); free(values); free(strKeys); free(fixedKeys);
+        return 1;
+    }
+    memset(ctrl, XXH_MAP_EMPTY, capacity + XXH_MAP_GROUP_WIDTH);
+    map->ctrl = ctrl;
+    map->values = values;
+    map->strKeys = strKeys;
+    map->fixedKeys = fixedKeys;
+    map->capacity = capacity;
+    map->growthLeft = capacity - capacity / 8 - map->size;
+    return 0;
+}
+
+XXH_HEADER_API void XXH_map_freeSlots(XXH_map_t* map)
+{
+    free(map->ctrl);
+    free(map->values);
+    free(map->strKeys);
+    free(map->fixedKeys);
+}
+
+/* XXH_map_rehash() : moves all entries into `capacity` slots, dropping tombstones.
+ * @return : 0 on success, 1 on allocation failure or size overflow (map unchanged) */
+XXH_HEADER_API int XXH_map_rehash(XXH_map_t* map, size_t capacity)
+{
+    XXH_map_t old = *map;
+    size_t i;
+    if (XXH_map_allocSlots(map, capacity)) return 1;
+    for (i=0; i<old.capacity; i++) {
+        size_t hash, slot;
+        if (old.ctrl[i] & 0x80) continue;   /* EMPTY or DELETED */
+        hash = old.keySize ? XXH_map_hash(map, old.fixedKeys + i * old.keySize, old.keySize) : old.strKeys[i].hash;
+        slot = XXH_map_findFree(map, hash);
+        XXH_map_setCtrl(map, slot, XXH_MAP_H2(hash));
+        if (map->keySize) memcpy(map->fixedKeys + slot * map->keySize, old.fixedKeys + i * old.keySize, old.keySize);
+        else map->strKeys[slot] = old.strKeys[i];
+        map->values[slot] = old.values[i];
+    }
+    XXH_map_freeSlots(&old);
+    return 0;
+}
+
+
+/* ****************************
+ *  Public functions
+ ******************************/
+/*! XXH_map_create() :
+ *  `keySize` : 0 for byte-string keys, or size of fixed-size keys.
+ *  `capacityHint` : expected number of entries (0 if unknown) : avoids rehashing while growing.
+ *  @return : NULL on allocation failure */
+XXH_HEADER_API XXH_map_t* XXH_map_create(size_t keySize, size_t capacityHint, size_t seed)
+{
+    XXH_map_t* const map = (XXH_map_t*)malloc(sizeof(XXH_map_t));
+    size_t capacity = XXH_MAP_MIN_CAPACITY;
+    if (map == NULL) return NULL;
+    while (capacity - capacity / 8 < capacityHint) {
+        if (capacity > ((size_t)-1 >> 2) / (keySize + sizeof(XXH_map_strKey_t))) { free(map); return NULL; }
+        capacity *= 2;
+    }
+    memset(map, 0, sizeof(*map));
+    map->keySize = keySize;
+    map->seed = seed;
+    if (XXH_map_allocSlots(map, capacity)) { free(map); return NULL; }
+    return map;
+}
+
+XXH_HEADER_API void XXH_map_free(XXH_map_t* map)
+{
+    if (map == NULL) return;
+    XXH_map_freeSlots(map);
+    free(map);
+}
+
+XXH_HEADER_API size_t XXH_map_size(const XXH_map_t* map) { return map->size; }
+
+/*! XXH_map_clear() : removes all entries, keeping capacity */
+XXH_HEADER_API void XXH_map_clear(XXH_map_t* map)
+{
+    memset(map->ctrl, XXH_MAP_EMPTY, map->capacity + XXH_MAP_GROUP_WIDTH);
+    map->size = 0;
+    map->growthLeft = map->capacity - map->capacity / 8;
+}
+
+/*! XXH_map_find() :
+ *  @return : pointer to the value of `key`, valid until next insertion or erasure,
+ *            or NULL if `key` is absent */
+XXH_HEADER_API void** XXH_map_find(const XXH_map_t* map, const void* key, size_t length)
+{
+    size_t slot;
+    if (map->keySize && (length != map->keySize)) return NULL;
+    slot = XXH_map_findSlot(map, key, length, XXH_map_hash(map, key, length));
+    return (slot < map->capacity) ? map->values + slot : NULL;
+}
+
+/*! XXH_map_findOrInsert() :
+ *  Inserts `key` if absent, with a NULL value.
+ *  `inserted` : if not NULL, set to 1 if `key` was inserted, 0 if it was present.
+ *  @return : pointer to the value of `key`, valid until next insertion or erasure,
+ *            or NULL on allocation failure, or if `length` isn't keySize */
+XXH_HEADER_API void** XXH_map_findOrInsert(XXH_map_t* map, const void* key, size_t length, int* inserted)
+{
+    size_t hash, slot, freeSlot = 0;
+    if (map->keySize && (length != map->keySize)) return NULL;
+    hash = XXH_map_hash(map, key, length);
+    slot = XXH_map_findSlotOrFree(map, key, length, hash, &freeSlot);
+    if (slot < map->capacity) {
+        if (inserted) *inserted = 0;
+        return map->values + slot;
+    }
+    slot = freeSlot;
+    if ((map->growthLeft == 0) && (map->ctrl[slot] == XXH_MAP_EMPTY)) {
+        /* grow, unless tombstones account for most used slots */
+        size_t const capacity = (map->size + 1 > map->capacity * 7 / 16) ? map->capacity * 2 : map->capacity;
+        if ((capacity < map->capacity) || XXH_map_rehash(map, capacity)) return NULL;
+        slot = XXH_map_findFree(map, hash);
+    }
+    if (map->ctrl[slot] == XXH_MAP_EMPTY) map->growthLeft--;
+    XXH_map_setCtrl(map, slot, XXH_MAP_H2(hash));
+    if (map->keySize) {
+        memcpy(map->fixedKeys + slot * map->keySize, key, map->keySize);
+    } else {
+        map->strKeys[slot].ptr = key;
+        map->strKeys[slot].length = length;
+        map->strKeys[slot].hash = hash;
+    }
+    map->values[slot] = NULL;
+    map->size++;
+    if (inserted) *inserted = 1;
+    return map->values + slot;
+}
+
+/*! XXH_map_insert() :
+ *  Sets the value of `key`, inserting it if absent.
+ *  @return : 1 if `key` was inserted, 0 if it was present, -1 on failure (see XXH_map_findOrInsert()) */
+XXH_HEADER_API int XXH_map_insert(XXH_map_t* map, const void* key, size_t length, void* value)
+{
+    int inserted;
+    void** const v = XXH_map_findOrInsert(map, key, length, &inserted);
+    if (v == NULL) return -1;
+    *v = value;
+    return inserted;
+}
+
+/*! XXH_map_erase() :
+ *  @return : 1 if `key` was removed, 0 if it was absent */
+XXH_HEADER_API int XXH_map_erase(XXH_map_t* map, const void* key, size_t length)
+{
+    size_t slot;
+    if (map->keySize && (length != map->keySize)) return 0;
+    slot = XXH_map_findSlot(map, key, length, XXH_map_hash(map, key, length));
+    if (slot == map->capacity) return 0;
+    XXH_map_setCtrl(map, slot, XXH_MAP_DELETED);
+    map->size--;
+    return 1;
+}
+
+/*! XXH_map_next() :
+ *  Iterates over entries, in no particular order. `*pos` must start at 0.
+ *  Entries must not be inserted during iteration; the current one may be erased.
+ *  @return : 1 and the next entry (`key` points into the map for fixed-size keys), 0 at the end */
+XXH_HEADER_API int XXH_map_next(const XXH_map_t* map, size_t* pos, const void** key, size_t* length, void** value)
+{
+    while (*pos < map->capacity) {
+        size_t const slot = (*pos)++;
+        if (map->ctrl[slot] & 0x80) continue;
+        if (map->keySize) {
+            *key = map->fixedKeys + slot * map->keySize;
+            *length = map->keySize;
+        } else {
+            *key = map->strKeys[slot].ptr;
+            *length = map->strKeys[slot].length;
+        }
+        *value = map->values[slot];
+        return 1;
+    }
+    return 0;
+}
+
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* XXH_MAP_H_3096127485 */
@@ -0,0 +1,447 @@
+/*
+   xxHash - Extremely Fast Hash algorithm
+   MinHash signatures and LSH banding, header-only companion module
+   Copyright (C) 2012-2016, Yann Collet.
+
+   BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are
+   met:
+
+       * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+       * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following disclaimer
+   in the documentation and/or other materials provided with the
+   distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+   You can contact the author at :
+   - xxHash source repository : https://github.com/Cyan4973/xxHash
+*/
+
+/* Usage :
+ *     XXH_minhash_t* const mh = XXH_minhash_create(128, XXH_minhash_kPermutations, 0);
+ *     XXH32_hash_t sigA[128], sigB[128];
+ *     XXH_minhash_init(mh, sigA);
+ *     XXH_minhash_addShingles(mh, sigA, text, textLength, 5);   (or XXH_minhash_add() per token)
+ *     XXH_minhash_finalize(mh, sigA);
+ *     ... same for sigB ...
+ *     printf("Jaccard similarity ~%.2f \n", XXH_minhash_similarity(sigA, sigB, 128));
+ *     XXH_minhash_free(mh);
+ *
+ * A signature is an array of nbSlots 32-bit values, owned by the caller.
+ * The fraction of equal slots between 2 signatures estimates the Jaccard similarity of their sets,
+ * with a standard error of sqrt(J(1-J)/nbSlots).
+ *
+ * Each token is hashed once, with XXH64(). Two ways to fill slots :
+ * - XXH_minhash_kPermutations : the 32-bit folded hash goes through one cheap permutation per slot,
+ *                   x -> ((x ^ mask) * odd) ^ (>> 16), and each slot keeps its minimum.
+ *                   Slots are processed 4 at a time with SSE2 or NEON.
+ * - XXH_minhash_onePermutation : the upper 32 bits of the hash select a single slot,
+ *                   which keeps the minimum of the lower 32 bits. Much faster for large nbSlots,
+ *                   but only accurate for sets larger than nbSlots : empty slots are filled
+ *                   by XXH_minhash_finalize(), copying another slot (optimal densification).
+ *
+ * Signatures are comparable when computed by engines with same nbSlots, method and seed.
+ */
+
+#ifndef XXH_MINHASH_H_2740619853
+#define XXH_MINHASH_H_2740619853
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>   /* size_t */
+#include <stdlib.h>   /* malloc, free */
+#include <string.h>   /* memset */
+#include "xxh_common.h"
+
+#ifdef XXH_NO_LONG_LONG
+#  error xxh_minhash.h requires XXH64
+#endif
+
+
+#if defined(XXH_COMMON_SSE2) && defined(__SSE4_1__)
+#  include <smmintrin.h>
+#endif
+
+
+/* ****************************
+ *  Definitions
+ ******************************/
+#define XXH_MINHASH_MAX_SLOTS  4096
+#define XXH_MINHASH_EMPTY      0xFFFFFFFFU   /* slot of an empty set */
+
+typedef enum { XXH_minhash_kPermutations, XXH_minhash_onePermutation } XXH_minhash_method_e;
+
+typedef struct {
+    XXH32_hash_t* xorMasks;      /* kPermutations : one permutation per slot */
+    XXH32_hash_t* multipliers;   /* odd */
+    size_t nbSlots;              /* multiple of 4 */
+    XXH_minhash_method_e method;
+    unsigned long long seed;
+} XXH_minhash_t;
+
+
+/* ****************************
+ *  Creation
+ ******************************/
+/*! XXH_minhash_create() :
+ *  `nbSlots` : signature length, a multiple of 4, up to 4096.
+ *  @return : NULL on invalid parameters or allocation failure */
+XXH_HEADER_API XXH_minhash_t* XXH_minhash_create(size_t nbSlots, XXH_minhash_method_e method, unsigned long long seed)
+{
+    XXH_minhash_t* mh;
+    size_t n;
+    if ((nbSlots == 0) || (nbSlots % 4) || (nbSlots > XXH_MINHASH_MAX_SLOTS)) return NULL;
+    if ((method != XXH_minhash_kPermutations) && (method != XXH_minhash_onePermutation)) return NULL;
+    mh = (XXH_minhash_t*)malloc(sizeof(XXH_minhash_t));
+    if (mh == NULL) return NULL;
+    mh->nbSlots = nbSlots;
+    mh->method = method;
+    mh->seed = seed;
+    mh->xorMasks = (XXH32_hash_t*)malloc(nbSlots * sizeof(XXH32_hash_t));
+    mh->multipliers = (XXH32_hash_t*)malloc(nbSlots * sizeof(XXH32_hash_t));
+    if (!mh->xorMasks || !mh->multipliers) {
+        free(mh->xorMasks); free(mh->multipliers); free(mh);
+        return NULL;
+    }
+    /* permutation parameters : a splitmix64 sequence from seed, identical on all platforms */
+    {   unsigned long long state = seed;
+        for (n=0; n<nbSlots; n++) {
+            unsigned long long z;
+            state += 0x9E3779B97F4A7C15ULL;
+            z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            z ^= z >> 31;
+            mh->xorMasks[n] = (XXH32_hash_t)z;
+            mh->multipliers[n] = (XXH32_hash_t)(z >> 32) | 1;
+    }   }
+    return mh;
+}
+
+XXH_HEADER_API void XXH_minhash_free(XXH_minhash_t* mh)
+{
+    if (mh == NULL) return;
+    free(mh->xorMasks);
+    free(mh->multipliers);
+    free(mh);
+}
+
+/*! XXH_minhash_init() : prepares `signature` (nbSlots values) for an empty set */
+XXH_HEADER_API void XXH_minhash_init(const XXH_minhash_t* mh, XXH32_hash_t* signature)
+{
+    size_t n;
+    for (n=0; n<mh->nbSlots; n++) signature[n] = XXH_MINHASH_EMPTY;
+}
+
+
+/* ****************************
+ *  Vector helpers
+ ******************************/
+#if defined(XXH_COMMON_SSE2)
+/* unsigned 32-bit operations missing from SSE2 */
+XXH_HEADER_API __m128i XXH_minhash_mullo32(__m128i a, __m128i b)
+{
+#  if defined(__SSE4_1__)
+    return _mm_mullo_epi32(a, b);
+#  else
+    __m128i const even = _mm_mul_epu32(a, b);
+    __m128i const odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0,0,2,0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0,0,2,0)));
+#  endif
+}
+
+XXH_HEADER_API __m128i XXH_minhash_min32(__m128i a, __m128i b)
+{
+#  if defined(__SSE4_1__)
+    return _mm_min_epu32(a, b);
+#  else
+    __m128i const bias = _mm_set1_epi32((int)0x80000000U);
+    __m128i const aLower = _mm_cmpgt_epi32(_mm_xor_si128(b, bias), _mm_xor_si128(a, bias));
+    return _mm_or_si128(_mm_and_si128(aLower, a), _mm_andnot_si128(aLower, b));
+#  endif
+}
+#endif
+
+
+/* ****************************
+ *  Adding tokens
+ ******************************/
+/*! XXH_minhash_addHash() :
+ *  Adds a token of hash `hash` (XXH64(token, length, seed)) to `signature` */
+XXH_HEADER_API void XXH_minhash_addHash(const XXH_minhash_t* mh, XXH32_hash_t* signature, XXH64_hash_t hash)
+{
+    if (mh->method == XXH_minhash_onePermutation) {
+        size_t const slot = (size_t)(((hash >> 32) * (unsigned long long)mh->nbSlots) >> 32);
+        XXH32_hash_t const v = (XXH32_hash_t)hash;
+        if (v < signature[slot]) signature[slot] = v;
+        return;
+    }
+    {   XXH32_hash_t const x = (XXH32_hash_t)(hash ^ (hash >> 32));
+        size_t n;
+#if defined(XXH_COMMON_SSE2)
+        __m128i const vx = _mm_set1_epi32((int)x);
+        for (n=0; n<mh->nbSlots; n+=4) {
+            __m128i const mask = _mm_loadu_si128((const __m128i*)(const void*)(mh->xorMasks + n));
+            __m128i const mult = _mm_loadu_si128((const __m128i*)(const void*)(mh->multipliers + n));
+            __m128i* const s = (__m128i*)(void*)(signature + n);
+            __m128i v = XXH_minhash_mullo32(_mm_xor_si128(vx, mask), mult);
+            v = _mm_xor_si128(v, _mm_srli_epi32(v, 16));
+            _mm_storeu_si128(s, XXH_minhash_min32(_mm_loadu_si128(s), v));
+        }
+#elif defined(XXH_COMMON_NEON)
+        uint32x4_t const vx = vdupq_n_u32(x);
+        for (n=0; n<mh->nbSlots; n+=4) {
+            uint32x4_t v = vmulq_u32(veorq_u32(vx, vld1q_u32(mh->xorMasks + n)), vld1q_u32(mh->multipliers + n));
+            v = veorq_u32(v, vshrq_n_u32(v, 16));
+            vst1q_u32(signature + n, vminq_u32(vld1q_u32(signature + n), v));
+        }
+#else
+        for (n=0; n<mh->nbSlots; n++) {
+            XXH32_hash_t v = (x ^ mh->xorMasks[n]) * mh->multipliers[n];
+            v ^= v >> 16;
+            if (v < signature[n]) signature[n] = v;
+        }
+#endif
+    }
+}
+
+XXH_HEADER_API void XXH_minhash_add(const XXH_minhash_t* mh, XXH32_hash_t* signature, const void* token, size_t length)
+{
+    XXH_minhash_addHash(mh, signature, XXH64(token, length, mh->seed));
+}
+
+/*! XXH_minhash_addBatch() :
+ *  Same as XXH_minhash_add() over `nbTokens` tokens, hashed XXH_BATCH at a time */
+XXH_HEADER_API void XXH_minhash_addBatch(const XXH_minhash_t* mh, XXH32_hash_t* signature,
+                                         const void* const* tokens, const size_t* lengths, size_t nbTokens)
+{
+    XXH64_hash_t hashes[XXH_BATCH];
+    size_t start, end;
+    for (start=0; start<nbTokens; start=end) {
+        size_t n;
+        end = XXH_hashBatch(hashes, tokens, lengths, nbTokens, start, mh->seed, NULL, NULL);
+        for (n=start; n<end; n++) XXH_minhash_addHash(mh, signature, hashes[n-start]);
+    }
+}
+
+/*! XXH_minhash_addShingles() :
+ *  Adds all `shingleSize`-byte windows of `text` (w-shingling).
+ *  Texts shorter than `shingleSize` are added as a single token. */
+XXH_HEADER_API void XXH_minhash_addShingles(const XXH_minhash_t* mh, XXH32_hash_t* signature,
+                                            const void* text, size_t length, size_t shingleSize)
+{
+    const unsigned char* const p = (const unsigned char*)text;
+    size_t pos;
+    if ((shingleSize == 0) || (length <= shingleSize)) { XXH_minhash_add(mh, signature, text, length); return; }
+    for (pos=0; pos + shingleSize <= length; pos++) XXH_minhash_add(mh, signature, p + pos, shingleSize);
+}
+
+/*! XXH_minhash_merge() :
+ *  Signature of the union of 2 sets, into `dst`.
+ *  With XXH_minhash_onePermutation, merge signatures before XXH_minhash_finalize(). */
+XXH_HEADER_API void XXH_minhash_merge(const XXH_minhash_t* mh, XXH32_hash_t* dst, const XXH32_hash_t* src)
+{
+    size_t n;
+#if defined(XXH_COMMON_SSE2)
+    for (n=0; n<mh->nbSlots; n+=4) {
+        __m128i* const d = (__m128i*)(void*)(dst + n);
+        _mm_storeu_si128(d, XXH_minhash_min32(_mm_loadu_si128(d), _mm_loadu_si128((const __m128i*)(const void*)(src + n))));
+    }
+#elif defined(XXH_COMMON_NEON)
+    for (n=0; n<mh->nbSlots; n+=4) vst1q_u32(dst + n, vminq_u32(vld1q_u32(dst + n), vld1q_u32(src + n)));
+#else
+    for (n=0; n<mh->nbSlots; n++) if (src[n] < dst[n]) dst[n] = src[n];
+#endif
+}
+
+/*! XXH_minhash_finalize() :
+ *  With XXH_minhash_onePermutation, fills empty slots : each one copies the first non-empty slot
+ *  of a pseudo-random sequence depending only on the slot number and seed,
+ *  so that 2 sets with the same slot values also copy the same ones.
+ *  Does nothing with XXH_minhash_kPermutations, or for an empty set. */
+XXH_HEADER_API void XXH_minhash_finalize(const XXH_minhash_t* mh, XXH32_hash_t* signature)
+{
+    unsigned char wasEmpty[XXH_MINHASH_MAX_SLOTS / 8];   /* sources must be slots filled by tokens */
+    size_t const nbSlots = mh->nbSlots;
+    size_t n, nbEmpty = 0;
+    if (mh->method != XXH_minhash_onePermutation) return;
+    memset(wasEmpty, 0, (nbSlots + 7) / 8);
+    for (n=0; n<nbSlots; n++) {
+        if (signature[n] != XXH_MINHASH_EMPTY) continue;
+        wasEmpty[n >> 3] |= (unsigned char)(1 << (n & 7));
+        nbEmpty++;
+    }
+    if ((nbEmpty == 0) || (nbEmpty == nbSlots)) return;
+    for (n=0; n<nbSlots; n++) {
+        XXH32_hash_t attempt = 0;
+        size_t source;
+        if (!(wasEmpty[n >> 3] & (1 << (n & 7)))) continue;
+        do {   /* (slot, attempt), serialized little endian */
+            unsigned char input[8];
+            int i;
+            for (i=0; i<4; i++) {
+                input[i] = (unsigned char)((XXH32_hash_t)n >> (8*i));
+                input[4+i] = (unsigned char)(attempt >> (8*i));
+            }
+            source = (size_t)(((unsigned long long)XXH32(input, 8, (XXH32_hash_t)mh->seed) * nbSlots) >> 32);
+            attempt++;
+        } while (wasEmpty[source >> 3] & (1 << (source & 7)));
+        signature[n] = signature[source];
+    }
+}
+
+
+/* ****************************
+ *  Comparison
+ ******************************/
+/*! XXH_minhash_similarity() :
+ *  @return : fraction of equal slots, which estimates the Jaccard similarity of 2 finalized signatures */
+XXH_HEADER_API double XXH_minhash_similarity(const XXH32_hash_t* sig1, const XXH32_hash_t* sig2, size_t nbSlots)
+{
+    size_t const nbVectors = nbSlots & ~(size_t)3;
+    size_t nbEqual = 0;
+    size_t n = 0;
+#if defined(XXH_COMMON_SSE2)
+    for ( ; n < nbVectors; n += 4) {
+        __m128i const eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(const void*)(sig1 + n)),
+                                           _mm_loadu_si128((const __m128i*)(const void*)(sig2 + n)));
+        unsigned mask = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(eq));
+        while (mask) { nbEqual++; mask &= mask - 1; }
+    }
+#elif defined(XXH_COMMON_NEON)
+    {   uint32x4_t count = vdupq_n_u32(0);
+        for ( ; n < nbVectors; n += 4)
+            count = vsubq_u32(count, vceqq_u32(vld1q_u32(sig1 + n), vld1q_u32(sig2 + n)));   /* 0xFFFFFFFF == -1 */
+        nbEqual = vgetq_lane_u32(count, 0) + vgetq_lane_u32(count, 1) + vgetq_lane_u32(count, 2) + vgetq_lane_u32(count, 3);
+    }
+#endif
+    (void)nbVectors;
+    for ( ; n < nbSlots; n++) nbEqual += (sig1[n] == sig2[n]);
+    return nbSlots ? (double)nbEqual / (double)nbSlots : 0.;
+}
+
+
+/* ****************************
+ *  b-bit MinHash
+ ******************************/
+/* Only the lowest b bits of each slot are kept, packed least significant first :
+ * signatures are 32/b times smaller, for a slightly higher variance.
+ * b must be within 1 - 16 : other values are rejected. */
+#define XXH_MINHASH_BBIT_MAX 16
+
+/*! XXH_minhash_bbitSize() :
+ *  @return : size of a b-bit signature, or 0 if `b` is out of range */
+XXH_HEADER_API size_t XXH_minhash_bbitSize(size_t nbSlots, unsigned b)
+{
+    if ((b == 0) || (b > XXH_MINHASH_BBIT_MAX)) return 0;
+    return (nbSlots * b + 7) / 8;
+}
+
+/*! XXH_minhash_toBbit() :
+ *  Writes XXH_minhash_bbitSize(nbSlots, b) bytes into `dst`.
+ *  @return : nb of bytes written, 0 if `b` is out of range */
+XXH_HEADER_API size_t XXH_minhash_toBbit(const XXH32_hash_t* signature, size_t nbSlots, unsigned b, unsigned char* dst)
+{
+    XXH32_hash_t mask, acc = 0;
+    unsigned accBits = 0;
+    size_t n, pos = 0;
+    if ((b == 0) || (b > XXH_MINHASH_BBIT_MAX)) return 0;
+    mask = ((XXH32_hash_t)1 << b) - 1;
+    for (n=0; n<nbSlots; n++) {
+        acc |= (signature[n] & mask) << accBits;
+        accBits += b;
+        while (accBits >= 8) { dst[pos++] = (unsigned char)acc; acc >>= 8; accBits -= 8; }
+    }
+    if (accBits) dst[pos++] = (unsigned char)acc;
+    return pos;
+}
+
+/*! XXH_minhash_similarityBbit() :
+ *  @return : Jaccard similarity estimated from 2 b-bit signatures, or -1.0 if `b` is out of range.
+ *  Random slots match with probability 2^-b : the fraction of matching slots is corrected accordingly. */
+XXH_HEADER_API double XXH_minhash_similarityBbit(const unsigned char* bbit1, const unsigned char* bbit2,
+                                                 size_t nbSlots, unsigned b)
+{
+    XXH32_hash_t mask;
+    size_t nbEqual = 0, n;
+    double chance, matching;
+    if ((b == 0) || (b > XXH_MINHASH_BBIT_MAX)) return -1.;
+    mask = ((XXH32_hash_t)1 << b) - 1;
+    chance = 1. / (double)((XXH32_hash_t)1 << b);
+    for (n=0; n<nbSlots; n++) {
+        size_t const bitPos = n * b;
+        XXH32_hash_t v1 = 0, v2 = 0;
+        unsigned i;
+        for (i=0; i<3; i++) {   /* b <= 16 : 3 bytes hold a value */
+            if ((bitPos >> 3) + i >= XXH_minhash_bbitSize(nbSlots, b)) break;
+            v1 |= (XXH32_hash_t)bbit1[(bitPos >> 3) + i] << (8*i);
+            v2 |= (XXH32_hash_t)bbit2[(bitPos >> 3) + i] << (8*i);
+        }
+        nbEqual += (((v1 ^ v2) >> (bitPos & 7)) & mask) == 0;
+    }
+    if (nbSlots == 0) return 0.;
+    matching = (double)nbEqual / (double)nbSlots;
+    if (matching <= chance) return 0.;
+    return (matching - chance) / (1. - chance);
+}
+
+
+/* ****************************
+ *  LSH banding
+ ******************************/
+/*! XXH_minhash_bandKeys() :
+ *  Splits `signature` into `nbBands` bands of nbSlots / nbBands slots, and hashes each band into `keys`.
+ *  Signatures sharing a band key are candidate pairs : for bands of r slots,
+ *  sets of similarity J become candidates with probability 1 - (1 - J^r)^nbBands,
+ *  the threshold being around (1/nbBands)^(1/r).
+ *  Keys are the same on all platforms. The band number is part of the key.
+ *  @return : 0 on success, 1 if nbBands doesn't divide nbSlots */
+XXH_HEADER_API int XXH_minhash_bandKeys(const XXH_minhash_t* mh, const XXH32_hash_t* signature,
+                                        size_t nbBands, XXH64_hash_t* keys)
+{
+    size_t rows, band;
+    if ((nbBands == 0) || (mh->nbSlots % nbBands)) return 1;
+    rows = mh->nbSlots / nbBands;
+    for (band=0; band<nbBands; band++) {
+        unsigned char buffer[256];   /* band slots, little endian, hashed 64 slots at a time */
+        XXH64_hash_t key = mh->seed + band;
+        size_t r = 0;
+        while (r < rows) {
+            size_t const chunk = (rows - r < 64) ? rows - r : 64;
+            size_t i;
+            for (i=0; i<chunk; i++) {
+                XXH32_hash_t const v = signature[band*rows + r + i];
+                buffer[4*i] = (unsigned char)v; buffer[4*i+1] = (unsigned char)(v >> 8);
+                buffer[4*i+2] = (unsigned char)(v >> 16); buffer[4*i+3] = (unsigned char)(v >> 24);
+            }
+            key = XXH64(buffer, 4*chunk, key);
+            r += chunk;
+        }
+        keys[band] = key;
+    }
+    return 0;
+}
+
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* XXH_MINHASH_H_2740619853 */
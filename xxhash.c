@@ -470,6 +470,78 @@ static U32 XXH_readBE32(const void* ptr)
 #define XXH_STATIC_ASSERT(c)  { enum { XXH_sa = 1/(int)(!!(c)) }; }  /* use after variable declarations */
 XXH_PUBLIC_API unsigned XXH_versionNumber (void) { return XXH_VERSION_NUMBER; }
 
+
+/* *************************************
+*  Instrumentation (XXH_STATS)
+***************************************/
+#ifdef XXH_STATS
+#  if defined(__cplusplus) && (__cplusplus >= 201103L)
+#    define XXH_THREAD_LOCAL thread_local
+#  elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_THREADS__)
+#    define XXH_THREAD_LOCAL _Thread_local
+#  elif defined(__GNUC__)
+#    define XXH_THREAD_LOCAL __thread
+#  elif defined(_MSC_VER)
+#    define XXH_THREAD_LOCAL __declspec(thread)
+#  else
+#    define XXH_THREAD_LOCAL   /* no thread-local storage : counters are shared between threads */
+#  endif
+
+static XXH_THREAD_LOCAL XXH_stats_t XXH_g_stats;
+
+static unsigned XXH_stats_lengthBucket(size_t len)
+{
+    unsigned b = 0;
+    while ((b < XXH_STATS_NB_LENGTHS-1) && (len > ((size_t)8 << b))) b++;
+    return b;
+}
+
+XXH_PUBLIC_API void XXH_getStats(XXH_stats_t* stats) { XXH_memcpy(stats, &XXH_g_stats, sizeof(*stats)); }
+XXH_PUBLIC_API void XXH_resetStats(void) { memset(&XXH_g_stats, 0, sizeof(XXH_g_stats)); }
+
+#  define XXH_STATS_CALL(kernel, len) do {                                        \
+        XXH_algoStats_t* const XXH_s = XXH_g_stats.algo + (kernel);               \
+        XXH_s->calls++;                                                           \
+        XXH_s->bytes += (len);                                                    \
+        XXH_s->lengths[XXH_stats_lengthBucket(len)]++;                            \
+    } while (0)
+#  define XXH_STATS_UPDATE(kernel, len) do {                                      \
+        XXH_g_stats.algo[kernel].updates++;                                       \
+        XXH_g_stats.algo[kernel].bytes += (len);                                  \
+    } while (0)
+#  define XXH_STATS_PATH(kernel, path) do { XXH_g_stats.algo[kernel].paths[path]++; } while (0)
+#  define XXH_STATS_STAGED(kernel)     do { XXH_g_stats.algo[kernel].staged++; } while (0)
+#  define XXH_STATS_FLUSH(kernel)      do { XXH_g_stats.algo[kernel].flushes++; } while (0)
+#  ifdef XXH_NEON
+#    define XXH_path_vector XXH_path_neon
+#  else
+#    define XXH_path_vector XXH_path_simd
+#  endif
+#else
+#  define XXH_STATS_CALL(kernel, len)   do {} while (0)
+#  define XXH_STATS_UPDATE(kernel, len) do {} while (0)
+#  define XXH_STATS_PATH(kernel, path)  do {} while (0)
+#  define XXH_STATS_STAGED(kernel)      do {} while (0)
+#  define XXH_STATS_FLUSH(kernel)       do {} while (0)
+#endif
+
+
+/* *************************************
+*  Static tracepoints (XXH_USDT)
+***************************************/
+/* Probes of provider `xxhash`, for bpftrace, perf or SystemTap :
+ *   hash(kernel, length)    : one-shot call, including through _auto variants
+ *   update(kernel, length)  : streaming update
+ *   digest(kernel, total)   : streaming digest, `total` is the hashed length (32 lower bits for XXH32*)
+ * `kernel` is a XXH_kernel_e. Only <sys/sdt.h> is needed, at build time :
+ * a probe is a single nop until a tracer attaches to it. */
+#if defined(XXH_USDT) && (XXH_USDT>=1)
+#  include <sys/sdt.h>
+#  define XXH_PROBE2(name, a, b) DTRACE_PROBE2(xxhash, name, a, b)
+#else
+#  define XXH_PROBE2(name, a, b) do {} while (0)
+#endif
+
 /* *******************************************************************
 *  32-bit hash functions
 *********************************************************************/
@@ -682,6 +754,7 @@ XXH32_endian_align(const void* input, size_t len, U32 seed,
 
         const BYTE* const limit = bEnd - 15;
 
+        XXH_STATS_PATH(XXH_kernel_xxh32, XXH_path_neon);
         v += vdupq_n_u32(seed);
         UNROLL do {
             const U32x4 inp = XXH_vec_load_unaligned((const U32 *)p);
@@ -708,8 +781,12 @@ XXH32_endian_align(const void* input, size_t len, U32 seed,
         U32 v4 = seed - PRIME32_1;
         const BYTE* limit = bEnd - 15;
 
+#ifdef XXH_NEON
+        XXH_STATS_PATH(XXH_kernel_xxh32, XXH_path_fallback);
+#endif
         /* Avoid branching when we don't have to. This helps out ARM Thumb a lot. */
         if (XXH_FORCE_ALIGN_CHECK && align==XXH_aligned && endian==XXH_littleEndian) {
+            XXH_STATS_PATH(XXH_kernel_xxh32, XXH_path_aligned);
             UNROLL do {
                const U32* palign = (const U32*)XXH_assume_aligned(p, 4);
                v1 = XXH32_round(v1, palign[0]); p+=4;
@@ -718,6 +795,7 @@ XXH32_endian_align(const void* input, size_t len, U32 seed,
                v4 = XXH32_round(v4, palign[3]); p+=4;
             } while (p < limit);
         } else if (XXH_CPU_USE_SHLD) {
+            XXH_STATS_PATH(XXH_kernel_xxh32, XXH_path_shld);
             UNROLL do {
                 v1 = XXH32_round_shld(v1, XXH_get32bits(p)); p+=4;
                 v2 = XXH32_round_shld(v2, XXH_get32bits(p)); p+=4;
@@ -725,6 +803,7 @@ XXH32_endian_align(const void* input, size_t len, U32 seed,
                 v4 = XXH32_round_shld(v4, XXH_get32bits(p)); p+=4;
             } while (p < limit);
         } else {
+            XXH_STATS_PATH(XXH_kernel_xxh32, XXH_path_unaligned);
             UNROLL do {
                 v1 = XXH32_round(v1, XXH_get32bits(p)); p+=4;
                 v2 = XXH32_round(v2, XXH_get32bits(p)); p+=4;
@@ -753,6 +832,8 @@ XXH_PUBLIC_API unsigned int XXH32 (const void* input, size_t len, unsigned int s
     return XXH32_digest(&state);
 #else
     XXH_endianess endian_detected = (XXH_endianess)XXH_CPU_LITTLE_ENDIAN;
+    XXH_STATS_CALL(XXH_kernel_xxh32, len);
+    XXH_PROBE2(hash, XXH_kernel_xxh32, len);
 
     if ((XXH_FORCE_ALIGN_CHECK)
          && (((size_t)input) & 3) == 0) {   /* Input is 4-bytes aligned, leverage the speed benefit */
@@ -814,16 +895,20 @@ XXH32_update_endian(XXH32_state_t* state, const void* input, size_t len, XXH_end
     {   const BYTE* p = (const BYTE*)input;
         const BYTE* const bEnd = p + len;
 
+        XXH_STATS_UPDATE(XXH_kernel_xxh32, len);
+        XXH_PROBE2(update, XXH_kernel_xxh32, len);
         state->total_len_32 += (unsigned)len;
         state->large_len |= (len>=16) | (state->total_len_32>=16);
 
         if (state->memsize + len < 16)  {   /* fill in tmp buffer */
+            XXH_STATS_STAGED(XXH_kernel_xxh32);
             XXH_memcpy((BYTE*)(state->mem32) + state->memsize, input, len);
             state->memsize += (unsigned)len;
             return XXH_OK;
         }
 
         if (state->memsize) {   /* some data left from previous update */
+            XXH_STATS_FLUSH(XXH_kernel_xxh32);
             XXH_memcpy((BYTE*)(state->mem32) + state->memsize, input, 16-state->memsize);
             {   const U32* p32 = state->mem32;
                 state->v1 = XXH32_round(state->v1, XXH_readLE32(p32, endian)); p32++;
@@ -846,6 +931,7 @@ XXH32_update_endian(XXH32_state_t* state, const void* input, size_t len, XXH_end
             /* Aligned pointers and fewer branches are very helpful and worth the
              * duplication on ARM. */
             if (XXH_FORCE_ALIGN_CHECK && ((size_t)p&3)==0 && endian==XXH_littleEndian) {
+                XXH_STATS_PATH(XXH_kernel_xxh32, XXH_path_aligned);
                 UNROLL do {
                     const U32* p_align = (const U32*)XXH_assume_aligned(p, 4);
                     /* NO SSE */
@@ -856,6 +942,7 @@ XXH32_update_endian(XXH32_state_t* state, const void* input, size_t len, XXH_end
                     p += 16;
                 } while (p <= limit);
             } else {
+                XXH_STATS_PATH(XXH_kernel_xxh32, XXH_path_unaligned);
                 UNROLL do {
                     /* NO SSE */
                     v1 = XXH32_round(v1, XXH_readLE32(p, endian));
@@ -915,6 +1002,7 @@ XXH32_digest_endian (const XXH32_state_t* state, XXH_endianess endian)
 XXH_PUBLIC_API unsigned int XXH32_digest (const XXH32_state_t* state_in)
 {
     XXH_endianess endian_detected = (XXH_endianess)XXH_CPU_LITTLE_ENDIAN;
+    XXH_PROBE2(digest, XXH_kernel_xxh32, state_in->total_len_32);
 
     if ((endian_detected==XXH_littleEndian) || XXH_FORCE_NATIVE_FORMAT)
         return XXH32_digest_endian(state_in, XXH_littleEndian);
@@ -1229,6 +1317,7 @@ XXH64_endian_align(const void* input, size_t len, U64 seed,
     if (len >= 32 && endian == XXH_littleEndian) {
         const BYTE* const limit = bEnd - 32;
 
+        XXH_STATS_PATH(XXH_kernel_xxh64, XXH_path_vector);
 #ifdef XXH_NEON
         p = XXH64_NEON32(p, limit, seed, &h64);
 #else
@@ -1244,7 +1333,13 @@ XXH64_endian_align(const void* input, size_t len, U64 seed,
         U64 v2 = seed + PRIME64_2;
         U64 v3 = seed + 0;
         U64 v4 = seed - PRIME64_1;
+#if defined(XXHASH_VEC_H) && ((defined(__SSE2__) && (defined(__i386__) || defined(_M_IX86))) \
+ || (defined(XXH_NEON) && !defined(__aarch64__) && !defined(__arm64__)) \
+ || defined(XXH_VECTORIZE_XXH64))
+        XXH_STATS_PATH(XXH_kernel_xxh64, XXH_path_fallback);
+#endif
         if (XXH_FORCE_ALIGN_CHECK && endian==XXH_littleEndian && (((size_t)p & 7) == 0)) {
+            XXH_STATS_PATH(XXH_kernel_xxh64, XXH_path_aligned);
             UNROLL do {
                 const U64* inp = (const U64*)XXH_assume_aligned(p, 8);
                 v1 = XXH64_round(v1, inp[0]);
@@ -1254,6 +1349,7 @@ XXH64_endian_align(const void* input, size_t len, U64 seed,
                 p += 32;
             } while (p<=limit);
         } else if (sizeof(void*) >= sizeof(U64) && XXH_CPU_USE_SHLD) {
+            XXH_STATS_PATH(XXH_kernel_xxh64, XXH_path_shld);
             UNROLL do {
                 v1 = XXH64_round_shld(v1, XXH_get64bits(p));
                 v2 = XXH64_round_shld(v2, XXH_get64bits(p + 8));
@@ -1262,6 +1358,7 @@ XXH64_endian_align(const void* input, size_t len, U64 seed,
                 p += 32;
             } while (p<=limit);
         } else {
+            XXH_STATS_PATH(XXH_kernel_xxh64, XXH_path_unaligned);
             UNROLL do {
                 v1 = XXH64_round(v1, XXH_get64bits(p));
                 v2 = XXH64_round(v2, XXH_get64bits(p + 8));
@@ -1296,6 +1393,8 @@ XXH_PUBLIC_API unsigned long long XXH64 (const void* input, size_t len, unsigned
     return XXH64_digest(&state);
 #else
     XXH_endianess endian_detected = (XXH_endianess)XXH_CPU_LITTLE_ENDIAN;
+    XXH_STATS_CALL(XXH_kernel_xxh64, len);
+    XXH_PROBE2(hash, XXH_kernel_xxh64, len);
 
     if (XXH_FORCE_ALIGN_CHECK) {
         if ((((size_t)input) & 7)==0) {  /* Input is aligned, let's leverage the speed advantage */
@@ -1355,15 +1454,19 @@ XXH64_update_endian (XXH64_state_t* state, const void* input, size_t len, XXH_en
     {   const BYTE* p = (const BYTE*)input;
         const BYTE* const bEnd = p + len;
 
+        XXH_STATS_UPDATE(XXH_kernel_xxh64, len);
+        XXH_PROBE2(update, XXH_kernel_xxh64, len);
         state->total_len += len;
 
         if (state->memsize + len < 32) {  /* fill in tmp buffer */
+            XXH_STATS_STAGED(XXH_kernel_xxh64);
             XXH_memcpy(((BYTE*)state->mem64) + state->memsize, input, len);
             state->memsize += (U32)len;
             return XXH_OK;
         }
 
         if (state->memsize) {   /* tmp buffer is full */
+            XXH_STATS_FLUSH(XXH_kernel_xxh64);
             XXH_memcpy(((BYTE*)state->mem64) + state->memsize, input, 32-state->memsize);
             state->v1 = XXH64_round(state->v1, XXH_readLE64(state->mem64+0, endian));
             state->v2 = XXH64_round(state->v2, XXH_readLE64(state->mem64+1, endian));
@@ -1387,6 +1490,7 @@ XXH64_update_endian (XXH64_state_t* state, const void* input, size_t len, XXH_en
             vx1[1][0] = state->v3;
             vx1[1][1] = state->v4;
 
+            XXH_STATS_PATH(XXH_kernel_xxh64, XXH_path_vector);
 #ifdef XXH_NEON
             p = XXH64_update_NEON32(p, limit, vx1);
 #else
@@ -1407,7 +1511,13 @@ XXH64_update_endian (XXH64_state_t* state, const void* input, size_t len, XXH_en
             U64 v3 = state->v3;
             U64 v4 = state->v4;
 
+#if defined(XXHASH_VEC_H) && ((defined(__SSE2__) && (defined(__i386__) || defined(_M_IX86))) \
+ || (defined(XXH_NEON) && !defined(__aarch64__) && !defined(__arm64__)) \
+ || defined(XXH_VECTORIZE_XXH64))
+            XXH_STATS_PATH(XXH_kernel_xxh64, XXH_path_fallback);
+#endif
             if (XXH_FORCE_ALIGN_CHECK && endian==XXH_littleEndian && (((size_t)p & 7) == 0)) {
+                XXH_STATS_PATH(XXH_kernel_xxh64, XXH_path_aligned);
                 UNROLL do {
                     const U64* inp = (const U64*)XXH_assume_aligned(p, 8);
                     v1 = XXH64_round(v1, inp[0]);
@@ -1417,6 +1527,7 @@ XXH64_update_endian (XXH64_state_t* state, const void* input, size_t len, XXH_en
                     p += 32;
                 } while (p<=limit);
             } else {
+                XXH_STATS_PATH(XXH_kernel_xxh64, XXH_path_unaligned);
                 UNROLL do {
                     v1 = XXH64_round(v1, XXH_readLE64(p, endian)); p+=8;
                     v2 = XXH64_round(v2, XXH_readLE64(p, endian)); p+=8;
@@ -1476,6 +1587,7 @@ FORCE_INLINE U64 XXH64_digest_endian (const XXH64_state_t* state, XXH_endianess
 XXH_PUBLIC_API unsigned long long XXH64_digest (const XXH64_state_t* state_in)
 {
     XXH_endianess endian_detected = (XXH_endianess)XXH_CPU_LITTLE_ENDIAN;
+    XXH_PROBE2(digest, XXH_kernel_xxh64, state_in->total_len);
 
     if ((endian_detected==XXH_littleEndian) || XXH_FORCE_NATIVE_FORMAT)
         return XXH64_digest_endian(state_in, XXH_littleEndian);
@@ -1566,9 +1678,10 @@ FORCE_INLINE void XXH32a_resetLanes(U32 v[2][4], U32 seed)
  /* Note: Used by both XXH32a and XXH64a. */
 FORCE_INLINE const BYTE* /* p */
 XXH32a_XXH64a_endian_align(U32 state[2][4], const BYTE* p, size_t len,
-                    XXH_endianess endian, XXH_alignment align)
+                    XXH_endianess endian, XXH_alignment align, XXH_kernel_e kernel)
 {
     const BYTE* bEnd = p + len;
+    (void)kernel;   /* only used by XXH_STATS */
 
 
 /* SIMD-optimized code */
@@ -1590,6 +1703,7 @@ XXH32a_XXH64a_endian_align(U32 state[2][4], const BYTE* p, size_t len,
          * shows that performing two parallel hashes at a time is much better for
          * performance. It produces a different hash, though. */
 
+        XXH_STATS_PATH(kernel, XXH_path_vector);
         /* Aligned reads are faster on all targets except NEON. We want a 16-byte align. */
         if (XXH_FORCE_ALIGN_CHECK && ((size_t)p&15) == 0) {
             UNROLL do {
@@ -1636,7 +1750,11 @@ XXH32a_XXH64a_endian_align(U32 state[2][4], const BYTE* p, size_t len,
 
         XXH_memcpy(v, state, sizeof(v));
 
+#if XXH_VECTORIZE
+        XXH_STATS_PATH(kernel, XXH_path_fallback);
+#endif
         if (XXH_FORCE_ALIGN_CHECK && align == XXH_aligned && endian == XXH_littleEndian) {
+            XXH_STATS_PATH(kernel, XXH_path_aligned);
             UNROLL do {
                 const U32* const inp = (const U32*)XXH_assume_aligned(p, 4);
                 /* NO SSE */
@@ -1652,6 +1770,7 @@ XXH32a_XXH64a_endian_align(U32 state[2][4], const BYTE* p, size_t len,
                 p += 32;
             } while (p < limit);
         } else {
+            XXH_STATS_PATH(kernel, XXH_path_unaligned);
             UNROLL do {
                 /* NO SSE */
                 v[0][0] = XXH32_round(v[0][0], XXH_get32bits(p)); p += 4;
@@ -1691,7 +1810,7 @@ XXH32a_endian_align(const void* input, size_t len, U32 seed,
         U32 v[2][4];
         XXH32a_resetLanes(v, seed);
 
-        p = XXH32a_XXH64a_endian_align(v, p, len, endian, align);
+        p = XXH32a_XXH64a_endian_align(v, p, len, endian, align, XXH_kernel_xxh32a);
 
         XXH32a_mergeAllLanes(v);
 
@@ -1739,6 +1858,8 @@ XXH_PUBLIC_API unsigned int XXH32a (const void* input, size_t len, unsigned int
     return XXH32a_digest(&state);
 #else
     XXH_endianess endian_detected = (XXH_endianess)XXH_CPU_LITTLE_ENDIAN;
+    XXH_STATS_CALL(XXH_kernel_xxh32a, len);
+    XXH_PROBE2(hash, XXH_kernel_xxh32a, len);
 
     if (XXH_FORCE_ALIGN_CHECK) {
         if ((((size_t)input) & ((XXH_VECTORIZE) ? 15 : 3))==0) {  /* Input is aligned, let's leverage the speed advantage */
@@ -1786,8 +1907,10 @@ XXH_PUBLIC_API XXH_errorcode XXH32a_reset(XXH32a_state_t* statePtr, unsigned int
 
 /* Again, this code is reused for both XXH32a and XXH64a */
 FORCE_INLINE XXH_errorcode
-XXH32a_XXH64a_update_endian(XXH32a_state_t* state, const void* input, size_t len, XXH_endianess endian)
+XXH32a_XXH64a_update_endian(XXH32a_state_t* state, const void* input, size_t len,
+                            XXH_endianess endian, XXH_kernel_e kernel)
 {
+    (void)kernel;   /* only used by XXH_STATS */
     if (input==NULL)
 #if defined(XXH_ACCEPT_NULL_INPUT_POINTER) && (XXH_ACCEPT_NULL_INPUT_POINTER>=1)
         return XXH_OK;
@@ -1798,16 +1921,20 @@ XXH32a_XXH64a_update_endian(XXH32a_state_t* state, const void* input, size_t len
     {   const BYTE* p = (const BYTE*)input;
         const BYTE* const bEnd = p + len;
 
+        XXH_STATS_UPDATE(kernel, len);
+        XXH_PROBE2(update, kernel, len);
         state->total_len_32 += (unsigned)len;
         state->large_len |= (len>=32) | (state->total_len_32>=32);
 
         if (state->memsize + len < 32)  {   /* fill in tmp buffer */
+            XXH_STATS_STAGED(kernel);
             XXH_memcpy((BYTE*)(state->mem32) + state->memsize, input, len);
             state->memsize += (unsigned)len;
             return XXH_OK;
         }
 
         if (state->memsize) {   /* some data left from previous update */
+            XXH_STATS_FLUSH(kernel);
             XXH_memcpy((BYTE*)(state->mem32) + state->memsize, input, 32-state->memsize);
             /* Only one round, not worth it to vectorize. */
             {   const U32* p32 = state->mem32;
@@ -1848,6 +1975,7 @@ XXH32a_XXH64a_update_endian(XXH32a_state_t* state, const void* input, size_t len
 
             /* If we have a 16-byte aligned pointer, we can reinterpret the pointer and
              * use a direct dereference. */
+           XXH_STATS_PATH(kernel, XXH_path_vector);
            if (XXH_FORCE_ALIGN_CHECK && ((size_t)p&15) == 0) {
                 UNROLL do {
                     const U32x4* inp = (const U32x4*)XXH_assume_aligned(p, 16);
@@ -1891,7 +2019,11 @@ XXH32a_XXH64a_update_endian(XXH32a_state_t* state, const void* input, size_t len
 
             XXH_memcpy(v, state->v, sizeof(v));
 
+#if XXH_VECTORIZE
+            XXH_STATS_PATH(kernel, XXH_path_fallback);
+#endif
             if (XXH_FORCE_ALIGN_CHECK && ((size_t)p&3)==0 && endian==XXH_littleEndian) {
+                XXH_STATS_PATH(kernel, XXH_path_aligned);
                 UNROLL do {
                     const U32* const inp = (const U32*)XXH_assume_aligned(p, 4);
 
@@ -1907,6 +2039,7 @@ XXH32a_XXH64a_update_endian(XXH32a_state_t* state, const void* input, size_t len
                     p += 32;
                 } while (p <= limit);
             } else {
+                XXH_STATS_PATH(kernel, XXH_path_unaligned);
                 UNROLL do {
                     v[0][0] = XXH32_round(v[0][0], XXH_readLE32(p, endian)); p+=4;
                     v[0][1] = XXH32_round(v[0][1], XXH_readLE32(p, endian)); p+=4;
@@ -1938,9 +2071,9 @@ XXH_PUBLIC_API XXH_errorcode XXH32a_update (XXH32a_state_t* state_in, const void
     XXH_endianess endian_detected = (XXH_endianess)XXH_CPU_LITTLE_ENDIAN;
 
     if ((endian_detected==XXH_littleEndian) || XXH_FORCE_NATIVE_FORMAT)
-        return XXH32a_XXH64a_update_endian(state_in, input, len, XXH_littleEndian);
+        return XXH32a_XXH64a_update_endian(state_in, input, len, XXH_littleEndian, XXH_kernel_xxh32a);
     else
-        return XXH32a_XXH64a_update_endian(state_in, input, len, XXH_bigEndian);
+        return XXH32a_XXH64a_update_endian(state_in, input, len, XXH_bigEndian, XXH_kernel_xxh32a);
 }
 
 
@@ -1970,6 +2103,7 @@ XXH32a_digest_endian (const XXH32a_state_t* state, XXH_endianess endian)
 XXH_PUBLIC_API unsigned int XXH32a_digest (const XXH32a_state_t* state_in)
 {
     XXH_endianess endian_detected = (XXH_endianess)XXH_CPU_LITTLE_ENDIAN;
+    XXH_PROBE2(digest, XXH_kernel_xxh32a, state_in->total_len_32);
 
     if ((endian_detected==XXH_littleEndian) || XXH_FORCE_NATIVE_FORMAT)
         return XXH32a_digest_endian(state_in, XXH_littleEndian);
@@ -2030,7 +2164,7 @@ XXH64a_endian_align(const void* input, size_t len, U64 seed,
 
         XXH64a_reset_lanes(v, seed);
 
-        p = XXH32a_XXH64a_endian_align(v, p, len, endian, align);
+        p = XXH32a_XXH64a_endian_align(v, p, len, endian, align, XXH_kernel_xxh64a);
 
         /* Join the 8 32-bit lanes into 4 64-bit lanes.
          * Gotta love the ugly C casting rules. */
@@ -2098,6 +2232,8 @@ XXH_PUBLIC_API unsigned long long XXH64a (const void* input, size_t len, unsigne
     return XXH64a_digest(&state);
 #else
     XXH_endianess endian_detected = (XXH_endianess)XXH_CPU_LITTLE_ENDIAN;
+    XXH_STATS_CALL(XXH_kernel_xxh64a, len);
+    XXH_PROBE2(hash, XXH_kernel_xxh64a, len);
 
     if (XXH_FORCE_ALIGN_CHECK) {
         if ((((size_t)input) & ((XXH_VECTORIZE) ? 15 : 3))==0) {  /* Input is aligned, let's leverage the speed advantage */
@@ -2146,7 +2282,12 @@ XXH_PUBLIC_API XXH_errorcode XXH64a_reset(XXH64a_state_t* statePtr, unsigned lon
 
 XXH_PUBLIC_API XXH_errorcode XXH64a_update (XXH64a_state_t* state_in, const void* input, size_t len)
 {
-    return XXH32a_update((XXH32a_state_t*)state_in, input, len);
+    XXH_endianess endian_detected = (XXH_endianess)XXH_CPU_LITTLE_ENDIAN;
+
+    if ((endian_detected==XXH_littleEndian) || XXH_FORCE_NATIVE_FORMAT)
+        return XXH32a_XXH64a_update_endian((XXH32a_state_t*)state_in, input, len, XXH_littleEndian, XXH_kernel_xxh64a);
+    else
+        return XXH32a_XXH64a_update_endian((XXH32a_state_t*)state_in, input, len, XXH_bigEndian, XXH_kernel_xxh64a);
 }
 
 FORCE_INLINE U64 XXH64a_digest_endian (const XXH64a_state_t* state, XXH_endianess endian)
@@ -2182,6 +2323,7 @@ FORCE_INLINE U64 XXH64a_digest_endian (const XXH64a_state_t* state, XXH_endianes
 XXH_PUBLIC_API unsigned long long XXH64a_digest (const XXH64a_state_t* state_in)
 {
     XXH_endianess endian_detected = (XXH_endianess)XXH_CPU_LITTLE_ENDIAN;
+    XXH_PROBE2(digest, XXH_kernel_xxh64a, state_in->total_len_32);
 
     if ((endian_detected==XXH_littleEndian) || XXH_FORCE_NATIVE_FORMAT)
         return XXH64a_digest_endian(state_in, XXH_littleEndian);
@@ -2199,43 +2341,62 @@ XXH_PUBLIC_API unsigned long long XXH64a_digest (const XXH64a_state_t* state_in)
  *   Newer Intel x86_64 processors: XXH64
  *   NEON or SSE4.1: XXH32a
  *   Everything else: XXH32 */
+FORCE_INLINE XXH_kernel_e XXH32_auto_select(size_t len)
+{
+    /* With slower inputs, it is usually better to use XXH32. XXH64 and XXH32a/XXH64a
+     * have slower setup times, and SSE/NEON registers are slower to move back and forth
+     * between normal registers. */
+    if (len <= 128)
+        return XXH_kernel_xxh32;
+#if (defined(__x86_64__) || defined(_M_IX86)) && !defined(XXH_NO_LONG_LONG)
+    /* Most x86_64 processors compute XXH64 the fastest.
+     * Pre-Nehalem processors do not, as they have a significantly slower
+     * 64-bit multiply. */
+    if (!XXH_CPU_IS_PRE_NEHALEM)
+        return XXH_kernel_xxh64;
+#endif
+#if !defined(XXH_NO_ALT_HASHES) && XXH_VECTORIZE && (defined(__SSE4_1__) || defined(XXH_NEON))
+    return XXH_kernel_xxh32a;
+#else
+    return XXH_kernel_xxh32;
+#endif
+}
+
+XXH_PUBLIC_API XXH_kernel_e XXH32_autoKernel(size_t length)
+{
+    return XXH32_auto_select(length);
+}
+
 XXH_PUBLIC_API unsigned XXH32_auto (const void* input, size_t len, unsigned seed)
 {
     XXH_alignment align = (XXH_FORCE_ALIGN_CHECK && ((size_t)input&3)==0) ? XXH_aligned
                                                                           : XXH_unaligned;
     XXH_alignment align16 = (XXH_FORCE_ALIGN_CHECK && ((size_t)input&15)==0) ? XXH_aligned
                                                                              : XXH_unaligned;
+    XXH_kernel_e const kernel = XXH32_auto_select(len);
     /* I am not conditionalizing these declarations. This code is ugly enough. */
-    (void)align; (void)align16;
+    (void)align; (void)align16; (void)kernel;
+    XXH_STATS_CALL(kernel, len);
+    XXH_PROBE2(hash, kernel, len);
 
-    /* With slower inputs, it is usually better to use XXH32. XXH64 and XXH32a/XXH64a
-     * have slower setup times, and SSE/NEON registers are slower to move back and forth
-     * between normal registers. */
-
-    if (len <= 128) {
-        return XXH32_endian_align(input, len, seed, XXH_littleEndian, align);
-    } else
 #if (defined(__x86_64__) || defined(_M_IX86)) && !defined(XXH_NO_LONG_LONG)
-        if (!XXH_CPU_IS_PRE_NEHALEM) {
-            /* Most x86_64 processors compute XXH64 the fastest.
-             * Pre-Nehalem processors do not, as they have a significantly slower
-             * 64-bit multiply. */
-            union U32_U64 {
-                U32 u32[2];
-                U64 u64;
-            };
-            union U32_U64 pun;
-            XXH32a_splitSeed(seed, pun.u32);
+    if (kernel == XXH_kernel_xxh64) {
+        union U32_U64 {
+            U32 u32[2];
+            U64 u64;
+        };
+        union U32_U64 pun;
+        XXH32a_splitSeed(seed, pun.u32);
 
-            pun.u64 = XXH64_endian_align(input, len, pun.u64, XXH_littleEndian, align);
-            return XXH32a_mergeLane(pun.u32[0], pun.u32[1]);
-        } else
+        pun.u64 = XXH64_endian_align(input, len, pun.u64, XXH_littleEndian, align);
+        return XXH32a_mergeLane(pun.u32[0], pun.u32[1]);
+    }
 #endif
 #if !defined(XXH_NO_ALT_HASHES) && XXH_VECTORIZE && (defined(__SSE4_1__) || defined(XXH_NEON))
+    if (kernel == XXH_kernel_xxh32a)
         return XXH32a_endian_align(input, len, seed, XXH_littleEndian, align16);
-#else
-        return XXH32_endian_align(input, len, seed, XXH_littleEndian, align);
 #endif
+    return XXH32_endian_align(input, len, seed, XXH_littleEndian, align);
 }
 
 #ifndef XXH_NO_LONG_LONG
@@ -2244,6 +2405,32 @@ XXH_PUBLIC_API unsigned XXH32_auto (const void* input, size_t len, unsigned seed
  *   32-bit or older Intel processors: XXH64a
  *   aarch64: XXH64 on len <= 128, XXH64a on longer inputs
  *   Other processors: XXH64 */
+FORCE_INLINE XXH_kernel_e XXH64_auto_select(size_t len)
+{
+    (void)len;
+#ifdef XXH_NO_ALT_HASHES
+    /*  We don't really have a choice. */
+    return XXH_kernel_xxh64;
+#else
+    /* 99% of the time, XXH64a is faster than XXH64 on a 32-bit system.
+     * This also applies to pre-Nehalem Intel CPUs because of the slower multiply. */
+    if (sizeof(unsigned long long) > sizeof(void*) /* 32-bit */ || XXH_CPU_IS_PRE_NEHALEM)
+        return XXH_kernel_xxh64a;
+#ifdef XXH_NEON
+    /* aarch64 is much faster with XXH64a */
+    if (len > 128)
+        return XXH_kernel_xxh64a;
+#endif
+    /* XXH64 is good enough */
+    return XXH_kernel_xxh64;
+#endif
+}
+
+XXH_PUBLIC_API XXH_kernel_e XXH64_autoKernel(size_t length)
+{
+    return XXH64_auto_select(length);
+}
+
 XXH_PUBLIC_API unsigned long long XXH64_auto (const void* input, size_t len, unsigned long long seed)
 {
     XXH_alignment align = (XXH_FORCE_ALIGN_CHECK && ((size_t)input&7)==0) ? XXH_aligned
@@ -2252,28 +2439,14 @@ XXH_PUBLIC_API unsigned long long XXH64_auto (const void* input, size_t len, uns
                                                                              : XXH_unaligned;
     /* I am not conditionalizing these declarations, thank you very much. */
     (void)align; (void)align16;
+    XXH_STATS_CALL(XXH64_auto_select(len), len);
+    XXH_PROBE2(hash, XXH64_auto_select(len), len);
 
-#ifdef XXH_NO_ALT_HASHES
-    /*  We don't really have a choice. */
-    return XXH64_endian_align(input, len, seed, XXH_littleEndian, align);
-#else
-    /* 99% of the time, XXH64a is faster than XXH64 on a 32-bit system.
-     * This also applies to pre-Nehalem Intel CPUs because of the slower multiply. */
-    if (sizeof(unsigned long long) > sizeof(void*) /* 32-bit */ || XXH_CPU_IS_PRE_NEHALEM) {
+#ifndef XXH_NO_ALT_HASHES
+    if (XXH64_auto_select(len) == XXH_kernel_xxh64a)
         return XXH64a_endian_align(input, len, seed, XXH_littleEndian, align16);
-    } else {
-#ifdef XXH_NEON
-        /* aarch64 is much faster with XXH64a */
-        if (len <= 128)
-            return XXH64_endian_align(input, len, seed, XXH_littleEndian, align);
-        else
-            return XXH64a_endian_align(input, len, seed, XXH_littleEndian, align16);
-#else
-        /* XXH64 is good enough */
-        return XXH64_endian_align(input, len, seed, XXH_littleEndian, align);
-#endif
-    }
 #endif
+    return XXH64_endian_align(input, len, seed, XXH_littleEndian, align);
 }
 /* Automatically chooses a XXH32_auto or XXH64_auto, depending on the word size. */
 XXH_PUBLIC_API size_t XXH_auto (const void* input, size_t len, size_t seed)
@@ -160,6 +160,10 @@ typedef enum { XXH_OK=0, XXH_ERROR } XXH_errorcode;
 #  define XXH_auto XXH_NAME2(XXH_NAMESPACE, XXH_auto)
 #  define XXH32_auto XXH_NAME2(XXH_NAMESPACE, XXH32_auto)
 #  define XXH64_auto XXH_NAME2(XXH_NAMESPACE, XXH64_auto)
+#  define XXH32_autoKernel XXH_NAME2(XXH_NAMESPACE, XXH32_autoKernel)
+#  define XXH64_autoKernel XXH_NAME2(XXH_NAMESPACE, XXH64_autoKernel)
+#  define XXH_getStats XXH_NAME2(XXH_NAMESPACE, XXH_getStats)
+#  define XXH_resetStats XXH_NAME2(XXH_NAMESPACE, XXH_resetStats)
 #endif
 
 
@@ -495,6 +499,56 @@ struct XXH64_state_s {
 
 # endif
 
+/*! XXH32_autoKernel(), XXH64_autoKernel() :
+    Report which hash XXH32_auto() and XXH64_auto() select for an input of `length` bytes
+    on the current CPU. XXH_auto() uses XXH32_auto() on 32-bit targets, and XXH64_auto() otherwise.
+    When XXH32_auto() selects a 64-bit hash, the result is folded to 32 bits.
+    This is only meant to audit the selection logic, e.g. from a benchmark. */
+typedef enum { XXH_kernel_xxh32, XXH_kernel_xxh64, XXH_kernel_xxh32a, XXH_kernel_xxh64a } XXH_kernel_e;
+XXH_PUBLIC_API XXH_kernel_e XXH32_autoKernel(size_t length);
+#ifndef XXH_NO_LONG_LONG
+XXH_PUBLIC_API XXH_kernel_e XXH64_autoKernel(size_t length);
+#endif
+
+#ifdef XXH_STATS
+/*! XXH_getStats(), XXH_resetStats() :
+    Only available when the library is compiled with XXH_STATS defined.
+    Counters are thread-local : they only describe calls made by the calling thread.
+    Each run of a main loop (one-shot or streaming) counts one of aligned, unaligned, shld, simd or neon.
+    `fallback` is counted on top of it, when a vector loop is compiled in
+    but could not be used, because of input alignment or endianness.
+    XXH64a_update() counts as XXH64a, although it shares the state of XXH32a. */
+#  ifdef XXH_NO_LONG_LONG
+typedef unsigned long XXH_statsCounter_t;
+#  else
+typedef unsigned long long XXH_statsCounter_t;
+#  endif
+typedef enum {
+    XXH_path_aligned,     /* scalar main loop, aligned reads */
+    XXH_path_unaligned,   /* scalar main loop, unaligned reads */
+    XXH_path_shld,        /* scalar main loop, with shld rotations (x86) */
+    XXH_path_simd,        /* SSE main loop */
+    XXH_path_neon,        /* NEON main loop */
+    XXH_path_fallback,    /* scalar main loop, while a vector one is compiled in */
+    XXH_path_count
+} XXH_path_e;
+#  define XXH_STATS_NB_LENGTHS 8   /* lengths up to 8, 16, 32, 64, 128, 256, 512 bytes, and longer */
+typedef struct {
+    XXH_statsCounter_t calls;      /* one-shot calls, including through _auto variants */
+    XXH_statsCounter_t bytes;      /* one-shot and streaming */
+    XXH_statsCounter_t paths[XXH_path_count];
+    XXH_statsCounter_t lengths[XXH_STATS_NB_LENGTHS];   /* one-shot calls, per input length */
+    XXH_statsCounter_t updates;    /* streaming update calls */
+    XXH_statsCounter_t staged;     /* updates entirely absorbed by the staging buffer */
+    XXH_statsCounter_t flushes;    /* updates completing a block left in the staging buffer */
+} XXH_algoStats_t;
+typedef struct {
+    XXH_algoStats_t algo[4];       /* indexed by XXH_kernel_e */
+} XXH_stats_t;
+XXH_PUBLIC_API void XXH_getStats(XXH_stats_t* stats);
+XXH_PUBLIC_API void XXH_resetStats(void);
+#endif
+
 
 #if defined(XXH_INLINE_ALL) || defined(XXH_PRIVATE_API)
 #  include "xxhash.c"   /* include xxhash function bodies as `static`, for inlining */
@@ -39,6 +39,11 @@
 #  define _CRT_SECURE_NO_WARNINGS   /* removes visual warnings */
 #endif
 
+/* Under Linux, pull in CPU affinity functions (multi-threaded benchmark) */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#  define _GNU_SOURCE
+#endif
+
 /* Under Linux at least, pull in the *64 commands */
 #ifndef _LARGEFILE64_SOURCE
 #  define _LARGEFILE64_SOURCE
@@ -53,11 +58,16 @@
 #include <string.h>     /* strcmp */
 #include <sys/types.h>  /* stat, stat64, _stat64 */
 #include <sys/stat.h>   /* stat, stat64, _stat64 */
-#include <time.h>       /* clock_t, clock, CLOCKS_PER_SEC */
+#include <time.h>       /* clock_t, clock, CLOCKS_PER_SEC, clock_gettime */
 #include <assert.h>     /* assert */
 
 #define XXH_STATIC_LINKING_ONLY   /* *_state_t */
 #include "xxhash.h"
+#include "xxh_bloom.h"
+#include "xxh_map.h"
+#include "xxh_hll.h"
+#include "xxh_cms.h"
+#include "xxh_minhash.h"
 
 #if defined(XXH_NO_LONG_LONG) || defined(XXH_NO_ALT_HASHES)
 #  error xxhsum requires all hashes to be enabled!
@@ -133,6 +143,70 @@ static __inline int IS_CONSOLE(FILE* stdStream) {
 
 #include <errno.h>
 
+/* Multi-threaded benchmark requires POSIX threads */
+#if (PLATFORM_POSIX_VERSION >= 200112L) && !defined(XXHSUM_NO_THREADS)
+#  include <pthread.h>  /* pthread_create, pthread_join, pthread_mutex_*, pthread_cond_* */
+#  define BMK_HAS_THREADS 1
+#else
+#  define BMK_HAS_THREADS 0
+#endif
+
+/* CPU pinning (-T, --samples) */
+#if defined(__linux__)
+#  include <sched.h>  /* sched_getaffinity, sched_setaffinity, sched_getcpu, CPU_SET */
+#endif
+#if defined(__linux__) && defined(CPU_SET)
+#  define BMK_HAS_AFFINITY 1
+#else
+#  define BMK_HAS_AFFINITY 0
+#endif
+
+/* File benchmark (--io) : memory mapped and direct I/O */
+#if (PLATFORM_POSIX_VERSION >= 200112L)
+#  include <fcntl.h>     /* open, O_RDONLY, O_DIRECT */
+#  include <sys/mman.h>  /* mmap, munmap */
+#  define BMK_HAS_MMAP 1
+#  if defined(MAP_ANONYMOUS)
+#    define BMK_MAP_ANONYMOUS MAP_ANONYMOUS
+#  elif defined(MAP_ANON)
+#    define BMK_MAP_ANONYMOUS MAP_ANON
+#  endif
+#  ifdef MAP_POPULATE
+#    define BMK_MAP_POPULATE MAP_POPULATE   /* read whole file at map time */
+#  else
+#    define BMK_MAP_POPULATE 0
+#  endif
+#else
+#  define BMK_HAS_MMAP 0
+#endif
+
+/* Hardware counters (--counters) require Linux perf events */
+#if defined(__linux__) && !defined(XXHSUM_NO_COUNTERS)
+#  include <linux/perf_event.h>  /* perf_event_attr, PERF_* */
+#  include <sys/syscall.h>       /* syscall, __NR_perf_event_open */
+#  include <sys/ioctl.h>         /* ioctl */
+#  define BMK_HAS_COUNTERS 1
+#else
+#  define BMK_HAS_COUNTERS 0
+#endif
+
+/* Static tracepoints (XXH_USDT), provider `xxhsum` :
+ *   file_open(name), file_close(name)      : hashed or checked file
+ *   read_start(), read_done(bytes)         : each read of a file
+ *   digest(algo, hash)                     : end of a file, `algo` is an algoType
+ *   check_verdict(name, status)            : -c mode, 0=ok, 1=mismatch, 2=failed to open
+ * Only <sys/sdt.h> is needed, at build time; a probe is a single nop until traced. */
+#if defined(XXH_USDT) && (XXH_USDT>=1)
+#  include <sys/sdt.h>
+#  define BMK_PROBE0(name)       DTRACE_PROBE(xxhsum, name)
+#  define BMK_PROBE1(name, a)    DTRACE_PROBE1(xxhsum, name, a)
+#  define BMK_PROBE2(name, a, b) DTRACE_PROBE2(xxhsum, name, a, b)
+#else
+#  define BMK_PROBE0(name)       do {} while (0)
+#  define BMK_PROBE1(name, a)    do {} while (0)
+#  define BMK_PROBE2(name, a, b) do {} while (0)
+#endif
+
 /* ************************************
 *  Basic Types
 **************************************/
@@ -183,10 +257,12 @@ static const char author[] = "Yann Collet";
 #define MB *( 1<<20)
 #define GB *(1U<<30)
 
+#define MIN(a,b) ((a) < (b) ? (a) : (b))
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+
 static size_t XXH_DEFAULT_SAMPLE_SIZE = 100 KB;
 #define NBLOOPS    3                              /* Default number of benchmark iterations */
-#define TIMELOOP_S 1
-#define TIMELOOP  (TIMELOOP_S * CLOCKS_PER_SEC)   /* Minimum timing per iteration */
+#define TIMELOOP_NS 1000000000ULL                 /* Target duration of each iteration */
 #define XXHSUM32_DEFAULT_SEED 0                   /* Default seed for algo_xxh32 */
 #define XXHSUM64_DEFAULT_SEED 0                   /* Default seed for algo_xxh64 */
 
@@ -218,16 +294,143 @@ static int g_displayLevel = 2;
  **************************************/
 static U32 g_nbIterations = NBLOOPS;
 
+/* Benchmark results can also be produced in a machine-readable format */
+typedef enum { BMK_format_human, BMK_format_csv, BMK_format_json } BMK_format_e;
+static BMK_format_e g_outputFormat = BMK_format_human;
+
+/* Latency mode : each hash call is seeded with the previous result,
+ * so that calls can't overlap in the out-of-order core,
+ * as for a lookup on the critical path of a hash table */
+static U32 g_benchLatency = 0;
+
+/* Benchmarked files are memory mapped, with these options */
+static U32 g_mapPopulate = 0;    /* --populate : read whole file at map time */
+static U32 g_mapHugePages = 0;   /* --hugepages : request transparent huge pages */
+
+/* Robust mode (--samples) : results are distributions of g_nbSamples samples,
+ * instead of the fastest of g_nbIterations rounds */
+static U32 g_nbSamples = 0;
+
 
 /* ************************************
- *  Benchmark Functions
+ *  Timer Functions
  **************************************/
-static clock_t BMK_clockSpan( clock_t start )
+/* BMK_time_t :
+ * Timestamp from the most precise monotonic clock available.
+ * clock() measures process time with a coarse resolution (often 1-10 ms),
+ * which makes small-key results too noisy to be useful. */
+#if defined(_WIN32)
+#  include <windows.h>   /* LARGE_INTEGER, QueryPerformanceCounter */
+   typedef LARGE_INTEGER BMK_time_t;
+   static BMK_time_t BMK_getTime(void) { BMK_time_t t; QueryPerformanceCounter(&t); return t; }
+   static U64 BMK_getSpanTimeNano(BMK_time_t start, BMK_time_t end)
+   {
+       static LARGE_INTEGER ticksPerSecond = { 0 };
+       if (!ticksPerSecond.QuadPart) QueryPerformanceFrequency(&ticksPerSecond);
+       return (U64)(((double)(end.QuadPart - start.QuadPart) * 1000000000.) / (double)ticksPerSecond.QuadPart);
+   }
+#elif defined(__APPLE__) && defined(__MACH__)
+#  include <mach/mach_time.h>   /* mach_absolute_time, mach_timebase_info */
+   typedef U64 BMK_time_t;
+   static BMK_time_t BMK_getTime(void) { return mach_absolute_time(); }
+   static U64 BMK_getSpanTimeNano(BMK_time_t start, BMK_time_t end)
+   {
+       static mach_timebase_info_data_t rate;
+       if (rate.denom == 0) (void)mach_timebase_info(&rate);
+       return ((end - start) * (U64)rate.numer) / (U64)rate.denom;
+   }
+#elif (PLATFORM_POSIX_VERSION >= 199309L) && defined(CLOCK_MONOTONIC)
+   /* CLOCK_MONOTONIC_RAW is not subject to NTP frequency adjustments */
+#  if defined(CLOCK_MONOTONIC_RAW)
+#    define BMK_CLOCK_ID CLOCK_MONOTONIC_RAW
+#  else
+#    define BMK_CLOCK_ID CLOCK_MONOTONIC
+#  endif
+   typedef struct timespec BMK_time_t;
+   static BMK_time_t BMK_getTime(void)
+   {
+       BMK_time_t t;
+       if (clock_gettime(BMK_CLOCK_ID, &t)) {
+           DISPLAY("Error: clock_gettime failed: %s\n", strerror(errno));
+           exit(1);
+       }
+       return t;
+   }
+   static U64 BMK_getSpanTimeNano(BMK_time_t start, BMK_time_t end)
+   {
+       return (U64)(end.tv_sec - start.tv_sec) * 1000000000ULL
+            + (U64)end.tv_nsec - (U64)start.tv_nsec;
+   }
+#else   /* fallback : process time, coarse resolution */
+   typedef clock_t BMK_time_t;
+   static BMK_time_t BMK_getTime(void) { return clock(); }
+   static U64 BMK_getSpanTimeNano(BMK_time_t start, BMK_time_t end)
+   {
+       return (U64)(((double)(end - start) * 1000000000.) / CLOCKS_PER_SEC);
+   }
+#endif
+
+static U64 BMK_clockSpanNano(BMK_time_t start)
+{
+    return BMK_getSpanTimeNano(start, BMK_getTime());
+}
+
+
+/* BMK_rdtsc() :
+ * Reads the x86 time-stamp counter. It ticks at a constant reference rate
+ * on all modern CPUs, so it is converted to reference cycles using a calibrated frequency.
+ * These are not core cycles, which vary with turbo and frequency scaling :
+ * those are only measured by --counters.
+ * A plain rdtsc is used rather than rdtscp, which Core 2 does not support :
+ * spans are long enough that serialization does not matter. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define BMK_HAS_TSC 1
+#  define BMK_HAS_CPUID 1
+static U64 BMK_rdtsc(void)
+{
+    U32 lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((U64)hi << 32) | lo;
+}
+
+static void BMK_cpuid(U32 leaf, U32 subLeaf, U32 regs[4])
+{
+    __asm__("cpuid"
+        : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+        : "a" (leaf), "c" (subLeaf));
+}
+#else
+#  define BMK_HAS_TSC 0
+#  define BMK_HAS_CPUID 0
+#endif
+
+/* BMK_tscGHz() :
+ * @return : time-stamp counter frequency, in cycles per nanosecond,
+ *           or 0 if no cycle counter is available on this target.
+ * Calibration measures ~50 ms against the monotonic clock, once. */
+static double BMK_tscGHz(void)
 {
-    return clock() - start;   /* works even if overflow; Typical max span ~ 30 mn */
+    static double tscGHz = -1.;
+    if (tscGHz < 0.) {
+        tscGHz = 0.;
+#if BMK_HAS_TSC
+        {   BMK_time_t const tStart = BMK_getTime();
+            U64 const cStart = BMK_rdtsc();
+            U64 nanos;
+            do { nanos = BMK_clockSpanNano(tStart); } while (nanos < 50000000ULL);
+            tscGHz = (double)(BMK_rdtsc() - cStart) / (double)nanos;
+        }
+#endif
+    }
+    return tscGHz;
 }
 
 
+/* ************************************
+ *  Benchmark Functions
+ **************************************/
+
+
 static size_t BMK_findMaxMem(U64 requiredMem)
 {
     size_t const step = 64 MB;
@@ -282,209 +485,4691 @@ static U32 localXXH32_auto(const void* buffer, size_t bufferSize, U32 seed) { re
 
 static U32 localXXH64_auto(const void* buffer, size_t bufferSize, U32 seed) { return (U32)XXH64_auto(buffer, bufferSize, seed); }
 
+static XXH_kernel_e localXXH_autoKernel(size_t length)
+{
+    /* mirrors XXH_auto() : 32-bit selection on 32-bit targets */
+    return (sizeof(size_t) < sizeof(U64)) ? XXH32_autoKernel(length) : XXH64_autoKernel(length);
+}
+
+static const char* const g_kernelNames[] = { "XXH32", "XXH64", "XXH32a", "XXH64a" };
+
+typedef struct {
+    const char*  name;
+    hashFunction func;
+    size_t       misalign;                  /* offset of the "unaligned" variant */
+    XXH_kernel_e (*autoKernel)(size_t len); /* selection logic of _auto variants, NULL otherwise */
+} BMK_hashCandidate;
+
+static const BMK_hashCandidate g_hashCandidates[] = {
+    { "XXH32",      localXXH32,      1, NULL },
+    { "XXH64",      localXXH64,      3, NULL },
+    { "XXH32a",     localXXH32a,     1, NULL },
+    { "XXH64a",     localXXH64a,     1, NULL },
+    { "XXH auto",   localXXH_auto,   1, localXXH_autoKernel },
+    { "XXH32 auto", localXXH32_auto, 1, XXH32_autoKernel },
+    { "XXH64 auto", localXXH64_auto, 1, XXH64_autoKernel },
+};
+#define NB_HASH_CANDIDATES ((U32)(sizeof(g_hashCandidates) / sizeof(g_hashCandidates[0])))
+
+
+/* ************************************
+ *  Hardware Counters
+ **************************************/
+/* Collected with perf_event_open() on Linux, per thread, user space only.
+ * Events are opened as a single group, led by cycles, so that they are all counted
+ * over the same time slices, and ratios between them (IPC) stay meaningful.
+ * Events the CPU does not support, or which don't fit in the group, are skipped individually.
+ * If the PMU multiplexes the group with other users, counts are scaled by enabled/running time. */
+typedef enum {
+    BMK_cnt_cycles,
+    BMK_cnt_instructions,
+    BMK_cnt_branchMisses,
+    BMK_cnt_l1dMisses,
+    BMK_cnt_llcMisses,
+    BMK_cnt_stallsFrontend,
+    BMK_cnt_stallsBackend,
+    BMK_cnt_max
+} BMK_counter_e;
+
+static const char* const g_counterNames[BMK_cnt_max] = {
+    "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "stalls_frontend", "stalls_backend"
+};
+
+static U32 g_counters = 0;   /* set by --counters; reset if no counter can be opened */
+
+#define BMK_CNT_UNSUPPORTED (-1.)   /* event not available on this CPU */
+#define BMK_CNT_NOT_COUNTED (-2.)   /* group never scheduled during the run (n/a) */
+static double g_counterRunning = 1.;   /* fraction of the last run during which the group was counting */
+
+#if BMK_HAS_COUNTERS
+
+static int g_counterFd[BMK_cnt_max];
+static int g_counterLeader = -1;            /* group leader fd */
+static int g_counterOrder[BMK_cnt_max];     /* counter of each value of a group read */
+static int g_nbCountersOpened = 0;
+static int g_countersOpened = 0;
+
+/* BMK_openCounter() :
+ * the first counter opened becomes the group leader, and controls the whole group */
+static int BMK_openCounter(BMK_counter_e counter, U32 type, U64 config)
+{
+    struct perf_event_attr attr;
+    int fd;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (g_counterLeader < 0);   /* members follow their leader */
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    fd = (int)syscall(__NR_perf_event_open, &attr, 0 /* this thread */, -1 /* any cpu */, g_counterLeader, 0);
+    if (fd >= 0) {
+        if (g_counterLeader < 0) g_counterLeader = fd;
+        g_counterOrder[g_nbCountersOpened++] = (int)counter;
+    }
+    return fd;
+}
+
+#define BMK_CACHE_READ_MISS(cache) \
+    ((U64)(cache) | ((U64)PERF_COUNT_HW_CACHE_OP_READ << 8) | ((U64)PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+/* BMK_openCounters() :
+ * opens all counters on first call.
+ * @return : 1 if at least one counter is available */
+static int BMK_openCounters(void)
+{
+    if (!g_countersOpened) {
+#define BMK_OPEN_COUNTER(c, type, config) g_counterFd[c] = BMK_openCounter(c, type, config)
+        BMK_OPEN_COUNTER(BMK_cnt_cycles,         PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        BMK_OPEN_COUNTER(BMK_cnt_instructions,   PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        BMK_OPEN_COUNTER(BMK_cnt_branchMisses,   PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        BMK_OPEN_COUNTER(BMK_cnt_l1dMisses,      PERF_TYPE_HW_CACHE, BMK_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D));
+        BMK_OPEN_COUNTER(BMK_cnt_llcMisses,      PERF_TYPE_HW_CACHE, BMK_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL));
+        BMK_OPEN_COUNTER(BMK_cnt_stallsFrontend, PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND);
+        BMK_OPEN_COUNTER(BMK_cnt_stallsBackend,  PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND);
+#undef BMK_OPEN_COUNTER
+        if (g_nbCountersOpened == 0)
+            DISPLAY("Warning: hardware counters unavailable (%s); check /proc/sys/kernel/perf_event_paranoid \n",
+                    strerror(errno));
+        g_countersOpened = g_nbCountersOpened ? 1 : -1;
+    }
+    return g_countersOpened > 0;
+}
+
+/* BMK_countHash() :
+ * runs `nbHashes` hashes with the counter group enabled.
+ * `perHash` receives counts divided by nbHashes, scaled if the group was multiplexed,
+ * BMK_CNT_UNSUPPORTED for unavailable counters,
+ * or BMK_CNT_NOT_COUNTED if the group was never scheduled.
+ * g_counterRunning receives the fraction of the run during which the group was counting.
+ * @return : 0 on success, 1 if no counter is available */
+static int BMK_countHash(hashFunction h, const void* buffer, size_t bufferSize, U32 nbHashes, double perHash[BMK_cnt_max])
+{
+    U64 values[3 + BMK_cnt_max];   /* nr, time_enabled, time_running, then one value per counter */
+    U32 r = 0;
+    int c;
+    if (!BMK_openCounters()) return 1;
+    ioctl(g_counterLeader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(g_counterLeader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    {   U32 i;
+        for (i=0; i<nbHashes; i++)
+            r += h(buffer, bufferSize, i);
+    }
+    ioctl(g_counterLeader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    if (r==0) DISPLAYLEVEL(3,".\r");  /* do something with r to avoid compiler "optimizing" away hash function */
+    for (c=0; c<BMK_cnt_max; c++) perHash[c] = BMK_CNT_UNSUPPORTED;
+    g_counterRunning = 0.;
+    if ( (read(g_counterLeader, values, sizeof(values)) >= (ssize_t)(3 * sizeof(U64)))
+      && (values[0] == (U64)g_nbCountersOpened) ) {
+        U64 const enabled = values[1];
+        U64 const running = values[2];
+        double const scale = running ? (double)enabled / (double)running / (nbHashes ? nbHashes : 1) : 0.;
+        g_counterRunning = enabled ? (double)running / (double)enabled : 0.;
+        for (c=0; c<g_nbCountersOpened; c++)
+            perHash[g_counterOrder[c]] = running ? (double)values[3+c] * scale : BMK_CNT_NOT_COUNTED;
+    }
+    return 0;
+}
+
+#else
+
+static int BMK_countHash(hashFunction h, const void* buffer, size_t bufferSize, U32 nbHashes, double perHash[BMK_cnt_max])
+{
+    static int warned = 0;
+    (void)h; (void)buffer; (void)bufferSize; (void)nbHashes; (void)perHash;
+    if (!warned) DISPLAY("Warning: hardware counters are not supported on this platform \n");
+    warned = 1;
+    return 1;
+}
+
+#endif   /* BMK_HAS_COUNTERS */
+
+/* BMK_measureCounters() :
+ * collects counters over ~1/4 of an iteration, knowing the time per hash.
+ * @return : 0 on success, 1 if counters are unavailable (g_counters is then disabled) */
+static int BMK_measureCounters(hashFunction h, const void* buffer, size_t bufferSize, double nsPerHash,
+                               double perHash[BMK_cnt_max])
+{
+    U32 const nbHashes = (U32)((double)(TIMELOOP_NS/4) / nsPerHash) + 1;
+    if (BMK_countHash(h, buffer, bufferSize, nbHashes, perHash)) { g_counters = 0; return 1; }
+    return 0;
+}
+
+static void BMK_displayCounters(const double perHash[BMK_cnt_max], size_t bufferSize)
+{
+    int c;
+    DISPLAYLEVEL(1, "%22s", "");
+    if ((perHash[BMK_cnt_cycles] > 0.) && (perHash[BMK_cnt_instructions] >= 0.))
+        DISPLAYLEVEL(1, " IPC %5.2f,", perHash[BMK_cnt_instructions] / perHash[BMK_cnt_cycles]);
+    if (perHash[BMK_cnt_instructions] >= 0.)
+        DISPLAYLEVEL(1, " %.2f instructions/B,", perHash[BMK_cnt_instructions] / (double)(bufferSize ? bufferSize : 1));
+    for (c=0; c<BMK_cnt_max; c++) {
+        if (perHash[c] >= 0.) DISPLAYLEVEL(1, " %.2f %s", perHash[c], g_counterNames[c]);
+        else if (perHash[c] < BMK_CNT_UNSUPPORTED) DISPLAYLEVEL(1, " n/a %s", g_counterNames[c]);
+    }
+    DISPLAYLEVEL(1, " (per hash");
+    if ((g_counterRunning > 0.) && (g_counterRunning < 0.999))
+        DISPLAYLEVEL(1, ", multiplexed : scaled from %.0f%% of the run", g_counterRunning * 100.);
+    DISPLAYLEVEL(1, ") \n");
+}
+
+
+/* BMK_hashLoop() :
+ * Hashes `buffer` `nbHashes` times.
+ * `dependent` : if non-zero, each call is seeded with the previous result.
+ * @return : a combination of all results, to be consumed by the caller */
+static U32 BMK_hashLoop(hashFunction h, const void* buffer, size_t bufferSize,
+                        U32 nbHashes, int dependent)
+{
+    U32 r = 0;
+    U32 i;
+    if (dependent) {
+        for (i=0; i<nbHashes; i++)
+            r = h(buffer, bufferSize, r);
+    } else {
+        for (i=0; i<nbHashes; i++)
+            r += h(buffer, bufferSize, i);
+    }
+    return r;
+}
+
 
-static void BMK_benchHash(hashFunction h, const char* hName, const void* buffer, size_t bufferSize)
+/* BMK_measureHash() :
+ * Hashes `buffer` repeatedly, in g_nbIterations rounds lasting about `targetNanos` each.
+ * `dependent` : if non-zero, each call is seeded with the previous result,
+ *               measuring latency rather than throughput.
+ * Progress is displayed when `hName` is not NULL.
+ * @return : fastest round, in nanoseconds per hash */
+static double BMK_measureHash(hashFunction h, const char* hName,
+                              const void* buffer, size_t bufferSize,
+                              U64 targetNanos, int dependent)
 {
     U32 nbh_perIteration = (U32)((300 MB) / (bufferSize+1)) + 1;  /* first loop conservatively aims for 300 MB/s */
     U32 iterationNb;
-    double fastestH = 100000000.;
+    double fastestH = 100000000.;   /* in nanoseconds per hash */
 
-    DISPLAYLEVEL(2, "\r%70s\r", "");       /* Clean display line */
     if (g_nbIterations<1) g_nbIterations=1;
+    if (targetNanos < TIMELOOP_NS) nbh_perIteration = (U32)(((U64)nbh_perIteration * targetNanos) / TIMELOOP_NS) + 1;
     for (iterationNb = 1; iterationNb <= g_nbIterations; iterationNb++) {
-        U32 r=0;
-        clock_t cStart;
+        U32 r;
+        BMK_time_t tStart;
+
+        if (hName) DISPLAYLEVEL(2, "%1u-%-17.17s : %10llu ->\r", iterationNb, hName, (unsigned long long)bufferSize);
+        tStart = BMK_getTime();
+        r = BMK_hashLoop(h, buffer, bufferSize, nbh_perIteration, dependent);
+        if (r==0) DISPLAYLEVEL(3,".\r");  /* do something with r to avoid compiler "optimizing" away hash function */
+        {   U64 const nanos = BMK_clockSpanNano(tStart);
+            double const nsPerHash = (double)(nanos ? nanos : 1) / nbh_perIteration;
+            if (nsPerHash < fastestH) fastestH = nsPerHash;
+            if (hName) DISPLAYLEVEL(2, "%1u-%-17.17s : %10llu -> %8.0f it/s (%7.1f MB/s) \r",
+                    iterationNb, hName, (unsigned long long)bufferSize,
+                    1000000000. / fastestH,
+                    ((double)bufferSize / (1<<20)) * 1000000000. / fastestH );
+        }
+        assert(fastestH > 1./2);  /* avoid U32 overflow */
+        nbh_perIteration = (U32)((double)targetNanos / fastestH) + 1;  /* adjust nbh_perIteration to last roughtly targetNanos */
+    }
+    return fastestH;
+}
+
+
+/* ************************************
+ *  Robust sampling (--samples)
+ **************************************/
+#define BMK_WARMUP_NS        (100000000ULL)   /* 100 ms */
+#define BMK_SAMPLE_NS         (10000000ULL)   /* 10 ms */
+#define BMK_PROBE_LOOPS          100000
+#define BMK_SAMPLES_MAX           10000
+#define SAMPLES_DEFAULT              30
+#define BMK_NOISE_CLOCK_PCT          5.
+#define BMK_NOISE_TSC_PCT            1.
+#define BMK_NOISE_CV_PCT             5.
+
+#if BMK_HAS_AFFINITY
+static cpu_set_t g_savedAffinity;
+static int g_affinitySaved = 0;
+#endif
+
+/* BMK_pinToCurrentCpu() :
+ * Restricts the calling thread to the CPU it currently runs on,
+ * so that samples are not disturbed by migrations.
+ * BMK_unpin() restores the previous affinity mask.
+ * @return : CPU number, or -1 if pinning is not possible */
+static int BMK_pinToCurrentCpu(void)
+{
+#if BMK_HAS_AFFINITY
+    int const cpu = sched_getcpu();
+    cpu_set_t set;
+    if (cpu < 0) return -1;
+    if (sched_getaffinity(0, sizeof(g_savedAffinity), &g_savedAffinity) != 0) return -1;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) return -1;
+    g_affinitySaved = 1;
+    return cpu;
+#else
+    return -1;
+#endif
+}
+
+static void BMK_unpin(void)
+{
+#if BMK_HAS_AFFINITY
+    if (g_affinitySaved) sched_setaffinity(0, sizeof(g_savedAffinity), &g_savedAffinity);
+    g_affinitySaved = 0;
+#endif
+}
+
+/* BMK_clockProbe() :
+ * Times a fixed chain of dependent multiplications.
+ * Its duration only depends on the core clock :
+ * a variation between probes reveals frequency scaling (or preemption).
+ * @return : duration, in nanoseconds */
+static U64 BMK_clockProbe(void)
+{
+    static volatile U64 sink = 1;
+    U64 x = sink;
+    U32 i;
+    BMK_time_t const tStart = BMK_getTime();
+    for (i=0; i<BMK_PROBE_LOOPS; i++)
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    sink = x;
+    return BMK_clockSpanNano(tStart);
+}
+
+/* BMK_sqrt() : Newton's method, avoids a dependency on libm */
+static double BMK_sqrt(double v)
+{
+    double x = v > 1. ? v : 1.;
+    int i;
+    if (v <= 0.) return 0.;
+    for (i=0; i<64; i++) {
+        double const next = (x + v / x) / 2.;
+        if (next >= x) break;
+        x = next;
+    }
+    return x;
+}
+
+static int BMK_compareDouble(const void* a, const void* b)
+{
+    double const da = *(const double*)a;
+    double const db = *(const double*)b;
+    return (da > db) - (da < db);
+}
 
-        DISPLAYLEVEL(2, "%1u-%-17.17s : %10u ->\r", iterationNb, hName, (U32)bufferSize);
-        cStart = clock();
-        while (clock() == cStart);   /* starts clock() at its exact beginning */
-        cStart = clock();
+typedef struct {
+    double minNs, medianNs, p90Ns, p99Ns;   /* per hash */
+    double meanNs, stddevNs;
+    double clockSpreadPct;   /* spread of core clock probes, (max-min)/min */
+    double tscDriftPct;      /* worst deviation of TSC rate from calibration, 0 without TSC */
+    U32 nbSamples;
+    int cpu;                 /* -1 if not pinned */
+} BMK_sampleStats;
+
+/* BMK_sampleHash() :
+ * Robust alternative to BMK_measureHash().
+ * Pins the thread, warms up for BMK_WARMUP_NS (clock ramp up, caches, branch predictors),
+ * then measures `nbSamples` samples of about BMK_SAMPLE_NS each.
+ * Each sample is preceded by a clock probe, and timed with the TSC when available :
+ * a TSC rate different from its calibration means the clock source is unreliable.
+ * @return : 0 on success, 1 on allocation failure */
+static int BMK_sampleHash(hashFunction h, const char* hName,
+                          const void* buffer, size_t bufferSize,
+                          U32 nbSamples, int dependent, BMK_sampleStats* stats)
+{
+    double const tscGHz = BMK_tscGHz();
+    double* const samples = (double*)malloc(nbSamples * sizeof(double));
+    double* const probes = (double*)malloc(nbSamples * sizeof(double));
+    U32 nbHashes = 1;
+    U32 r = 0;
+    U32 s;
+
+    if (!samples || !probes) { free(samples); free(probes); return 1; }
+    memset(stats, 0, sizeof(*stats));
+    stats->nbSamples = nbSamples;
+    stats->cpu = BMK_pinToCurrentCpu();
+
+    /* warm up, and size samples */
+    if (hName) DISPLAYLEVEL(2, "w-%-17.17s : %10llu ->\r", hName, (unsigned long long)bufferSize);
+    {   BMK_time_t const tWarm = BMK_getTime();
+        double nsPerHash = 0.;
+        do {
+            BMK_time_t const tStart = BMK_getTime();
+            U64 nanos;
+            r += BMK_hashLoop(h, buffer, bufferSize, nbHashes, dependent);
+            nanos = BMK_clockSpanNano(tStart);
+            nsPerHash = (double)(nanos ? nanos : 1) / nbHashes;
+            if ((nanos < BMK_SAMPLE_NS / 10) && (nbHashes < (1U << 30))) nbHashes *= 2;
+        } while (BMK_clockSpanNano(tWarm) < BMK_WARMUP_NS);
+        nbHashes = (U32)((double)BMK_SAMPLE_NS / nsPerHash) + 1;
+    }
 
-        {   U32 i;
-            for (i=0; i<nbh_perIteration; i++)
-                r += h(buffer, bufferSize, i);
+    for (s=0; s<nbSamples; s++) {
+        BMK_time_t tStart;
+        U64 nanos;
+#if BMK_HAS_TSC
+        U64 cStart;
+#endif
+        if (hName) DISPLAYLEVEL(2, "%-19.19s : %10llu -> sample %u/%u \r",
+                        hName, (unsigned long long)bufferSize, s+1, nbSamples);
+        probes[s] = (double)BMK_clockProbe();
+#if BMK_HAS_TSC
+        cStart = BMK_rdtsc();
+#endif
+        tStart = BMK_getTime();
+        r += BMK_hashLoop(h, buffer, bufferSize, nbHashes, dependent);
+        nanos = BMK_clockSpanNano(tStart);
+        if (nanos == 0) nanos = 1;
+#if BMK_HAS_TSC
+        if (tscGHz > 0.) {
+            double const rate = (double)(BMK_rdtsc() - cStart) / (double)nanos;
+            double drift = (rate - tscGHz) * 100. / tscGHz;
+            if (drift < 0.) drift = -drift;
+            if (drift > stats->tscDriftPct) stats->tscDriftPct = drift;
         }
-        if (r==0) DISPLAYLEVEL(3,".\r");  /* do something with r to avoid compiler "optimizing" away hash function */
-        {   double const timeS = ((double)BMK_clockSpan(cStart) / CLOCKS_PER_SEC) / nbh_perIteration;
-            if (timeS < fastestH) fastestH = timeS;
-            DISPLAYLEVEL(2, "%1u-%-17.17s : %10u -> %8.0f it/s (%7.1f MB/s) \r",
-                    iterationNb, hName, (U32)bufferSize,
-                    (double)1 / fastestH,
-                    ((double)bufferSize / (1<<20)) / fastestH );
-        }
-        assert(fastestH > 1./2000000000);  /* avoid U32 overflow */
-        nbh_perIteration = (U32)(1 / fastestH) + 1;  /* adjust nbh_perIteration to last roughtly one second */
-    }
-    DISPLAYLEVEL(1, "%-19.19s : %10u -> %8.0f it/s (%7.1f MB/s) \n", hName, (U32)bufferSize,
-        (double)1 / fastestH,
-        ((double)bufferSize / (1<<20)) / fastestH);
+#endif
+        samples[s] = (double)nanos / nbHashes;
+    }
+    if (r==0) DISPLAYLEVEL(3,".\r");  /* do something with r to avoid compiler "optimizing" away hash function */
+    BMK_unpin();
+    (void)tscGHz;   /* unused without TSC */
+
+    {   double sum = 0., sumSq = 0.;
+        for (s=0; s<nbSamples; s++) sum += samples[s];
+        stats->meanNs = sum / nbSamples;
+        for (s=0; s<nbSamples; s++)
+            sumSq += (samples[s] - stats->meanNs) * (samples[s] - stats->meanNs);
+        stats->stddevNs = (nbSamples > 1) ? BMK_sqrt(sumSq / (nbSamples-1)) : 0.;
+    }
+    /* nearest-rank percentiles */
+    qsort(samples, nbSamples, sizeof(double), BMK_compareDouble);
+    stats->minNs = samples[0];
+    stats->medianNs = samples[(nbSamples-1) / 2];
+    stats->p90Ns = samples[(nbSamples * 90 + 99) / 100 - 1];
+    stats->p99Ns = samples[(nbSamples * 99 + 99) / 100 - 1];
+    qsort(probes, nbSamples, sizeof(double), BMK_compareDouble);
+    stats->clockSpreadPct = (probes[nbSamples-1] - probes[0]) * 100. / probes[0];
+
+    free(samples);
+    free(probes);
+    return 0;
+}
+
+/* BMK_displaySampleStats() :
+ * Second line of a --samples result : distribution, then noise warnings */
+static void BMK_displaySampleStats(const BMK_sampleStats* stats)
+{
+    double const cvPct = stats->meanNs > 0. ? stats->stddevNs * 100. / stats->meanNs : 0.;
+    DISPLAYLEVEL(1, "%22s ns/hash : min %.1f, median %.1f, p90 %.1f, p99 %.1f, stddev %.2f (%.1f%%), %u samples",
+        "", stats->minNs, stats->medianNs, stats->p90Ns, stats->p99Ns,
+        stats->stddevNs, cvPct, stats->nbSamples);
+    if (stats->cpu >= 0) DISPLAYLEVEL(1, " on cpu %i", stats->cpu);
+    DISPLAYLEVEL(1, " \n");
+    if (stats->clockSpreadPct > BMK_NOISE_CLOCK_PCT)
+        DISPLAYLEVEL(1, "%22s warning : core clock varied by %.1f%% between samples (frequency scaling or preemption) \n",
+            "", stats->clockSpreadPct);
+    if (stats->tscDriftPct > BMK_NOISE_TSC_PCT)
+        DISPLAYLEVEL(1, "%22s warning : TSC rate deviated by %.1f%% from wall clock (unstable clock source) \n",
+            "", stats->tscDriftPct);
+    if (cvPct > BMK_NOISE_CV_PCT)
+        DISPLAYLEVEL(1, "%22s warning : samples are noisy, prefer the median \n", "");
+}
+
+
+/* ************************************
+ *  Reference functions
+ **************************************/
+/* Reference functions, measuring memory bandwidth under the same conditions as hashes */
+static BYTE* g_memcpyDst = NULL;   /* must be large enough for the benched size */
+
+static U32 BMK_memcpyRef(const void* buffer, size_t bufferSize, U32 seed)
+{
+    memcpy(g_memcpyDst, buffer, bufferSize);
+    return seed + g_memcpyDst[0];
+}
+
+static U32 BMK_readRef(const void* buffer, size_t bufferSize, U32 seed)
+{
+    const BYTE* p = (const BYTE*)buffer;
+    const BYTE* const end = p + bufferSize;
+    U64 sum[4] = { 0, 0, 0, 0 };
+    while (p + 32 <= end) {   /* independent accumulators, so that loads are not serialized */
+        U64 words[4];
+        memcpy(words, p, sizeof(words));
+        sum[0] += words[0]; sum[1] += words[1]; sum[2] += words[2]; sum[3] += words[3];
+        p += 32;
+    }
+    while (p < end) sum[0] += *p++;
+    sum[0] += sum[1] + sum[2] + sum[3] + seed;
+    return (U32)(sum[0] ^ (sum[0] >> 32));
+}
+
+/* BMK_crc32cRef() :
+ * CRC32C with the SSE4.2 crc32 instruction, as a hardware checksum reference.
+ * A single dependency chain : latency bound (usually 3 cycles per 8 bytes).
+ * Only valid when BMK_hasCrc32c() */
+#if BMK_HAS_CPUID
+#  define BMK_HAS_CRC32C 1
+static int BMK_hasCrc32c(void)
+{
+    U32 regs[4];
+    BMK_cpuid(0, 0, regs);
+    if (regs[0] < 1) return 0;
+    BMK_cpuid(1, 0, regs);
+    return (regs[2] >> 20) & 1;   /* sse4.2 */
+}
+
+static U32 BMK_crc32cRef(const void* buffer, size_t bufferSize, U32 seed)
+{
+    const BYTE* p = (const BYTE*)buffer;
+    const BYTE* const end = p + bufferSize;
+    U32 crc = ~seed;
+#  if defined(__x86_64__)
+    while (p + 8 <= end) {
+        U64 word, crc64 = crc;
+        memcpy(&word, p, sizeof(word));
+        __asm__("crc32q %1, %0" : "+r" (crc64) : "rm" (word));
+        crc = (U32)crc64;
+        p += 8;
+    }
+#  endif
+    while (p + 4 <= end) {
+        U32 word;
+        memcpy(&word, p, sizeof(word));
+        __asm__("crc32l %1, %0" : "+r" (crc) : "rm" (word));
+        p += 4;
+    }
+    while (p < end) {
+        __asm__("crc32b %1, %0" : "+r" (crc) : "rm" (*p));
+        p++;
+    }
+    return ~crc;
+}
+#else
+#  define BMK_HAS_CRC32C 0
+#endif
+
+/* Memory ceiling measured by BMK_benchMem() : faster of read and memcpy, in ns per buffer.
+ * Hash results are also displayed as a fraction of it. 0 when unknown */
+static double g_memCeilingNs = 0.;
+
+/* BMK_benchHash() :
+ * @return : measured time, in nanoseconds per hash */
+static double BMK_benchHash(hashFunction h, const char* hName, const void* buffer, size_t bufferSize)
+{
+    double const tscGHz = BMK_tscGHz();
+    double fastestH;
+
+    BMK_sampleStats stats;
+
+    DISPLAYLEVEL(2, "\r%70s\r", "");       /* Clean display line */
+    if (g_nbSamples && !BMK_sampleHash(h, hName, buffer, bufferSize, g_nbSamples, 0, &stats)) {
+        fastestH = stats.medianNs;   /* robust mode reports the median */
+    } else {
+        stats.nbSamples = 0;
+        fastestH = BMK_measureHash(h, hName, buffer, bufferSize, TIMELOOP_NS, 0);
+    }
+    DISPLAYLEVEL(1, "%-19.19s : %10llu -> %8.0f it/s (%7.1f MB/s) %10.1f ns/hash", hName, (unsigned long long)bufferSize,
+        1000000000. / fastestH,
+        ((double)bufferSize / (1<<20)) * 1000000000. / fastestH,
+        fastestH);
+    if (tscGHz > 0.)
+        DISPLAYLEVEL(1, " %10.1f ref-cycles/hash %6.2f ref-cycles/B", fastestH * tscGHz,
+            fastestH * tscGHz / (double)(bufferSize ? bufferSize : 1));
+    if (g_memCeilingNs > 0.)
+        DISPLAYLEVEL(1, " %5.1f%% of mem", g_memCeilingNs * 100. / fastestH);
+    DISPLAYLEVEL(1, " \n");
+    if (stats.nbSamples) BMK_displaySampleStats(&stats);
+    if (g_counters) {
+        double perHash[BMK_cnt_max];
+        if (!BMK_measureCounters(h, buffer, bufferSize, fastestH, perHash))
+            BMK_displayCounters(perHash, bufferSize);
+    }
+    if (g_displayLevel<1)
+        DISPLAYLEVEL(0, "%u, ", (U32)(1000000000. / fastestH));
+    return fastestH;
+}
+
+
+/* BMK_benchLatency() :
+ * same as BMK_benchHash(), but with dependent calls.
+ * Reports the time from input to result of a single hash. */
+static void BMK_benchLatency(hashFunction h, const char* hName, const void* buffer, size_t bufferSize)
+{
+    double const tscGHz = BMK_tscGHz();
+    char latencyName[64];
+    double latency;
+
+    sprintf(latencyName, "%.40s latency", hName);
+    DISPLAYLEVEL(2, "\r%70s\r", "");       /* Clean display line */
+    latency = BMK_measureHash(h, latencyName, buffer, bufferSize, TIMELOOP_NS, 1);
+    DISPLAYLEVEL(1, "%-27.27s : %10llu -> %10.1f ns latency", latencyName, (unsigned long long)bufferSize, latency);
+    if (tscGHz > 0.)
+        DISPLAYLEVEL(1, " %10.1f ref-cycles", latency * tscGHz);
+    DISPLAYLEVEL(1, " \n");
     if (g_displayLevel<1)
-        DISPLAYLEVEL(0, "%u, ", (U32)((double)1 / fastestH));
+        DISPLAYLEVEL(0, "%.1f, ", latency);
 }
 
 
+#define REFS_MAX_SIZE (256 MB)   /* memcpy destination : mapped files may be larger than RAM */
+
+/* BMK_benchRefs() :
+ * Reference rows, preceding hash results : read reduction and memcpy
+ * (the faster one is the memory ceiling), then hardware CRC32C when available.
+ * They are measured over the first REFS_MAX_SIZE bytes of larger buffers.
+ * Sets g_memCeilingNs, scaled to bufferSize, so that following results are displayed relative to it. */
+static void BMK_benchRefs(const void* buffer, size_t bufferSize)
+{
+    size_t const refSize = MIN(bufferSize, REFS_MAX_SIZE);
+    double ceilingNs;
+    g_memCeilingNs = 0.;
+    ceilingNs = BMK_benchHash(BMK_readRef, "read (reference)", buffer, refSize);
+    g_memcpyDst = (BYTE*)malloc(refSize + 16);
+    if (g_memcpyDst) {
+        double const memcpyNs = BMK_benchHash(BMK_memcpyRef, "memcpy (reference)", buffer, refSize);
+        if (memcpyNs < ceilingNs) ceilingNs = memcpyNs;
+        free(g_memcpyDst); g_memcpyDst = NULL;
+    }
+    g_memCeilingNs = ceilingNs;
+#if BMK_HAS_CRC32C
+    if (BMK_hasCrc32c())
+        BMK_benchHash(BMK_crc32cRef, "CRC32C (reference)", buffer, refSize);
+#endif
+    if (refSize < bufferSize) g_memCeilingNs *= (double)bufferSize / (double)refSize;
+}
+
 /* BMK_benchMem():
  * specificTest : 0 == run all tests, 1+ run only specific test
- * buffer : is supposed 8-bytes aligned (if malloc'ed, it should be)
+ *                (odd numbers : aligned input, even numbers : unaligned input)
+ *                Reference rows are only measured when running all tests.
+ * buffer : is supposed 16-bytes aligned (if malloc'ed, it should be)
  * the real allocated size of buffer is supposed to be >= (bufferSize+3).
  * @return : 0 on success, 1 if error (invalid mode selected) */
 static int BMK_benchMem(const void* buffer, size_t bufferSize, U32 specificTest)
 {
+    U32 idx;
     assert((((size_t)buffer) & 15) == 0);  /* ensure alignment */
 
-    /* XXH32 bench */
-    if ((specificTest==0) | (specificTest==1))
-        BMK_benchHash(localXXH32, "XXH32", buffer, bufferSize);
+    if (specificTest > 2*NB_HASH_CANDIDATES) {
+        DISPLAY("benchmark mode invalid \n");
+        return 1;
+    }
+
+    if ((specificTest==0) && (g_displayLevel>=1)) BMK_benchRefs(buffer, bufferSize);
 
-    /* Bench XXH32 on Unaligned input */
-    if ((specificTest==0) | (specificTest==2))
-        BMK_benchHash(localXXH32, "XXH32 unaligned", ((const char*)buffer)+1, bufferSize);
+    for (idx=0; idx<NB_HASH_CANDIDATES; idx++) {
+        const BMK_hashCandidate* const candidate = g_hashCandidates + idx;
 
-    /* Bench XXH64 */
-    if ((specificTest==0) | (specificTest==3))
-        BMK_benchHash(localXXH64, "XXH64", buffer, bufferSize);
+        /* Bench on aligned input */
+        if ((specificTest==0) | (specificTest==2*idx+1)) {
+            BMK_benchHash(candidate->func, candidate->name, buffer, bufferSize);
+            if (g_benchLatency)
+                BMK_benchLatency(candidate->func, candidate->name, buffer, bufferSize);
+        }
+
+        /* Bench on unaligned input */
+        if ((specificTest==0) | (specificTest==2*idx+2)) {
+            char unalignedName[64];
+            sprintf(unalignedName, "%.40s unaligned", candidate->name);
+            BMK_benchHash(candidate->func, unalignedName,
+                          ((const char*)buffer) + candidate->misalign, bufferSize);
+            if (g_benchLatency)
+                BMK_benchLatency(candidate->func, unalignedName,
+                                 ((const char*)buffer) + candidate->misalign, bufferSize);
+        }
+    }
+    g_memCeilingNs = 0.;
+    return 0;
+}
+
+
+/* BMK_fillBuffer() :
+ * fills `buffer` with pseudo-random content.
+ * Large calloc'ed buffers may otherwise be backed by a single shared zero page,
+ * making memory-bound measurements look cache-resident. */
+static void BMK_fillBuffer(void* buffer, size_t size)
+{
+    BYTE* const p = (BYTE*)buffer;
+    U32 byteGen = 2654435761U;
+    size_t i;
+    for (i=0; i<size; i++) {
+        byteGen = byteGen * 1103515245U + 12345U;
+        p[i] = (BYTE)(byteGen >> 24);
+    }
+}
+
+
+static size_t BMK_selectBenchedSize(const char* fileName)
+{   U64 const inFileSize = BMK_GetFileSize(fileName);
+    size_t benchedSize = (size_t) BMK_findMaxMem(inFileSize);
+    if ((U64)benchedSize > inFileSize) benchedSize = (size_t)inFileSize;
+    if (benchedSize < inFileSize) {
+        DISPLAY("Not enough memory for '%s' full size; testing %i MB only...\n", fileName, (int)(benchedSize>>20));
+    }
+    return benchedSize;
+}
+
+
+#if BMK_HAS_MMAP && defined(BMK_MAP_ANONYMOUS)
+/* BMK_mapFile() :
+ * maps the whole file, without copy nor size limit other than address space.
+ * Benchmarks of unaligned input read up to 3 bytes past the end :
+ * an anonymous mapping reserves the range, and the file is mapped over it,
+ * so that these bytes are always readable.
+ * @return : start of mapping, or NULL on failure
+ *           *reservedSize : length to munmap() */
+static const void* BMK_mapFile(const char* fileName, size_t fileSize, size_t* reservedSize)
+{
+    size_t const pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t const reserved = ((fileSize + 3 + pageSize - 1) / pageSize) * pageSize;
+    int const fd = open(fileName, O_RDONLY);
+    void* base;
+    if (fd < 0) return NULL;
+    base = mmap(NULL, reserved, PROT_READ, MAP_PRIVATE | BMK_MAP_ANONYMOUS, -1, 0);
+    if (base != MAP_FAILED) {
+        int const flags = MAP_PRIVATE | MAP_FIXED | (g_mapPopulate ? BMK_MAP_POPULATE : 0);
+        if (mmap(base, fileSize, PROT_READ, flags, fd, 0) == MAP_FAILED) {
+            munmap(base, reserved);
+            base = MAP_FAILED;
+    }   }
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+#  ifdef MADV_HUGEPAGE
+    if (g_mapHugePages) (void)madvise(base, fileSize, MADV_HUGEPAGE);
+#  endif
+    *reservedSize = reserved;
+    return base;
+}
+#endif
+
+static int BMK_benchFiles(const char** fileNamesTable, int nbFiles, U32 specificTest)
+{
+    int result = 0;
+    int fileIdx;
 
-    /* Bench XXH64 on Unaligned input */
-    if ((specificTest==0) | (specificTest==4))
-        BMK_benchHash(localXXH64, "XXH64 unaligned", ((const char*)buffer)+3, bufferSize);
+    for (fileIdx=0; fileIdx<nbFiles; fileIdx++) {
+        const char* const inFileName = fileNamesTable[fileIdx];
+        assert(inFileName != NULL);
+#if BMK_HAS_MMAP && defined(BMK_MAP_ANONYMOUS)
+        {   U64 const fileSize = BMK_GetFileSize(inFileName);
+            size_t reservedSize = 0;
+            const void* const map = ((fileSize > 0) && (fileSize < (U64)((size_t)-1 >> 1))) ?
+                                    BMK_mapFile(inFileName, (size_t)fileSize, &reservedSize) : NULL;
+            if (map != NULL) {
+                DISPLAYLEVEL(1, "\rMapping %s (%llu MB)...        \n", inFileName, (unsigned long long)(fileSize >> 20));
+                result |= BMK_benchMem(map, (size_t)fileSize, specificTest);
+                munmap((void*)(size_t)map, reservedSize);
+                continue;
+            }
+            /* mmap() not possible : load file into memory */
+        }
+#endif
+        {
+            size_t const benchedSize = BMK_selectBenchedSize(inFileName);
+            char* const buffer = (char*)calloc(benchedSize+16+3, 1);
+            void* const alignedBuffer = (buffer+15) - (((size_t)(buffer+15)) & 0xF);  /* align on next 16 bytes */
+            FILE* const inFile = fopen( inFileName, "rb" );
 
-    /* XXH32a bench */
-    if ((specificTest==0) | (specificTest==5))
-        BMK_benchHash(localXXH32a, "XXH32a", buffer, bufferSize);
+            /* Checks */
+            if (inFile==NULL){
+                DISPLAY("Could not open %s: %s\n", inFileName, strerror(errno));
+                free(buffer);
+                return 11;
+            }
+            if(!buffer) {
+                DISPLAY("\nError: not enough memory!\n");
+                fclose(inFile);
+                return 12;
+            }
 
-    /* Bench XXH32a on Unaligned input */
-    if ((specificTest==0) | (specificTest==6))
-        BMK_benchHash(localXXH32a, "XXH32a unaligned", ((const char*)buffer)+1, bufferSize);
+            /* Fill input buffer */
+            DISPLAYLEVEL(1, "\rLoading %s...        \n", inFileName);
+            {   size_t const readSize = fread(alignedBuffer, 1, benchedSize, inFile);
+                if(readSize != benchedSize) {
+                    DISPLAY("\nError: Could not read %s: %s\n", inFileName, strerror(errno));
+                    fclose(inFile);
+                    free(buffer);
+                    return 13;
+                }
+                fclose(inFile);
+            }
+
+            /* bench */
+            result |= BMK_benchMem(alignedBuffer, benchedSize, specificTest);
+
+            free(buffer);
+        }
+    }
+
+    return result;
+}
+
+
+
+static int BMK_benchInternal(size_t keySize, int specificTest)
+{
+    void* const buffer = malloc(keySize+16+3);   /* fully written by BMK_fillBuffer() */
+    if(!buffer) {
+        DISPLAY("\nError: not enough memory!\n");
+        return 12;
+    }
+
+    {   void* const alignedBuffer = ((char*)buffer+15) - (((size_t)((char*)buffer+15)) & 0xF);  /* align on next 16 bytes */
+        BMK_fillBuffer(buffer, keySize+16+3);
+
+        /* bench */
+        DISPLAYLEVEL(1, "Sample of ");
+        if (keySize > 10 KB) {
+            DISPLAYLEVEL(1, "%u KB", (U32)(keySize >> 10));
+        } else {
+            DISPLAYLEVEL(1, "%u bytes", (U32)keySize);
+        }
+        DISPLAYLEVEL(1, "...        \n");
+
+        {   int const result = BMK_benchMem(alignedBuffer, keySize, specificTest);
+            free(buffer);
+            return result;
+        }
+    }
+}
+
+/* ********************************************************
+*  Host description, for machine-readable reports
+**********************************************************/
+
+#if defined(__clang__)
+#  define BMK_COMPILER "clang " __clang_version__
+#elif defined(__GNUC__)
+#  define BMK_COMPILER "gcc " __VERSION__
+#elif defined(_MSC_VER)
+#  define BMK_COMPILER "MSVC " EXPAND_AND_QUOTE(_MSC_VER)
+#else
+#  define BMK_COMPILER "unknown"
+#endif
+
+/* Instruction sets the binary was compiled for */
+static const char g_targetFlags[] = ""
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    " sse2"
+#endif
+#if defined(__SSE4_1__)
+    " sse4.1"
+#endif
+#if defined(__SSE4_2__)
+    " sse4.2"
+#endif
+#if defined(__AVX__)
+    " avx"
+#endif
+#if defined(__AVX2__)
+    " avx2"
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    " neon"
+#endif
+    ;
+
+static void BMK_appendFlag(char* dst, size_t dstSize, int present, const char* flag)
+{
+    if (present && (strlen(dst) + strlen(flag) + 2 <= dstSize)) {
+        if (dst[0]) strcat(dst, " ");
+        strcat(dst, flag);
+    }
+}
+
+/* BMK_getCpuName() :
+ * x86 : brand string reported by cpuid.
+ * Linux : first "model name" line of /proc/cpuinfo.
+ * "unknown" otherwise. */
+static void BMK_getCpuName(char* dst, size_t dstSize)
+{
+    assert(dstSize > 48);
+    strcpy(dst, "unknown");
+#if BMK_HAS_CPUID
+    {   U32 regs[12];
+        BMK_cpuid(0x80000000U, 0, regs);
+        if (regs[0] >= 0x80000004U) {
+            const char* start = (const char*)regs;
+            BMK_cpuid(0x80000002U, 0, regs);
+            BMK_cpuid(0x80000003U, 0, regs+4);
+            BMK_cpuid(0x80000004U, 0, regs+8);
+            while (*start == ' ') start++;
+            memcpy(dst, start, 48 - (size_t)(start - (const char*)regs));
+            dst[48 - (start - (const char*)regs)] = '\0';
+            return;
+    }   }
+#elif defined(__linux__)
+    {   FILE* const cpuinfo = fopen("/proc/cpuinfo", "r");
+        char line[256];
+        if (cpuinfo == NULL) return;
+        while (fgets(line, sizeof(line), cpuinfo) != NULL) {
+            const char* const colon = strchr(line, ':');
+            if (colon && !strncmp(line, "model name", 10)) {
+                size_t len = strlen(colon + 2);
+                while (len && (colon[1+len] == '\n')) len--;
+                if (len >= dstSize) len = dstSize-1;
+                memcpy(dst, colon + 2, len);
+                dst[len] = '\0';
+                break;
+        }   }
+        fclose(cpuinfo);
+    }
+#endif
+}
+
+/* BMK_getCpuFlags() :
+ * Instruction sets supported by the CPU running the benchmark,
+ * which may differ from the ones the binary was compiled for. */
+static void BMK_getCpuFlags(char* dst, size_t dstSize)
+{
+    dst[0] = '\0';
+#if BMK_HAS_CPUID
+    {   U32 regs[4];
+        U32 maxLeaf;
+        BMK_cpuid(0, 0, regs);
+        maxLeaf = regs[0];
+        BMK_cpuid(1, 0, regs);
+        BMK_appendFlag(dst, dstSize, (regs[3] >> 26) & 1, "sse2");
+        BMK_appendFlag(dst, dstSize, (regs[2] >>  9) & 1, "ssse3");
+        BMK_appendFlag(dst, dstSize, (regs[2] >> 19) & 1, "sse4.1");
+        BMK_appendFlag(dst, dstSize, (regs[2] >> 20) & 1, "sse4.2");
+        BMK_appendFlag(dst, dstSize, (regs[2] >> 28) & 1, "avx");
+        if (maxLeaf >= 7) {
+            BMK_cpuid(7, 0, regs);
+            BMK_appendFlag(dst, dstSize, (regs[1] >>  5) & 1, "avx2");
+            BMK_appendFlag(dst, dstSize, (regs[1] >>  8) & 1, "bmi2");
+            BMK_appendFlag(dst, dstSize, (regs[1] >> 16) & 1, "avx512f");
+    }   }
+#else
+    BMK_appendFlag(dst, dstSize, g_targetFlags[0] != '\0', g_targetFlags + 1);
+#endif
+}
+
+/* BMK_displayJsonString() :
+ * displays `str` as a quoted JSON string, escaping quotes, backslashes and control characters */
+static void BMK_displayJsonString(const char* str)
+{
+    DISPLAYRESULT("\"");
+    for ( ; *str; str++) {
+        unsigned char const c = (unsigned char)*str;
+        switch (c)
+        {
+        case '"':  DISPLAYRESULT("\\\""); break;
+        case '\\': DISPLAYRESULT("\\\\"); break;
+        case '\n': DISPLAYRESULT("\\n"); break;
+        case '\r': DISPLAYRESULT("\\r"); break;
+        case '\t': DISPLAYRESULT("\\t"); break;
+        default:
+            if (c < 0x20) DISPLAYRESULT("\\u%04x", c);
+            else DISPLAYRESULT("%c", c);
+        }
+    }
+    DISPLAYRESULT("\"");
+}
+
+/* Result rows of data structure workloads, for --csv and --json :
+ * each field is a string, or a number with `decimals` digits.
+ * BMK_FIELD_ABSENT leaves the CSV cell empty, and omits the JSON key. */
+#define BMK_FIELD_ABSENT (-1)
+
+typedef struct {
+    const char* key;   /* CSV column, JSON key */
+    const char* str;   /* NULL for a number */
+    double num;
+    int decimals;
+} BMK_field;
+
+static void BMK_setStr(BMK_field* field, const char* key, const char* str)
+{
+    field->key = key; field->str = str; field->num = 0.; field->decimals = 0;
+}
+
+static void BMK_setNum(BMK_field* field, const char* key, double num, int decimals)
+{
+    field->key = key; field->str = NULL; field->num = num; field->decimals = decimals;
+}
+
+/* BMK_displayFields() :
+ * one CSV row, preceded by the header when `first`, or one JSON object of the "results" array.
+ * Human output is left to callers. */
+static void BMK_displayFields(const BMK_field* fields, size_t nbFields, int first)
+{
+    size_t i;
+    if (g_outputFormat == BMK_format_csv) {
+        if (first) {
+            for (i=0; i<nbFields; i++) DISPLAYRESULT("%s%s", i ? "," : "", fields[i].key);
+            DISPLAYRESULT("\n");
+        }
+        for (i=0; i<nbFields; i++) {
+            if (i) DISPLAYRESULT(",");
+            if (fields[i].str) DISPLAYRESULT("%s", fields[i].str);
+            else if (fields[i].decimals != BMK_FIELD_ABSENT) DISPLAYRESULT("%.*f", fields[i].decimals, fields[i].num);
+        }
+        DISPLAYRESULT("\n");
+    } else if (g_outputFormat == BMK_format_json) {
+        const char* separator = "";
+        DISPLAYRESULT("%s\n    { ", first ? "" : ",");
+        for (i=0; i<nbFields; i++) {
+            if (!fields[i].str && (fields[i].decimals == BMK_FIELD_ABSENT)) continue;
+            DISPLAYRESULT("%s", separator);
+            separator = ", ";
+            BMK_displayJsonString(fields[i].key);
+            DISPLAYRESULT(": ");
+            if (fields[i].str) BMK_displayJsonString(fields[i].str);
+            else DISPLAYRESULT("%.*f", fields[i].decimals, fields[i].num);
+        }
+        DISPLAYRESULT(" }");
+    }
+}
+
+static void BMK_displayHostItem(const char* key, const char* value, int first)
+{
+    switch (g_outputFormat)
+    {
+    case BMK_format_csv:
+        DISPLAYRESULT("# %s: %s\n", key, value);
+        break;
+    case BMK_format_json:
+        DISPLAYRESULT("%s\n    \"%s\": ", first ? "" : ",", key);
+        BMK_displayJsonString(value);
+        break;
+    case BMK_format_human:
+    default:
+        DISPLAYRESULT("%-14s: %s\n", key, value);
+        break;
+    }
+}
+
+/* BMK_displayHostInfo() :
+ * Describes the host, the build, and the kernels selected by the _auto variants. */
+static void BMK_displayHostInfo(void)
+{
+    char cpuName[64];
+    char cpuFlags[128];
+    char item[128];
+
+    BMK_getCpuName(cpuName, sizeof(cpuName));
+    BMK_getCpuFlags(cpuFlags, sizeof(cpuFlags));
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("{\n  \"host\": {");
+    BMK_displayHostItem("version", PROGRAM_VERSION, 1);
+    BMK_displayHostItem("cpu", cpuName, 0);
+    BMK_displayHostItem("cpu_flags", cpuFlags, 0);
+    BMK_displayHostItem("target_flags", g_targetFlags[0] ? g_targetFlags+1 : "", 0);
+    BMK_displayHostItem("compiler", BMK_COMPILER, 0);
+    sprintf(item, "%i-bits %s", g_nbBits, ENDIAN_NAME);
+    BMK_displayHostItem("architecture", item, 0);
+    sprintf(item, "%.3f", BMK_tscGHz());
+    BMK_displayHostItem("tsc_ghz", item, 0);
+    sprintf(item, "%s (128 bytes), %s (1 MB)",
+            g_kernelNames[XXH32_autoKernel(128)], g_kernelNames[XXH32_autoKernel(1 MB)]);
+    BMK_displayHostItem("xxh32_auto", item, 0);
+    sprintf(item, "%s (128 bytes), %s (1 MB)",
+            g_kernelNames[XXH64_autoKernel(128)], g_kernelNames[XXH64_autoKernel(1 MB)]);
+    BMK_displayHostItem("xxh64_auto", item, 0);
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  },\n");
+}
+
+
+/* ********************************************************
+*  Size sweep
+**********************************************************/
+
+#define SWEEP_DEFAULT_MAX (64 MB)
+
+/* BMK_nextSweepSize() :
+ * log-spaced ladder, with half steps : 1, 2, 3, 4, 6, 8, 12, 16, 24, ... */
+static size_t BMK_nextSweepSize(size_t size)
+{
+    if (size < 2) return size + 1;
+    if ((size & (size-1)) == 0) return size + size/2;
+    return size + size/3;
+}
+
+/* BMK_displaySweepResult() :
+ * `latency` is only reported in latency mode.
+ * `counters` is only reported when not NULL; unavailable values are < 0 */
+static void BMK_displaySweepResult(const BMK_hashCandidate* candidate, size_t size,
+                                   size_t alignment, double nsPerHash, double latency,
+                                   const double* counters, int first)
+{
+    int c;
+
+    double const tscGHz = BMK_tscGHz();
+    double const mbps = ((double)size / (1<<20)) * 1000000000. / nsPerHash;
+    const char* const kernel = candidate->autoKernel ? g_kernelNames[candidate->autoKernel(size)] : "";
+
+    switch (g_outputFormat)
+    {
+    case BMK_format_csv:
+        if (first) {
+            DISPLAYRESULT("size,algorithm,alignment,MBps,ns_per_hash,ref_cycles_per_hash,kernel%s",
+                          g_benchLatency ? ",latency_ns" : "");
+            if (counters) for (c=0; c<BMK_cnt_max; c++) DISPLAYRESULT(",%s", g_counterNames[c]);
+            DISPLAYRESULT("\n");
+        }
+        DISPLAYRESULT("%u,%s,%u,%.2f,%.3f,", (U32)size, candidate->name, (U32)alignment, mbps, nsPerHash);
+        if (tscGHz > 0.) DISPLAYRESULT("%.2f", nsPerHash * tscGHz);
+        DISPLAYRESULT(",%s", kernel);
+        if (g_benchLatency) DISPLAYRESULT(",%.3f", latency);
+        if (counters) for (c=0; c<BMK_cnt_max; c++) {
+            DISPLAYRESULT(",");
+            if (counters[c] >= 0.) DISPLAYRESULT("%.3f", counters[c]);
+        }
+        DISPLAYRESULT("\n");
+        break;
+    case BMK_format_json:
+        DISPLAYRESULT("%s\n    { \"size\": %u, \"algorithm\": ", first ? "" : ",", (U32)size);
+        BMK_displayJsonString(candidate->name);
+        DISPLAYRESULT(", \"alignment\": %u, \"MBps\": %.2f, \"ns_per_hash\": %.3f, \"ref_cycles_per_hash\": ",
+                      (U32)alignment, mbps, nsPerHash);
+        if (tscGHz > 0.) DISPLAYRESULT("%.2f", nsPerHash * tscGHz); else DISPLAYRESULT("null");
+        DISPLAYRESULT(", \"kernel\": ");
+        BMK_displayJsonString(kernel);
+        if (g_benchLatency) DISPLAYRESULT(", \"latency_ns\": %.3f", latency);
+        if (counters) for (c=0; c<BMK_cnt_max; c++) {
+            if (counters[c] >= 0.) DISPLAYRESULT(", \"%s\": %.3f", g_counterNames[c], counters[c]);
+            else DISPLAYRESULT(", \"%s\": null", g_counterNames[c]);
+        }
+        DISPLAYRESULT(" }");
+        break;
+    case BMK_format_human:
+    default:
+        DISPLAYRESULT("%-12s %10u %3u : %10.1f MB/s %12.1f ns/hash",
+                      candidate->name, (U32)size, (U32)alignment, mbps, nsPerHash);
+        if (g_benchLatency) DISPLAYRESULT(" %12.1f ns latency", latency);
+        if (counters && (counters[BMK_cnt_cycles] > 0.) && (counters[BMK_cnt_instructions] >= 0.))
+            DISPLAYRESULT("  IPC %5.2f", counters[BMK_cnt_instructions] / counters[BMK_cnt_cycles]);
+        DISPLAYRESULT("  %s\n", kernel);
+        break;
+    }
+}
+
+/* BMK_sweep() :
+ * Benchmarks all algorithms, aligned and unaligned, over sizes from 1 byte to maxSize.
+ * Each measurement is shorter than in the default benchmark, to keep the full sweep
+ * within a few minutes.
+ * @return : 0 on success, 12 if allocation failed */
+static int BMK_sweep(size_t maxSize)
+{
+    void* const buffer = malloc(maxSize + 16 + 16);
+    const char* const alignedBuffer = (const char*)buffer + 15 - (((size_t)((char*)buffer+15)) & 0xF);
+    int first = 1;
+    size_t size;
+
+    if (!buffer) {
+        DISPLAY("\nError: not enough memory!\n");
+        return 12;
+    }
+    BMK_fillBuffer(buffer, maxSize + 16 + 16);
+
+    BMK_displayHostInfo();
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("  \"results\": [");
+
+    for (size = 1; size <= maxSize; size = BMK_nextSweepSize(size)) {
+        U32 idx;
+        for (idx=0; idx<NB_HASH_CANDIDATES; idx++) {
+            const BMK_hashCandidate* const candidate = g_hashCandidates + idx;
+            size_t const alignments[2] = { 0, candidate->misalign };
+            int a;
+            for (a=0; a<2; a++) {
+                double nsPerHash, latency = 0.;
+                double counters[BMK_cnt_max];
+                DISPLAYLEVEL(2, "\r%70s\r%-12s %10u %3u ...\r", "", candidate->name, (U32)size, (U32)alignments[a]);
+                nsPerHash = BMK_measureHash(candidate->func, NULL, alignedBuffer + alignments[a], size, TIMELOOP_NS / 20, 0);
+                if (g_benchLatency)
+                    latency = BMK_measureHash(candidate->func, NULL, alignedBuffer + alignments[a], size, TIMELOOP_NS / 20, 1);
+                if (g_counters)
+                    BMK_measureCounters(candidate->func, alignedBuffer + alignments[a], size, nsPerHash, counters);
+                DISPLAYLEVEL(2, "\r%70s\r", "");
+                BMK_displaySweepResult(candidate, size, alignments[a], nsPerHash, latency,
+                                       g_counters ? counters : NULL, first);
+                first = 0;
+    }   }   }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+    free(buffer);
+    return 0;
+}
+
+
+/* ********************************************************
+*  Streaming API
+**********************************************************/
+
+#define STREAM_MAX_CHUNK (1 MB)
+
+static size_t g_streamChunkSize = 1;   /* update size used by streaming wrappers */
+
+
+/* state in progress, copied by copyState+digest */
+typedef union {
+    XXH32_state_t  s32;
+    XXH64_state_t  s64;
+    XXH32a_state_t s32a;
+    XXH64a_state_t s64a;
+} BMK_streamState;
+
+#define BMK_STREAM_WRAPPERS(algo, seedType)                                         \
+static U32 local##algo##_stream(const void* buffer, size_t bufferSize, U32 seed)    \
+{                                                                                   \
+    algo##_state_t state;                                                           \
+    const char* p = (const char*)buffer;                                            \
+    const char* const end = p + bufferSize;                                         \
+    algo##_reset(&state, (seedType)seed);                                           \
+    while (p < end) {                                                               \
+        size_t const chunk = MIN(g_streamChunkSize, (size_t)(end - p));             \
+        algo##_update(&state, p, chunk);                                            \
+        p += chunk;                                                                 \
+    }                                                                               \
+    return (U32)algo##_digest(&state);                                              \
+}                                                                                   \
+static U32 local##algo##_createFree(const void* buffer, size_t bufferSize, U32 seed)\
+{                                                                                   \
+    algo##_state_t* const state = algo##_createState();                             \
+    U32 const r = (U32)(size_t)state;                                               \
+    (void)buffer; (void)bufferSize;                                                 \
+    if (state == NULL) return 0;   /* nothing to reset nor free */                  \
+    algo##_reset(state, (seedType)seed);                                            \
+    algo##_freeState(state);                                                        \
+    return r;                                                                       \
+}                                                                                   \
+static void local##algo##_prepareState(void* srcState,                             \
+                                       const void* buffer, size_t bufferSize)       \
+{                                                                                   \
+    algo##_state_t* const src = (algo##_state_t*)srcState;                          \
+    algo##_reset(src, 0);                                                           \
+    algo##_update(src, buffer, MIN(bufferSize, (size_t)100));                       \
+}                                                                                   \
+/* `srcState` : a BMK_streamState prepared by local##algo##_prepareState() */      \
+static U32 local##algo##_copyDigest(const void* srcState, size_t unused, U32 seed)  \
+{                                                                                   \
+    algo##_state_t dst;                                                             \
+    (void)unused; (void)seed;                                                       \
+    algo##_copyState(&dst, (const algo##_state_t*)srcState);                        \
+    return (U32)algo##_digest(&dst);                                                \
+}
+
+BMK_STREAM_WRAPPERS(XXH32, unsigned)
+BMK_STREAM_WRAPPERS(XXH64, unsigned long long)
+BMK_STREAM_WRAPPERS(XXH32a, unsigned)
+BMK_STREAM_WRAPPERS(XXH64a, unsigned long long)
+
+typedef struct {
+    const char*  name;
+    hashFunction oneShot;
+    hashFunction stream;
+    hashFunction createFree;
+    hashFunction copyDigest;
+    void (*prepareState)(void* srcState, const void* buffer, size_t bufferSize);   /* for copyDigest */
+} BMK_streamCandidate;
+
+static const BMK_streamCandidate g_streamCandidates[] = {
+    { "XXH32",  localXXH32,  localXXH32_stream,  localXXH32_createFree,  localXXH32_copyDigest, localXXH32_prepareState },
+    { "XXH64",  localXXH64,  localXXH64_stream,  localXXH64_createFree,  localXXH64_copyDigest, localXXH64_prepareState },
+    { "XXH32a", localXXH32a, localXXH32a_stream, localXXH32a_createFree, localXXH32a_copyDigest, localXXH32a_prepareState },
+    { "XXH64a", localXXH64a, localXXH64a_stream, localXXH64a_createFree, localXXH64a_copyDigest, localXXH64a_prepareState },
+};
+#define NB_STREAM_CANDIDATES ((U32)(sizeof(g_streamCandidates) / sizeof(g_streamCandidates[0])))
+
+/* BMK_displayStreamResult() :
+ * `chunk` : update size, 0 for operations which don't depend on it
+ * `reference` : one-shot time, in ns, to compare against (0 if not applicable) */
+static void BMK_displayStreamResult(const char* algoName, const char* operation, size_t chunk,
+                                    size_t totalSize, double nsPerCall, double reference, int first)
+{
+    double const mbps = ((double)totalSize / (1<<20)) * 1000000000. / nsPerCall;
+    double const ratio = reference > 0. ? nsPerCall / reference : 0.;
+    switch (g_outputFormat)
+    {
+    case BMK_format_csv:
+        if (first) DISPLAYRESULT("algorithm,operation,chunk,total,ns_per_call,MBps,vs_oneshot\n");
+        DISPLAYRESULT("%s,%s,%u,%u,%.3f,%.2f,%.3f\n", algoName, operation, (U32)chunk, (U32)totalSize, nsPerCall, mbps, ratio);
+        break;
+    case BMK_format_json:
+        DISPLAYRESULT("%s\n    { \"algorithm\": ", first ? "" : ",");
+        BMK_displayJsonString(algoName);
+        DISPLAYRESULT(", \"operation\": ");
+        BMK_displayJsonString(operation);
+        DISPLAYRESULT(", \"chunk\": %u, \"total\": %u, \"ns_per_call\": %.3f, \"MBps\": %.2f, \"vs_oneshot\": %.3f }",
+                      (U32)chunk, (U32)totalSize, nsPerCall, mbps, ratio);
+        break;
+    case BMK_format_human:
+    default:
+        if (totalSize) {
+            DISPLAYRESULT("%-7s %-17s %8u : %12.1f ns %10.1f MB/s", algoName, operation, (U32)chunk, nsPerCall, mbps);
+            if (reference > 0.) DISPLAYRESULT("  x%.2f", ratio);
+            DISPLAYRESULT("\n");
+        } else {
+            DISPLAYRESULT("%-7s %-17s %8s : %12.1f ns\n", algoName, operation, "", nsPerCall);
+        }
+        break;
+    }
+}
+
+/* BMK_benchStream() :
+ * Hashes `totalSize` bytes through reset/update/digest, with update sizes from 1 byte to 1 MB,
+ * and compares with the one-shot function on the same input.
+ * Each power of 2 update size is followed by the next size (2^n + 1),
+ * so that chunk boundaries don't match the internal stripe size.
+ * Also measures createState/freeState and copyState (followed by digest).
+ * @return : 0 on success, 12 if allocation failed */
+static int BMK_benchStream(size_t totalSize)
+{
+    void* const buffer = malloc(totalSize + 16);
+    const char* const alignedBuffer = (const char*)buffer + 15 - (((size_t)((char*)buffer+15)) & 0xF);
+    U64 const targetNanos = TIMELOOP_NS / 10;
+    BMK_streamState srcState;
+    int first = 1;
+    U32 idx;
+
+    if (!buffer) {
+        DISPLAY("\nError: not enough memory!\n");
+        return 12;
+    }
+    BMK_fillBuffer(buffer, totalSize + 16);
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("{\n  \"results\": [");
+    else if (g_outputFormat == BMK_format_human) DISPLAYRESULT("Streaming %u bytes \n", (U32)totalSize);
+
+    for (idx=0; idx<NB_STREAM_CANDIDATES; idx++) {
+        const BMK_streamCandidate* const candidate = g_streamCandidates + idx;
+        double const oneShot = BMK_measureHash(candidate->oneShot, NULL, alignedBuffer, totalSize, targetNanos, 0);
+        size_t pow2;
+
+        BMK_displayStreamResult(candidate->name, "one-shot", totalSize, totalSize, oneShot, 0., first);
+        first = 0;
+        for (pow2 = 1; pow2 <= STREAM_MAX_CHUNK && pow2 <= totalSize; pow2 *= 2) {
+            int misaligned;
+            for (misaligned = 0; misaligned <= (pow2 > 1); misaligned++) {
+                double nsPerHash;
+                g_streamChunkSize = pow2 + (size_t)misaligned;
+                DISPLAYLEVEL(2, "\r%70s\r%s update %u ...\r", "", candidate->name, (U32)g_streamChunkSize);
+                nsPerHash = BMK_measureHash(candidate->stream, NULL, alignedBuffer, totalSize, targetNanos, 0);
+                DISPLAYLEVEL(2, "\r%70s\r", "");
+                BMK_displayStreamResult(candidate->name, misaligned ? "update misaligned" : "update",
+                                        g_streamChunkSize, totalSize, nsPerHash, oneShot, 0);
+        }   }
+        BMK_displayStreamResult(candidate->name, "createState+free", 0, 0,
+                                BMK_measureHash(candidate->createFree, NULL, alignedBuffer, 0, targetNanos, 0), 0., 0);
+        candidate->prepareState(&srcState, alignedBuffer, totalSize);
+        BMK_displayStreamResult(candidate->name, "copyState+digest", 0, 0,
+                                BMK_measureHash(candidate->copyDigest, NULL, &srcState, 0, targetNanos, 0), 0., 0);
+    }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+    free(buffer);
+    return 0;
+}
+
+
+/* ********************************************************
+*  Alignment offsets
+**********************************************************/
+
+#define OFFSETS_MAX 64   /* one cache line */
+#define OFFSETS_STREAM_CHUNK (4 KB)
+
+/* BMK_benchOffsets() :
+ * Benchmarks every algorithm, one-shot and streaming (updates of 4 KB),
+ * with input starting at each offset from 0 to 63 of a cache line.
+ * Results are displayed as a table, one row per offset, in MB/s.
+ * @return : 0 on success, 12 if allocation failed */
+static int BMK_benchOffsets(size_t bufferSize)
+{
+    U32 const nbColumns = NB_HASH_CANDIDATES + NB_STREAM_CANDIDATES;
+    void* const buffer = malloc(bufferSize + OFFSETS_MAX + 64);
+    const char* const lineBuffer = (const char*)buffer + 63 - (((size_t)((char*)buffer+63)) & 63);  /* cache line aligned */
+    double* const results = (double*)malloc(nbColumns * OFFSETS_MAX * sizeof(double));   /* ns per hash */
+    char (*names)[64] = (char(*)[64])malloc(nbColumns * sizeof(*names));
+    U64 const targetNanos = TIMELOOP_NS / 20;
+    U32 col, offset;
+
+    if (!buffer || !results || !names) {
+        DISPLAY("\nError: not enough memory!\n");
+        free(buffer); free(results); free(names);
+        return 12;
+    }
+    BMK_fillBuffer(buffer, bufferSize + OFFSETS_MAX + 64);
+    g_streamChunkSize = OFFSETS_STREAM_CHUNK;
+
+    for (col=0; col<nbColumns; col++) {
+        hashFunction h;
+        if (col < NB_HASH_CANDIDATES) {
+            h = g_hashCandidates[col].func;
+            sprintf(names[col], "%.40s", g_hashCandidates[col].name);
+        } else {
+            h = g_streamCandidates[col - NB_HASH_CANDIDATES].stream;
+            sprintf(names[col], "%.40s stream", g_streamCandidates[col - NB_HASH_CANDIDATES].name);
+        }
+        for (offset=0; offset<OFFSETS_MAX; offset++) {
+            DISPLAYLEVEL(2, "\r%70s\r%s +%u ...\r", "", names[col], offset);
+            results[col*OFFSETS_MAX + offset] = BMK_measureHash(h, NULL, lineBuffer + offset, bufferSize, targetNanos, 0);
+    }   }
+    DISPLAYLEVEL(2, "\r%70s\r", "");
+
+#define BMK_OFFSET_MBPS(col, offset) (((double)bufferSize / (1<<20)) * 1000000000. / results[(col)*OFFSETS_MAX + (offset)])
+    switch (g_outputFormat)
+    {
+    case BMK_format_csv:
+        DISPLAYRESULT("algorithm,offset,size,MBps,ns_per_hash,vs_offset0\n");
+        for (col=0; col<nbColumns; col++)
+            for (offset=0; offset<OFFSETS_MAX; offset++)
+                DISPLAYRESULT("%s,%u,%u,%.2f,%.3f,%.3f\n", names[col], offset, (U32)bufferSize,
+                              BMK_OFFSET_MBPS(col, offset), results[col*OFFSETS_MAX + offset],
+                              BMK_OFFSET_MBPS(col, offset) / BMK_OFFSET_MBPS(col, 0));
+        break;
+    case BMK_format_json:
+        DISPLAYRESULT("{\n  \"size\": %u,\n  \"results\": [", (U32)bufferSize);
+        for (col=0; col<nbColumns; col++)
+            for (offset=0; offset<OFFSETS_MAX; offset++) {
+                DISPLAYRESULT("%s\n    { \"algorithm\": ", (col|offset) ? "," : "");
+                BMK_displayJsonString(names[col]);
+                DISPLAYRESULT(", \"offset\": %u, \"MBps\": %.2f, \"ns_per_hash\": %.3f, \"vs_offset0\": %.3f }",
+                              offset, BMK_OFFSET_MBPS(col, offset), results[col*OFFSETS_MAX + offset],
+                              BMK_OFFSET_MBPS(col, offset) / BMK_OFFSET_MBPS(col, 0));
+            }
+        DISPLAYRESULT("\n  ]\n}\n");
+        break;
+    case BMK_format_human:
+    default:
+        DISPLAYRESULT("MB/s, input of %u bytes starting at cache line offset : \n", (U32)bufferSize);
+        DISPLAYRESULT("offset");
+        for (col=0; col<nbColumns; col++) DISPLAYRESULT(" %13.13s", names[col]);
+        DISPLAYRESULT("\n");
+        for (offset=0; offset<OFFSETS_MAX; offset++) {
+            DISPLAYRESULT("%6u", offset);
+            for (col=0; col<nbColumns; col++) DISPLAYRESULT(" %13.1f", BMK_OFFSET_MBPS(col, offset));
+            DISPLAYRESULT("\n");
+        }
+        /* worst offset, relative to offset 0 */
+        DISPLAYRESULT("worst ");
+        for (col=0; col<nbColumns; col++) {
+            double worst = 1.;
+            for (offset=1; offset<OFFSETS_MAX; offset++)
+                worst = MIN(worst, BMK_OFFSET_MBPS(col, offset) / BMK_OFFSET_MBPS(col, 0));
+            DISPLAYRESULT(" %12.1f%%", worst * 100.);
+        }
+        DISPLAYRESULT("\n");
+        break;
+    }
+#undef BMK_OFFSET_MBPS
+
+    free(buffer);
+    free(results);
+    free(names);
+    return 0;
+}
+
+
+/* ********************************************************
+*  Cold cache
+**********************************************************/
+
+#define COLD_POOL_SIZE (256 MB)   /* expected to exceed the last level cache */
+
+typedef enum { BMK_cold_hot, BMK_cold_pool, BMK_cold_fresh, BMK_cold_flush, BMK_cold_max } BMK_cold_e;
+static const char* const g_coldNames[BMK_cold_max] = { "hot", "pool", "fresh", "flush" };
+
+#if BMK_HAS_CPUID   /* x86 with GNU inline assembly */
+#  define BMK_HAS_CLFLUSH 1
+static void BMK_flushBuffer(const void* buffer, size_t size)
+{
+    const char* p = (const char*)((size_t)buffer & ~(size_t)63);
+    const char* const end = (const char*)buffer + size;
+    for ( ; p < end; p += 64)
+        __asm__ __volatile__("clflush (%0)" : : "r" (p) : "memory");
+    __asm__ __volatile__("mfence" : : : "memory");
+}
+#else
+#  define BMK_HAS_CLFLUSH 0
+#endif
+
+/* BMK_measureScattered() :
+ * same as BMK_measureHash(), but each call hashes the next buffer of `buffers`,
+ * so that input is never found in cache when the pool is large enough.
+ * @return : fastest round, in nanoseconds per hash */
+static double BMK_measureScattered(hashFunction h, const char* const* buffers, U32 nbBuffers,
+                                   size_t bufferSize, U64 targetNanos)
+{
+    U32 nbh_perIteration = (U32)((300 MB) / (bufferSize+1)) + 1;
+    U32 iterationNb;
+    U32 next = 0;
+    double fastestH = 100000000.;
+
+    if (g_nbIterations<1) g_nbIterations=1;
+    nbh_perIteration = (U32)(((U64)nbh_perIteration * targetNanos) / TIMELOOP_NS) + 1;
+    for (iterationNb = 1; iterationNb <= g_nbIterations; iterationNb++) {
+        U32 r = 0;
+        BMK_time_t const tStart = BMK_getTime();
+        U32 i;
+        for (i=0; i<nbh_perIteration; i++) {
+            r += h(buffers[next], bufferSize, i);
+            if (++next == nbBuffers) next = 0;
+        }
+        if (r==0) DISPLAYLEVEL(3,".\r");  /* do something with r to avoid compiler "optimizing" away hash function */
+        {   U64 const nanos = BMK_clockSpanNano(tStart);
+            double const nsPerHash = (double)(nanos ? nanos : 1) / nbh_perIteration;
+            if (nsPerHash < fastestH) fastestH = nsPerHash;
+        }
+        nbh_perIteration = (U32)((double)targetNanos / fastestH) + 1;
+    }
+    return fastestH;
+}
+
+#if BMK_HAS_CLFLUSH
+/* BMK_measureFlushed() :
+ * flushes `buffer` from all cache levels before each call.
+ * Only hashing is timed, minus the cost of reading the clock.
+ * @return : fastest round, in nanoseconds per hash */
+static double BMK_measureFlushed(hashFunction h, const void* buffer, size_t bufferSize, U64 targetNanos)
+{
+    U64 clockOverhead = (U64)-1;
+    U32 iterationNb;
+    double fastestH = 100000000.;
+
+    {   int n;
+        for (n=0; n<100; n++) {
+            BMK_time_t const t = BMK_getTime();
+            U64 const span = BMK_clockSpanNano(t);
+            if (span < clockOverhead) clockOverhead = span;
+    }   }
+
+    if (g_nbIterations<1) g_nbIterations=1;
+    for (iterationNb = 1; iterationNb <= g_nbIterations; iterationNb++) {
+        BMK_time_t const roundStart = BMK_getTime();
+        U64 hashNanos = 0;
+        U32 nbHashes = 0;
+        U32 r = 0;
+        do {
+            BMK_time_t tStart;
+            U64 span;
+            BMK_flushBuffer(buffer, bufferSize);
+            tStart = BMK_getTime();
+            r += h(buffer, bufferSize, nbHashes);
+            span = BMK_clockSpanNano(tStart);
+            hashNanos += (span > clockOverhead) ? span - clockOverhead : 0;
+            nbHashes++;
+        } while (BMK_clockSpanNano(roundStart) < targetNanos);
+        if (r==0) DISPLAYLEVEL(3,".\r");  /* do something with r to avoid compiler "optimizing" away hash function */
+        {   double const nsPerHash = (double)(hashNanos ? hashNanos : 1) / nbHashes;
+            if (nsPerHash < fastestH) fastestH = nsPerHash;
+    }   }
+    return fastestH;
+}
+#endif
+
+/* BMK_measureCold() :
+ * hot   : same buffer at each call (default benchmark)
+ * pool  : buffers of a pool larger than the last level cache, in random order
+ * fresh : consecutive regions of a large area, as data streamed in from a device
+ * flush : same buffer, flushed from cache before each call (x86 only)
+ * @return : nanoseconds per hash, or 0 if mode is not supported */
+static double BMK_measureCold(BMK_cold_e mode, hashFunction h, const char* const* poolBuffers,
+                              const char* const* freshBuffers, U32 nbBuffers,
+                              size_t bufferSize, U64 targetNanos)
+{
+    if (mode == BMK_cold_hot)
+        return BMK_measureHash(h, NULL, poolBuffers[0], bufferSize, targetNanos, 0);
+    if (mode == BMK_cold_pool)
+        return BMK_measureScattered(h, poolBuffers, nbBuffers, bufferSize, targetNanos);
+    if (mode == BMK_cold_fresh)
+        return BMK_measureScattered(h, freshBuffers, nbBuffers, bufferSize, targetNanos);
+#if BMK_HAS_CLFLUSH
+    return BMK_measureFlushed(h, poolBuffers[0], bufferSize, targetNanos);
+#else
+    return 0.;
+#endif
+}
+
+/* BMK_displayColdResult() :
+ * `roofNs` : time of the fastest reference (memcpy or read) in the same mode */
+static void BMK_displayColdResult(const char* hName, BMK_cold_e mode, size_t bufferSize,
+                                  double nsPerHash, double roofNs, int first)
+{
+    double const mbps = ((double)bufferSize / (1<<20)) * 1000000000. / nsPerHash;
+    double const roofline = roofNs > 0. ? roofNs / nsPerHash : 0.;
+    switch (g_outputFormat)
+    {
+    case BMK_format_csv:
+        if (first) DISPLAYRESULT("algorithm,cache,size,MBps,ns_per_hash,vs_roofline\n");
+        DISPLAYRESULT("%s,%s,%u,%.2f,%.3f,%.3f\n", hName, g_coldNames[mode], (U32)bufferSize, mbps, nsPerHash, roofline);
+        break;
+    case BMK_format_json:
+        DISPLAYRESULT("%s\n    { \"algorithm\": ", first ? "" : ",");
+        BMK_displayJsonString(hName);
+        DISPLAYRESULT(", \"cache\": ");
+        BMK_displayJsonString(g_coldNames[mode]);
+        DISPLAYRESULT(", \"size\": %u, \"MBps\": %.2f, \"ns_per_hash\": %.3f, \"vs_roofline\": %.3f }",
+                      (U32)bufferSize, mbps, nsPerHash, roofline);
+        break;
+    case BMK_format_human:
+    default:
+        DISPLAYRESULT("%-20s %-5s %9u : %10.1f MB/s %12.1f ns/hash  %5.1f%% of roofline\n",
+                      hName, g_coldNames[mode], (U32)bufferSize, mbps, nsPerHash, roofline * 100.);
+        break;
+    }
+}
+
+/* BMK_benchCold() :
+ * Benchmarks all algorithms (or the one selected by specificTest) with input
+ * in cache and out of cache, next to memcpy and read-only bandwidth measured the same way.
+ * `onlyMode` : BMK_cold_max to run all modes, or a single mode.
+ * @return : 0 on success, error code otherwise */
+static int BMK_benchCold(size_t bufferSize, U32 specificTest, BMK_cold_e onlyMode)
+{
+    size_t const poolStride = ((bufferSize + 64 + 4095) & ~(size_t)4095) + 64;   /* +64 : avoids 4K aliasing between buffers */
+    size_t const freshStride = (bufferSize + 63) & ~(size_t)63;
+    U32 const nbBuffers = (U32)MAX(2, COLD_POOL_SIZE / poolStride);
+    U64 const targetNanos = TIMELOOP_NS / 10;
+    char* const pool = (char*)malloc((size_t)nbBuffers * poolStride + 64 + 16);
+    char* const fresh = (char*)malloc((size_t)nbBuffers * freshStride + 64 + 16);
+    const char** const poolBuffers = (const char**)malloc(nbBuffers * sizeof(char*));
+    const char** const freshBuffers = (const char**)malloc(nbBuffers * sizeof(char*));
+    int first = 1;
+    U32 idx;
+
+    g_memcpyDst = (BYTE*)malloc(bufferSize + 16);
+    if (!pool || !fresh || !poolBuffers || !freshBuffers || !g_memcpyDst) {
+        DISPLAY("\nError: not enough memory!\n");
+        free(pool); free(fresh); free((void*)poolBuffers); free((void*)freshBuffers);
+        free(g_memcpyDst); g_memcpyDst = NULL;
+        return 12;
+    }
+    if (specificTest > 2*NB_HASH_CANDIDATES) {
+        DISPLAY("benchmark mode invalid \n");
+        free(pool); free(fresh); free((void*)poolBuffers); free((void*)freshBuffers);
+        free(g_memcpyDst); g_memcpyDst = NULL;
+        return 1;
+    }
+    BMK_fillBuffer(pool, (size_t)nbBuffers * poolStride + 64 + 16);
+    BMK_fillBuffer(fresh, (size_t)nbBuffers * freshStride + 64 + 16);
+    {   char* const alignedPool = pool + 15 - (((size_t)(pool+15)) & 0xF);
+        char* const alignedFresh = fresh + 15 - (((size_t)(fresh+15)) & 0xF);
+        U32 rand32 = 2654435761U;
+        U32 n;
+        for (n=0; n<nbBuffers; n++) {
+            poolBuffers[n] = alignedPool + (size_t)n * poolStride;
+            freshBuffers[n] = alignedFresh + (size_t)n * freshStride;
+        }
+        for (n=nbBuffers-1; n>0; n--) {   /* random order defeats prefetching across calls */
+            U32 j;
+            const char* tmp;
+            rand32 = rand32 * 1103515245U + 12345U;
+            j = (U32)(((U64)(rand32 >> 1) * (n+1)) >> 31);
+            tmp = poolBuffers[n]; poolBuffers[n] = poolBuffers[j]; poolBuffers[j] = tmp;
+    }   }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("{\n  \"results\": [");
+    else if (g_outputFormat == BMK_format_human)
+        DISPLAYRESULT("Input of %u bytes, pool of %u MB \n", (U32)bufferSize, (U32)(((U64)nbBuffers * poolStride) >> 20));
+
+    {   int m;
+        for (m=0; m<BMK_cold_max; m++) {
+            BMK_cold_e const mode = (BMK_cold_e)m;
+            double readNs, copyNs, roofNs;
+            if ((onlyMode != BMK_cold_max) && (mode != onlyMode)) continue;
+            if ((mode == BMK_cold_flush) && !BMK_HAS_CLFLUSH) {
+                DISPLAYLEVEL(2, "flush mode requires clflush (x86), skipped \n");
+                continue;
+            }
+            /* roofline first : the fastest an algorithm could possibly go in this mode */
+            DISPLAYLEVEL(2, "\r%70s\rread %s ...\r", "", g_coldNames[mode]);
+            readNs = BMK_measureCold(mode, BMK_readRef, poolBuffers, freshBuffers, nbBuffers, bufferSize, targetNanos);
+            DISPLAYLEVEL(2, "\r%70s\rmemcpy %s ...\r", "", g_coldNames[mode]);
+            copyNs = BMK_measureCold(mode, BMK_memcpyRef, poolBuffers, freshBuffers, nbBuffers, bufferSize, targetNanos);
+            roofNs = MIN(readNs, copyNs);   /* libc memcpy may use wider loads than the read loop */
+            DISPLAYLEVEL(2, "\r%70s\r", "");
+            BMK_displayColdResult("read", mode, bufferSize, readNs, roofNs, first);
+            BMK_displayColdResult("memcpy", mode, bufferSize, copyNs, roofNs, 0);
+            first = 0;
+
+            for (idx=0; idx<NB_HASH_CANDIDATES; idx++) {
+                const BMK_hashCandidate* const candidate = g_hashCandidates + idx;
+                int unaligned;
+                for (unaligned=0; unaligned<2; unaligned++) {
+                    char hName[64];
+                    double nsPerHash;
+                    if ((specificTest != 0) && (specificTest != 2*idx+1+(U32)unaligned)) continue;
+                    sprintf(hName, "%.40s%s", candidate->name, unaligned ? " unaligned" : "");
+                    DISPLAYLEVEL(2, "\r%70s\r%s %s ...\r", "", hName, g_coldNames[mode]);
+                    if (unaligned) {   /* shift all buffers */
+                        U32 n;
+                        for (n=0; n<nbBuffers; n++) { poolBuffers[n] += candidate->misalign; freshBuffers[n] += candidate->misalign; }
+                    }
+                    nsPerHash = BMK_measureCold(mode, candidate->func, poolBuffers, freshBuffers, nbBuffers, bufferSize, targetNanos);
+                    if (unaligned) {
+                        U32 n;
+                        for (n=0; n<nbBuffers; n++) { poolBuffers[n] -= candidate->misalign; freshBuffers[n] -= candidate->misalign; }
+                    }
+                    DISPLAYLEVEL(2, "\r%70s\r", "");
+                    BMK_displayColdResult(hName, mode, bufferSize, nsPerHash, roofNs, 0);
+    }   }   }   }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+    free(pool); free(fresh); free((void*)poolBuffers); free((void*)freshBuffers);
+    free(g_memcpyDst); g_memcpyDst = NULL;
+    return 0;
+}
+
+
+/* ********************************************************
+*  File I/O
+**********************************************************/
+
+#define IO_BLOCK_SIZE (64 KB)       /* same as BMK_hash() */
+#define IO_DIRECT_BLOCK_SIZE (1 MB)
+#define IO_DIRECT_ALIGNMENT 4096
+
+typedef enum { BMK_io_buffered, BMK_io_mmap, BMK_io_direct, BMK_io_max } BMK_ioMethod_e;
+static const char* const g_ioMethodNames[BMK_io_max] = { "buffered", "mmap", "direct" };
+
+typedef struct {
+    algoType algo;
+    XXH32_state_t  state32;
+    XXH64_state_t  state64;
+    XXH32a_state_t state32a;
+    XXH64a_state_t state64a;
+} BMK_ioHasher;
+
+static void BMK_ioReset(BMK_ioHasher* hasher)
+{
+    switch (hasher->algo)
+    {
+    case algo_xxh32:  (void)XXH32_reset(&hasher->state32, XXHSUM32_DEFAULT_SEED); break;
+    case algo_xxh32a: (void)XXH32a_reset(&hasher->state32a, XXHSUM32_DEFAULT_SEED); break;
+    case algo_xxh64:  (void)XXH64_reset(&hasher->state64, XXHSUM64_DEFAULT_SEED); break;
+    case algo_xxh64a: (void)XXH64a_reset(&hasher->state64a, XXHSUM64_DEFAULT_SEED); break;
+    default: break;
+    }
+}
+
+static void BMK_ioUpdate(BMK_ioHasher* hasher, const void* buffer, size_t size)
+{
+    switch (hasher->algo)
+    {
+    case algo_xxh32:  (void)XXH32_update(&hasher->state32, buffer, size); break;
+    case algo_xxh32a: (void)XXH32a_update(&hasher->state32a, buffer, size); break;
+    case algo_xxh64:  (void)XXH64_update(&hasher->state64, buffer, size); break;
+    case algo_xxh64a: (void)XXH64a_update(&hasher->state64a, buffer, size); break;
+    default: break;
+    }
+}
+
+static U64 BMK_ioDigest(const BMK_ioHasher* hasher)
+{
+    switch (hasher->algo)
+    {
+    case algo_xxh32:  return XXH32_digest(&hasher->state32);
+    case algo_xxh32a: return XXH32a_digest(&hasher->state32a);
+    case algo_xxh64:  return XXH64_digest(&hasher->state64);
+    case algo_xxh64a: return XXH64a_digest(&hasher->state64a);
+    default: return 0;
+    }
+}
+
+typedef struct {
+    U64 bytes;
+    U64 ioNanos;     /* open, read / map, close */
+    U64 hashNanos;   /* reset, update, digest */
+    U64 digest;
+} BMK_ioResult;
+
+/* BMK_ioFile() :
+ * hashes one file, timing I/O syscalls and hashing separately.
+ * I/O errors are displayed here.
+ * @return : 0 on success, 1 on I/O error, 2 if method is not supported */
+static int BMK_ioFile(BMK_ioResult* result, BMK_ioMethod_e method, const char* fileName,
+                      BMK_ioHasher* hasher, void* buffer)
+{
+    BMK_time_t t;
+    memset(result, 0, sizeof(*result));
+
+    t = BMK_getTime();
+    BMK_ioReset(hasher);
+    result->hashNanos += BMK_clockSpanNano(t);
+
+    if (method == BMK_io_buffered) {
+        FILE* inFile;
+        size_t readSize;
+        t = BMK_getTime();
+        inFile = fopen(fileName, "rb");
+        result->ioNanos += BMK_clockSpanNano(t);
+        if (inFile == NULL) {
+            DISPLAYLEVEL(1, "Could not open %s: %s \n", fileName, strerror(errno));
+            return 1;
+        }
+        do {
+            t = BMK_getTime();
+            readSize = fread(buffer, 1, IO_BLOCK_SIZE, inFile);
+            result->ioNanos += BMK_clockSpanNano(t);
+            t = BMK_getTime();
+            BMK_ioUpdate(hasher, buffer, readSize);
+            result->hashNanos += BMK_clockSpanNano(t);
+            result->bytes += readSize;
+        } while (readSize);
+        if (ferror(inFile)) {
+            DISPLAYLEVEL(1, "Error reading %s: %s \n", fileName, strerror(errno));
+            fclose(inFile);
+            return 1;
+        }
+        t = BMK_getTime();
+        fclose(inFile);
+        result->ioNanos += BMK_clockSpanNano(t);
+    } else {
+#if BMK_HAS_MMAP
+        int flags = O_RDONLY;
+        int fd;
+        if (method == BMK_io_direct) {
+#  ifdef O_DIRECT
+            flags |= O_DIRECT;
+#  else
+            return 2;
+#  endif
+        }
+        t = BMK_getTime();
+        fd = open(fileName, flags);
+        result->ioNanos += BMK_clockSpanNano(t);
+        if (fd < 0) {
+            if ((method == BMK_io_direct) && (errno == EINVAL)) return 2;
+            DISPLAYLEVEL(1, "Could not open %s: %s \n", fileName, strerror(errno));
+            return 1;
+        }
+
+        if (method == BMK_io_mmap) {
+            struct stat st;
+            void* map;
+            t = BMK_getTime();
+            if (fstat(fd, &st) != 0) {
+                DISPLAYLEVEL(1, "Could not stat %s: %s \n", fileName, strerror(errno));
+                close(fd);
+                return 1;
+            }
+            if (st.st_size <= 0) {
+                DISPLAYLEVEL(1, "Could not map %s: empty or not a regular file \n", fileName);
+                close(fd);
+                return 1;
+            }
+            map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE | BMK_MAP_POPULATE, fd, 0);
+            result->ioNanos += BMK_clockSpanNano(t);
+            if (map == MAP_FAILED) {
+                DISPLAYLEVEL(1, "Could not map %s: %s \n", fileName, strerror(errno));
+                close(fd);
+                return 1;
+            }
+            t = BMK_getTime();
+            BMK_ioUpdate(hasher, map, (size_t)st.st_size);
+            result->hashNanos += BMK_clockSpanNano(t);
+            result->bytes = (U64)st.st_size;
+            t = BMK_getTime();
+            munmap(map, (size_t)st.st_size);
+            result->ioNanos += BMK_clockSpanNano(t);
+        } else {   /* O_DIRECT : aligned buffer, aligned sizes */
+            ssize_t readSize;
+            do {
+                t = BMK_getTime();
+                readSize = read(fd, buffer, IO_DIRECT_BLOCK_SIZE);
+                result->ioNanos += BMK_clockSpanNano(t);
+                if (readSize < 0) {
+                    int const ioError = (errno == EINVAL) ? 2 : 1;
+                    if (ioError == 1) DISPLAYLEVEL(1, "Error reading %s: %s \n", fileName, strerror(errno));
+                    close(fd);
+                    return ioError;
+                }
+                t = BMK_getTime();
+                BMK_ioUpdate(hasher, buffer, (size_t)readSize);
+                result->hashNanos += BMK_clockSpanNano(t);
+                result->bytes += (U64)readSize;
+            } while (readSize > 0);
+        }
+        t = BMK_getTime();
+        close(fd);
+        result->ioNanos += BMK_clockSpanNano(t);
+#else
+        (void)fileName;
+        return 2;
+#endif
+    }
+
+    t = BMK_getTime();
+    result->digest = BMK_ioDigest(hasher);
+    result->hashNanos += BMK_clockSpanNano(t);
+    return 0;
+}
+
+static void BMK_displayIOResult(const char* fileName, BMK_ioMethod_e method, const BMK_ioResult* r, int first)
+{
+    double const totalSeconds = (double)(r->ioNanos + r->hashNanos) / 1000000000.;
+    double const mbps = ((double)r->bytes / (1<<20)) / (totalSeconds > 0. ? totalSeconds : 1e-9);
+    double const ioShare = (double)r->ioNanos / (double)((r->ioNanos + r->hashNanos) ? (r->ioNanos + r->hashNanos) : 1);
+    switch (g_outputFormat)
+    {
+    case BMK_format_csv:
+        if (first) DISPLAYRESULT("file,method,bytes,io_ms,hash_ms,MBps,io_share\n");
+        DISPLAYRESULT("%s,%s,%llu,%.3f,%.3f,%.2f,%.3f\n", fileName, g_ioMethodNames[method], (unsigned long long)r->bytes,
+                      (double)r->ioNanos / 1000000., (double)r->hashNanos / 1000000., mbps, ioShare);
+        break;
+    case BMK_format_json:
+        DISPLAYRESULT("%s\n    { \"file\": ", first ? "" : ",");
+        BMK_displayJsonString(fileName);
+        DISPLAYRESULT(", \"method\": ");
+        BMK_displayJsonString(g_ioMethodNames[method]);
+        DISPLAYRESULT(", \"bytes\": %llu, \"io_ms\": %.3f, \"hash_ms\": %.3f, \"MBps\": %.2f, \"io_share\": %.3f }",
+                      (unsigned long long)r->bytes,
+                      (double)r->ioNanos / 1000000., (double)r->hashNanos / 1000000., mbps, ioShare);
+        break;
+    case BMK_format_human:
+    default:
+        DISPLAYRESULT("%-24.24s %-8s : %12llu bytes, I/O %9.2f ms, hash %9.2f ms, %8.1f MB/s (%4.1f%% I/O)\n",
+                      fileName, g_ioMethodNames[method], (unsigned long long)r->bytes,
+                      (double)r->ioNanos / 1000000., (double)r->hashNanos / 1000000., mbps, ioShare * 100.);
+        break;
+    }
+}
+
+/* BMK_benchIO() :
+ * Hashes each file through the real file path, with each available read method,
+ * once, reporting time spent in I/O syscalls and in hashing separately.
+ * Files are not evicted from the page cache between methods :
+ * only the first method may read from the device.
+ * With mmap, pages are populated at map time when possible (Linux),
+ * otherwise page faults are accounted as hash time.
+ * @return : 0 on success, error code otherwise */
+static int BMK_benchIO(const char** fileNamesTable, int nbFiles, algoType algo)
+{
+    void* const allocation = malloc(IO_DIRECT_BLOCK_SIZE + IO_DIRECT_ALIGNMENT);
+    void* const buffer = (char*)allocation + (IO_DIRECT_ALIGNMENT-1) - (((size_t)allocation + IO_DIRECT_ALIGNMENT-1) & (IO_DIRECT_ALIGNMENT-1));
+    BMK_ioHasher hasher;
+    int result = 0;
+    int first = 1;
+    int m;
+
+    if (!allocation) {
+        DISPLAY("\nError: not enough memory!\n");
+        return 12;
+    }
+    hasher.algo = algo;
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("{\n  \"results\": [");
+
+    for (m=0; m<BMK_io_max; m++) {
+        BMK_ioMethod_e const method = (BMK_ioMethod_e)m;
+        BMK_ioResult total;
+        U64 refDigest = 0;
+        int fileIdx;
+        memset(&total, 0, sizeof(total));
+        for (fileIdx=0; fileIdx<nbFiles; fileIdx++) {
+            const char* const fileName = fileNamesTable[fileIdx];
+            BMK_ioResult r;
+            int const ioError = BMK_ioFile(&r, method, fileName, &hasher, buffer);
+            if (ioError == 2) {
+                DISPLAYLEVEL(2, "%s : method not supported on this platform or file system \n", g_ioMethodNames[method]);
+                break;
+            }
+            if (ioError) {   /* already displayed */
+                result = 1;
+                continue;
+            }
+            BMK_displayIOResult(fileName, method, &r, first);
+            first = 0;
+            total.bytes += r.bytes;
+            total.ioNanos += r.ioNanos;
+            total.hashNanos += r.hashNanos;
+            refDigest ^= r.digest;
+        }
+        if (refDigest == 0) DISPLAYLEVEL(3, ".\r");  /* consume digests */
+        if ((nbFiles > 1) && (fileIdx == nbFiles))
+            BMK_displayIOResult("(all files)", method, &total, first);
+    }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+    free(allocation);
+    return result;
+}
+
+
+/* ********************************************************
+*  Multi-threaded scaling
+**********************************************************/
+
+#define THREADS_CACHE_SIZE (32 KB)   /* per thread, expected to stay in L1/L2 */
+#define THREADS_DRAM_SIZE  (32 MB)   /* per thread, expected to exceed the last level cache */
+#define THREADS_MAX_MEMORY ((size_t)1 << (sizeof(size_t) > 4 ? 34 : 30))   /* all private buffers */
+
+#if BMK_HAS_THREADS
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    U32 nbReady;
+    U32 go;
+} BMK_startLine;
+
+typedef struct {
+    BMK_startLine* startLine;
+    hashFunction h;
+    const void* buffer;
+    size_t bufferSize;
+    U64 targetNanos;
+    U32 cpuId;
+    U64 bytes;       /* result */
+    U64 nanos;       /* result */
+    U32 checksum;    /* result, prevents the compiler from skipping hash calls */
+} BMK_threadJob;
+
+/* BMK_pinThread() :
+ * pins calling thread to the `cpuId`-th CPU this process is allowed to run on.
+ * Does nothing on systems without an affinity API. */
+static void BMK_pinThread(U32 cpuId)
+{
+#if BMK_HAS_AFFINITY
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        int const nbAllowed = CPU_COUNT(&allowed);
+        int target = (int)(cpuId % (U32)(nbAllowed ? nbAllowed : 1));
+        int cpu;
+        for (cpu=0; cpu<CPU_SETSIZE; cpu++) {
+            if (!CPU_ISSET(cpu, &allowed)) continue;
+            if (target-- == 0) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+                break;
+    }   }   }
+#else
+    (void)cpuId;
+#endif
+}
+
+static void* BMK_threadMain(void* arg)
+{
+    BMK_threadJob* const job = (BMK_threadJob*)arg;
+    U32 const batch = (U32)((256 KB) / (job->bufferSize + 1)) + 1;   /* hashes between clock reads */
+    U32 r = 0;
+    U64 nbHashes = 0;
+    U64 nanos;
+    BMK_time_t tStart;
+
+    BMK_pinThread(job->cpuId);
+
+    /* wait for all threads to be ready */
+    pthread_mutex_lock(&job->startLine->mutex);
+    job->startLine->nbReady++;
+    pthread_cond_broadcast(&job->startLine->cond);
+    while (!job->startLine->go)
+        pthread_cond_wait(&job->startLine->cond, &job->startLine->mutex);
+    pthread_mutex_unlock(&job->startLine->mutex);
+
+    tStart = BMK_getTime();
+    do {
+        U32 i;
+        for (i=0; i<batch; i++)
+            r += job->h(job->buffer, job->bufferSize, i);
+        nbHashes += batch;
+        nanos = BMK_clockSpanNano(tStart);
+    } while (nanos < job->targetNanos);
+
+    job->bytes = nbHashes * job->bufferSize;
+    job->nanos = nanos ? nanos : 1;
+    job->checksum = r;
+    return NULL;
+}
+
+typedef struct {
+    double aggregate;    /* GB/s, all threads */
+    double perThread;    /* GB/s, average */
+    double minThread;    /* GB/s, slowest thread */
+} BMK_threadResult;
+
+/* BMK_runThreads() :
+ * runs `nbThreads` threads, hashing `buffers[t]` concurrently for about targetNanos.
+ * @return : 0 on success, 1 if threads could not be created */
+static int BMK_runThreads(BMK_threadResult* result, hashFunction h,
+                          const void* const* buffers, size_t bufferSize,
+                          U32 nbThreads, U64 targetNanos)
+{
+    BMK_startLine startLine;
+    BMK_threadJob* const jobs = (BMK_threadJob*)calloc(nbThreads, sizeof(BMK_threadJob));
+    pthread_t* const threads = (pthread_t*)calloc(nbThreads, sizeof(pthread_t));
+    U32 t, nbStarted = 0;
+    U64 totalBytes = 0, maxNanos = 0;
+    int error = 0;
+
+    memset(result, 0, sizeof(*result));
+    if (!jobs || !threads) { free(jobs); free(threads); return 1; }
+    pthread_mutex_init(&startLine.mutex, NULL);
+    pthread_cond_init(&startLine.cond, NULL);
+    startLine.nbReady = 0;
+    startLine.go = 0;
+
+    for (t=0; t<nbThreads; t++) {
+        jobs[t].startLine = &startLine;
+        jobs[t].h = h;
+        jobs[t].buffer = buffers[t];
+        jobs[t].bufferSize = bufferSize;
+        jobs[t].targetNanos = targetNanos;
+        jobs[t].cpuId = t;
+        if (pthread_create(&threads[t], NULL, BMK_threadMain, jobs+t)) { error = 1; break; }
+        nbStarted++;
+    }
+
+    /* release all threads at once */
+    pthread_mutex_lock(&startLine.mutex);
+    while (startLine.nbReady < nbStarted)
+        pthread_cond_wait(&startLine.cond, &startLine.mutex);
+    startLine.go = 1;
+    pthread_cond_broadcast(&startLine.cond);
+    pthread_mutex_unlock(&startLine.mutex);
+
+    for (t=0; t<nbStarted; t++) pthread_join(threads[t], NULL);
+
+    if (!error) {
+        result->minThread = 1e30;
+        for (t=0; t<nbThreads; t++) {
+            double const gbps = (double)jobs[t].bytes / (double)jobs[t].nanos;   /* bytes per ns == GB/s */
+            totalBytes += jobs[t].bytes;
+            if (jobs[t].nanos > maxNanos) maxNanos = jobs[t].nanos;
+            result->perThread += gbps / nbThreads;
+            if (gbps < result->minThread) result->minThread = gbps;
+            if (jobs[t].checksum==0) DISPLAYLEVEL(3,".\r");
+        }
+        result->aggregate = (double)totalBytes / (double)maxNanos;
+    }
+
+    pthread_cond_destroy(&startLine.cond);
+    pthread_mutex_destroy(&startLine.mutex);
+    free(threads);
+    free(jobs);
+    return error;
+}
+
+static void BMK_displayThreadResult(const char* hName, U32 nbThreads, const char* mode,
+                                    size_t bufferSize, const BMK_threadResult* r,
+                                    double singleThread, int first)
+{
+    double const efficiency = singleThread > 0. ? r->aggregate / (singleThread * nbThreads) : 0.;
+    switch (g_outputFormat)
+    {
+    case BMK_format_csv:
+        if (first) DISPLAYRESULT("algorithm,threads,buffer,size,aggregate_GBps,per_thread_GBps,min_thread_GBps,efficiency\n");
+        DISPLAYRESULT("%s,%u,%s,%u,%.3f,%.3f,%.3f,%.3f\n", hName, nbThreads, mode, (U32)bufferSize,
+                      r->aggregate, r->perThread, r->minThread, efficiency);
+        break;
+    case BMK_format_json:
+        DISPLAYRESULT("%s\n    { \"algorithm\": ", first ? "" : ",");
+        BMK_displayJsonString(hName);
+        DISPLAYRESULT(", \"threads\": %u, \"buffer\": ", nbThreads);
+        BMK_displayJsonString(mode);
+        DISPLAYRESULT(", \"size\": %u, \"aggregate_GBps\": %.3f, \"per_thread_GBps\": %.3f, "
+                      "\"min_thread_GBps\": %.3f, \"efficiency\": %.3f }",
+                      (U32)bufferSize, r->aggregate, r->perThread, r->minThread, efficiency);
+        break;
+    case BMK_format_human:
+    default:
+        DISPLAYRESULT("%3u threads %-7s %9u : %8.2f GB/s total, %6.2f GB/s per thread (min %6.2f), %5.1f%% efficiency\n",
+                      nbThreads, mode, (U32)bufferSize, r->aggregate, r->perThread, r->minThread, efficiency * 100.);
+        break;
+    }
+}
+
+/* BMK_benchThreads() :
+ * measures how throughput of one algorithm scales from 1 to maxThreads threads,
+ * on cache-resident and DRAM-resident buffers,
+ * each thread hashing either its own buffer ("private") or the same one ("shared").
+ * Shared mode allocates a single buffer; private mode allocates maxThreads of them.
+ * Thread counts double at each step, up to maxThreads.
+ * specificTest selects the algorithm, as with -b# (default : XXH64).
+ * @return : 0 on success, error code otherwise */
+static int BMK_benchThreads(U32 maxThreads, U32 specificTest)
+{
+    size_t const sizes[2] = { THREADS_CACHE_SIZE, THREADS_DRAM_SIZE };
+    U32 const candidateIdx = specificTest ? (specificTest-1) / 2 : 1;
+    size_t const misalign = (specificTest && !(specificTest & 1)) ? g_hashCandidates[candidateIdx].misalign : 0;
+    U64 const targetNanos = TIMELOOP_NS / 4;
+    const void** const buffers = (const void**)calloc(maxThreads, sizeof(void*));
+    void** const allocated = (void**)calloc(maxThreads, sizeof(void*));
+    char hName[64];
+    int first = 1;
+    int s;
+
+    if (specificTest > 2*NB_HASH_CANDIDATES) {
+        DISPLAY("benchmark mode invalid \n");
+        free((void*)buffers); free(allocated);
+        return 1;
+    }
+    if (maxThreads > THREADS_MAX_MEMORY / (THREADS_DRAM_SIZE + 16 + 16)) {
+        DISPLAY("Error: %u private buffers of %u MB exceed the memory limit of %u MB \n",
+                maxThreads, (U32)(THREADS_DRAM_SIZE >> 20), (U32)(THREADS_MAX_MEMORY >> 20));
+        free((void*)buffers); free(allocated);
+        return 12;
+    }
+    if (!buffers || !allocated) {
+        DISPLAY("\nError: not enough memory!\n");
+        free((void*)buffers); free(allocated);
+        return 12;
+    }
+    sprintf(hName, "%.40s%s", g_hashCandidates[candidateIdx].name, misalign ? " unaligned" : "");
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("{\n  \"results\": [");
+    else if (g_outputFormat == BMK_format_human) DISPLAYRESULT("%s, up to %u threads \n", hName, maxThreads);
+
+    for (s=0; s<2; s++) {
+        size_t const bufferSize = sizes[s];
+        int shared;
+        for (shared=0; shared<2; shared++) {
+            U32 const nbBuffers = shared ? 1 : maxThreads;
+            double singleThread = 0.;
+            U32 nbThreads;
+            U32 t;
+            for (t=0; t<nbBuffers; t++) {
+                allocated[t] = malloc(bufferSize + 16 + 16);
+                if (!allocated[t]) {
+                    DISPLAY("\nError: not enough memory!\n");
+                    while (t) free(allocated[--t]);
+                    free((void*)buffers); free(allocated);
+                    return 12;
+                }
+                BMK_fillBuffer(allocated[t], bufferSize + 16 + 16);
+            }
+            for (t=0; t<maxThreads; t++) {
+                char* const base = (char*)allocated[shared ? 0 : t];
+                buffers[t] = base + 15 - (((size_t)(base+15)) & 0xF) + misalign;
+            }
+            for (nbThreads=1; ; nbThreads*=2) {
+                BMK_threadResult best;
+                U32 iterationNb;
+                if (nbThreads > maxThreads) nbThreads = maxThreads;
+                memset(&best, 0, sizeof(best));
+                if (g_nbIterations<1) g_nbIterations=1;
+                for (iterationNb=1; iterationNb<=g_nbIterations; iterationNb++) {
+                    BMK_threadResult r;
+                    DISPLAYLEVEL(2, "\r%70s\r%u-%u threads %s %u ...\r", "", iterationNb, nbThreads,
+                                 shared ? "shared" : "private", (U32)bufferSize);
+                    if (BMK_runThreads(&r, g_hashCandidates[candidateIdx].func, buffers, bufferSize, nbThreads, targetNanos)) {
+                        DISPLAY("\nError: could not start %u threads \n", nbThreads);
+                        for (t=0; t<nbBuffers; t++) free(allocated[t]);
+                        free((void*)buffers); free(allocated);
+                        return 15;
+                    }
+                    if (r.aggregate > best.aggregate) best = r;
+                }
+                DISPLAYLEVEL(2, "\r%70s\r", "");
+                if (nbThreads==1) singleThread = best.aggregate;
+                BMK_displayThreadResult(hName, nbThreads, shared ? "shared" : "private", bufferSize, &best, singleThread, first);
+                first = 0;
+                if (nbThreads == maxThreads) break;
+            }
+            for (t=0; t<nbBuffers; t++) free(allocated[t]);
+    }   }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+    free((void*)buffers);
+    free(allocated);
+    return 0;
+}
+
+#else
+
+static int BMK_benchThreads(U32 maxThreads, U32 specificTest)
+{
+    (void)maxThreads; (void)specificTest;
+    DISPLAY("Error: multi-threaded benchmark is not supported on this platform \n");
+    return 1;
+}
+
+#endif   /* BMK_HAS_THREADS */
+
+
+/* ********************************************************
+*  Regression gate
+**********************************************************/
+
+static const size_t g_regressSizes[] = { 8, 16, 64, 256, 4 KB, 64 KB, 1 MB };
+#define NB_REGRESS_SIZES (sizeof(g_regressSizes) / sizeof(g_regressSizes[0]))
+#define REGRESS_MAX_CELLS (NB_HASH_CANDIDATES * NB_REGRESS_SIZES * 2)
+#define REGRESS_DEFAULT_THRESHOLD 10   /* % */
+
+typedef struct {
+    char   algorithm[64];
+    U32    size;
+    U32    alignment;
+    double nsPerHash;
+} BMK_regressCell;
+
+/* BMK_loadBaseline() :
+ * reads cells saved by BMK_benchRegress(); lines starting with '#' are comments.
+ * @return : nb of cells read, or -1 if file can't be opened */
+static int BMK_loadBaseline(const char* fileName, BMK_regressCell* cells, int maxCells)
+{
+    FILE* const f = fopen(fileName, "r");
+    char line[256];
+    int nbCells = 0;
+    if (f == NULL) return -1;
+    while ((nbCells < maxCells) && (fgets(line, sizeof(line), f) != NULL)) {
+        BMK_regressCell* const cell = cells + nbCells;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%63[^,],%u,%u,%lf", cell->algorithm, &cell->size, &cell->alignment, &cell->nsPerHash) == 4)
+            nbCells++;
+    }
+    fclose(f);
+    return nbCells;
+}
+
+static const BMK_regressCell* BMK_findCell(const BMK_regressCell* cells, int nbCells,
+                                           const char* algorithm, U32 size, U32 alignment)
+{
+    int n;
+    for (n=0; n<nbCells; n++)
+        if (!strcmp(cells[n].algorithm, algorithm) && (cells[n].size == size) && (cells[n].alignment == alignment))
+            return cells + n;
+    return NULL;
+}
+
+/* BMK_benchRegress() :
+ * Measures a fixed matrix (all algorithms x g_regressSizes x aligned/unaligned).
+ * `saveName` : if not NULL, results are written there, as a new baseline.
+ * `baselineName` : if not NULL, results are compared with this baseline;
+ *                  a cell regresses when it is more than `thresholdPct` % slower.
+ * @return : 0 when no cell regressed, 1 if at least one did, other values on error */
+static int BMK_benchRegress(const char* baselineName, const char* saveName, U32 thresholdPct)
+{
+    size_t const maxSize = g_regressSizes[NB_REGRESS_SIZES-1];
+    void* const buffer = malloc(maxSize + 16 + 16);
+    const char* const alignedBuffer = (const char*)buffer + 15 - (((size_t)((char*)buffer+15)) & 0xF);
+    BMK_regressCell* const baseline = (BMK_regressCell*)malloc(REGRESS_MAX_CELLS * sizeof(BMK_regressCell));
+    FILE* saveFile = NULL;
+    int nbBaseline = 0;
+    U32 nbRegressions = 0;
+    U32 s;
+
+    if (!buffer || !baseline) {
+        DISPLAY("\nError: not enough memory!\n");
+        free(buffer); free(baseline);
+        return 12;
+    }
+    if (baselineName) {
+        nbBaseline = BMK_loadBaseline(baselineName, baseline, (int)REGRESS_MAX_CELLS);
+        if (nbBaseline < 0) {
+            DISPLAY("Could not open baseline %s: %s\n", baselineName, strerror(errno));
+            free(buffer); free(baseline);
+            return 11;
+    }   }
+    if (saveName) {
+        saveFile = fopen(saveName, "w");
+        if (saveFile == NULL) {
+            DISPLAY("Could not create %s: %s\n", saveName, strerror(errno));
+            free(buffer); free(baseline);
+            return 11;
+        }
+        {   char cpuName[64];
+            BMK_getCpuName(cpuName, sizeof(cpuName));
+            fprintf(saveFile, "# xxhsum %s, %s, %s, %i iterations\n", PROGRAM_VERSION, cpuName, BMK_COMPILER, g_nbIterations);
+            fprintf(saveFile, "# algorithm,size,alignment,ns_per_hash\n");
+    }   }
+    BMK_fillBuffer(buffer, maxSize + 16 + 16);
+
+    if (baselineName)
+        DISPLAYRESULT("%-12s %8s %3s : %12s %12s %8s \n", "algorithm", "size", "al", "baseline ns", "current ns", "delta");
+    for (s=0; s<NB_REGRESS_SIZES; s++) {
+        size_t const size = g_regressSizes[s];
+        U32 idx;
+        for (idx=0; idx<NB_HASH_CANDIDATES; idx++) {
+            const BMK_hashCandidate* const candidate = g_hashCandidates + idx;
+            size_t const alignments[2] = { 0, candidate->misalign };
+            int a;
+            for (a=0; a<2; a++) {
+                double nsPerHash;
+                DISPLAYLEVEL(2, "\r%70s\r%-12s %8u %3u ...\r", "", candidate->name, (U32)size, (U32)alignments[a]);
+                nsPerHash = BMK_measureHash(candidate->func, NULL, alignedBuffer + alignments[a], size, TIMELOOP_NS / 10, 0);
+                DISPLAYLEVEL(2, "\r%70s\r", "");
+                if (saveFile)
+                    fprintf(saveFile, "%s,%u,%u,%.3f\n", candidate->name, (U32)size, (U32)alignments[a], nsPerHash);
+                if (baselineName) {
+                    const BMK_regressCell* const ref = BMK_findCell(baseline, nbBaseline, candidate->name, (U32)size, (U32)alignments[a]);
+                    DISPLAYRESULT("%-12s %8u %3u : ", candidate->name, (U32)size, (U32)alignments[a]);
+                    if (ref == NULL) {
+                        DISPLAYRESULT("%12s %12.2f %8s   (not in baseline) \n", "-", nsPerHash, "");
+                    } else {
+                        double const delta = (nsPerHash / ref->nsPerHash - 1.) * 100.;
+                        int const regressed = delta > (double)thresholdPct;
+                        nbRegressions += (U32)regressed;
+                        DISPLAYRESULT("%12.2f %12.2f %+7.1f%% %s\n", ref->nsPerHash, nsPerHash, delta, regressed ? "  REGRESSION" : "");
+                }   }
+    }   }   }
+
+    if (saveFile) {
+        fclose(saveFile);
+        DISPLAYLEVEL(2, "Baseline saved to %s \n", saveName);
+    }
+    if (baselineName) {
+        if (nbRegressions)
+            DISPLAY("%u cells regressed by more than %u%% \n", nbRegressions, thresholdPct);
+        else
+            DISPLAYLEVEL(2, "No regression beyond %u%% \n", thresholdPct);
+    }
+    free(buffer);
+    free(baseline);
+    return nbRegressions ? 1 : 0;
+}
+
+
+/* ********************************************************
+*  Key corpus
+**********************************************************/
+
+typedef enum { BMK_keys_lines, BMK_keys_u32 } BMK_keysFormat_e;
+
+typedef struct {
+    const BYTE* start;
+    size_t length;
+} BMK_key;
+
+typedef struct {
+    BYTE*    arena;     /* key contents, packed without separators */
+    BMK_key* keys;      /* in file order */
+    BMK_key* shuffled;  /* same keys, in random order */
+    size_t   nbKeys;
+    size_t   totalSize;
+} BMK_keyCorpus;
+
+#define KEYS_NB_BUCKETS 8
+static const size_t g_keyBucketMax[KEYS_NB_BUCKETS] = { 8, 16, 32, 64, 128, 256, 1024, (size_t)-1 };
+
+static U32 BMK_keyBucket(size_t length)
+{
+    U32 b = 0;
+    while (length > g_keyBucketMax[b]) b++;
+    return b;
+}
+
+static void BMK_freeKeys(BMK_keyCorpus* corpus)
+{
+    free(corpus->arena);
+    free(corpus->keys);
+    free(corpus->shuffled);
+}
+
+/* BMK_loadKeys() :
+ * BMK_keys_lines : one key per line; '\r' before '\n' and empty lines are ignored.
+ * BMK_keys_u32 : each key is preceded by its length, as a 32-bit little-endian value.
+ * Keys are compacted in place, so that the arena only contains key contents.
+ * @return : 0 on success, error code otherwise */
+static int BMK_loadKeys(BMK_keyCorpus* corpus, const char* fileName, BMK_keysFormat_e format)
+{
+    U64 const fileSize = BMK_GetFileSize(fileName);
+    size_t const maxKeys = (format == BMK_keys_lines) ? (size_t)fileSize/2 + 1 : (size_t)fileSize/4 + 1;
+    FILE* inFile;
+
+    memset(corpus, 0, sizeof(*corpus));
+    if (fileSize == 0 || fileSize > (U64)MAX_MEM) {
+        DISPLAY("Error: %s is not a usable key file \n", fileName);
+        return 11;
+    }
+    inFile = fopen(fileName, "rb");
+    if (inFile==NULL) {
+        DISPLAY("Could not open %s: %s\n", fileName, strerror(errno));
+        return 11;
+    }
+    corpus->arena = (BYTE*)malloc((size_t)fileSize);
+    corpus->keys = (BMK_key*)malloc(maxKeys * sizeof(BMK_key));
+    corpus->shuffled = (BMK_key*)malloc(maxKeys * sizeof(BMK_key));
+    if (!corpus->arena || !corpus->keys || !corpus->shuffled) {
+        DISPLAY("\nError: not enough memory!\n");
+        fclose(inFile);
+        BMK_freeKeys(corpus);
+        return 12;
+    }
+    DISPLAYLEVEL(2, "\rLoading %s...        \n", fileName);
+    if (fread(corpus->arena, 1, (size_t)fileSize, inFile) != (size_t)fileSize) {
+        DISPLAY("\nError: Could not read %s: %s\n", fileName, strerror(errno));
+        fclose(inFile);
+        BMK_freeKeys(corpus);
+        return 13;
+    }
+    fclose(inFile);
+
+    /* parse and compact */
+    {   BYTE* const arena = corpus->arena;
+        size_t const srcSize = (size_t)fileSize;
+        size_t src = 0, dst = 0, nbKeys = 0;
+        while (src < srcSize) {
+            size_t length;
+            if (format == BMK_keys_lines) {
+                const BYTE* const eol = (const BYTE*)memchr(arena + src, '\n', srcSize - src);
+                size_t const lineEnd = eol ? (size_t)(eol - arena) : srcSize;
+                length = lineEnd - src;
+                if (length && arena[src + length - 1] == '\r') length--;
+                memmove(arena + dst, arena + src, length);
+                src = lineEnd + 1;
+                if (length == 0) continue;
+            } else {
+                if (srcSize - src < 4) break;
+                length = (size_t)arena[src] + ((size_t)arena[src+1] << 8)
+                       + ((size_t)arena[src+2] << 16) + ((size_t)arena[src+3] << 24);
+                src += 4;
+                if (length > srcSize - src) {
+                    DISPLAY("Error: %s : key %u is truncated \n", fileName, (U32)nbKeys);
+                    BMK_freeKeys(corpus);
+                    return 14;
+                }
+                memmove(arena + dst, arena + src, length);
+                src += length;
+            }
+            assert(nbKeys < maxKeys);
+            corpus->keys[nbKeys].length = length;   /* start is set once the arena is final */
+            nbKeys++;
+            dst += length;
+        }
+        corpus->nbKeys = nbKeys;
+        corpus->totalSize = dst;
+    }
+    if (corpus->nbKeys == 0) {
+        DISPLAY("Error: no key found in %s \n", fileName);
+        BMK_freeKeys(corpus);
+        return 14;
+    }
+
+    {   size_t n, pos = 0;
+        for (n=0; n<corpus->nbKeys; n++) {
+            corpus->keys[n].start = corpus->arena + pos;
+            pos += corpus->keys[n].length;
+    }   }
+
+    /* Fisher-Yates shuffle, with a fixed seed for reproducible results */
+    memcpy(corpus->shuffled, corpus->keys, corpus->nbKeys * sizeof(BMK_key));
+    {   U32 rand32 = 2654435761U;
+        size_t n;
+        for (n = corpus->nbKeys - 1; n > 0; n--) {
+            size_t j;
+            BMK_key tmp;
+            rand32 = rand32 * 1103515245U + 12345U;
+            j = (size_t)(((U64)(rand32 >> 1) * (n+1)) >> 31);
+            tmp = corpus->shuffled[n];
+            corpus->shuffled[n] = corpus->shuffled[j];
+            corpus->shuffled[j] = tmp;
+    }   }
+    return 0;
+}
+
+/* BMK_measureKeys() :
+ * Hashes all `keys`, in sequence, repeatedly.
+ * In latency mode, each key is seeded with the previous result.
+ * @return : fastest round, in nanoseconds per key */
+static double BMK_measureKeys(hashFunction h, const BMK_key* keys, size_t nbKeys, U64 targetNanos)
+{
+    U32 nbLoops = 1;
+    U32 iterationNb;
+    double fastestK = 100000000.;   /* in nanoseconds per key */
+
+    if (g_nbIterations<1) g_nbIterations=1;
+    for (iterationNb = 1; iterationNb <= g_nbIterations; iterationNb++) {
+        U32 r = 0;
+        BMK_time_t const tStart = BMK_getTime();
+        U32 loopNb;
+        for (loopNb=0; loopNb<nbLoops; loopNb++) {
+            size_t n;
+            if (g_benchLatency) {
+                for (n=0; n<nbKeys; n++)
+                    r = h(keys[n].start, keys[n].length, r);
+            } else {
+                for (n=0; n<nbKeys; n++)
+                    r += h(keys[n].start, keys[n].length, (U32)n);
+            }
+        }
+        if (r==0) DISPLAYLEVEL(3,".\r");  /* do something with r to avoid compiler "optimizing" away hash function */
+        {   U64 const nanos = BMK_clockSpanNano(tStart);
+            double const nsPerKey = (double)(nanos ? nanos : 1) / ((double)nbLoops * (double)nbKeys);
+            if (nsPerKey < fastestK) fastestK = nsPerKey;
+            nbLoops = (U32)((double)targetNanos / (fastestK * (double)nbKeys)) + 1;
+        }
+    }
+    return fastestK;
+}
+
+static void BMK_displayKeysResult(const char* algoName, const char* order, const char* bucket,
+                                  size_t nbKeys, size_t totalSize, double nsPerKey, int first)
+{
+    double const avgLength = (double)totalSize / (double)nbKeys;
+    double const mbps = (avgLength / (1<<20)) * 1000000000. / nsPerKey;
+
+    switch (g_outputFormat)
+    {
+    case BMK_format_csv:
+        if (first) DISPLAYRESULT("algorithm,order,length,nb_keys,avg_length,ns_per_key,MBps\n");
+        DISPLAYRESULT("%s,%s,%s,%u,%.1f,%.3f,%.2f\n",
+                      algoName, order, bucket, (U32)nbKeys, avgLength, nsPerKey, mbps);
+        break;
+    case BMK_format_json:
+        DISPLAYRESULT("%s\n    { \"algorithm\": ", first ? "" : ",");
+        BMK_displayJsonString(algoName);
+        DISPLAYRESULT(", \"order\": ");
+        BMK_displayJsonString(order);
+        DISPLAYRESULT(", \"length\": ");
+        BMK_displayJsonString(bucket);
+        DISPLAYRESULT(", \"nb_keys\": %u, \"avg_length\": %.1f, \"ns_per_key\": %.3f, \"MBps\": %.2f }",
+                      (U32)nbKeys, avgLength, nsPerKey, mbps);
+        break;
+    case BMK_format_human:
+    default:
+        DISPLAYRESULT("%-12s %-10s %-9s : %9u keys (avg %7.1f B) %9.2f ns/key %9.1f MB/s\n",
+                      algoName, order, bucket, (U32)nbKeys, avgLength, nsPerKey, mbps);
+        break;
+    }
+}
+
+/* BMK_benchKeys() :
+ * Benchmarks all algorithms on a corpus of real keys, in their natural length distribution :
+ * all keys in file order, all keys shuffled, then shuffled keys grouped by length.
+ * @return : 0 on success, error code otherwise */
+static int BMK_benchKeys(const char* fileName, BMK_keysFormat_e format)
+{
+    BMK_keyCorpus corpus;
+    BMK_key* bucketKeys;
+    size_t bucketCount[KEYS_NB_BUCKETS] = { 0 };
+    size_t bucketSize[KEYS_NB_BUCKETS] = { 0 };
+    U64 const targetNanos = TIMELOOP_NS / 4;
+    const char* const modeName = g_benchLatency ? "latency" : "throughput";
+    int first = 1;
+    U32 idx;
+
+    {   int const loadError = BMK_loadKeys(&corpus, fileName, format);
+        if (loadError) return loadError;
+    }
+    bucketKeys = (BMK_key*)malloc(corpus.nbKeys * sizeof(BMK_key));
+    if (!bucketKeys) {
+        DISPLAY("\nError: not enough memory!\n");
+        BMK_freeKeys(&corpus);
+        return 12;
+    }
+    {   size_t n;
+        for (n=0; n<corpus.nbKeys; n++) {
+            U32 const b = BMK_keyBucket(corpus.keys[n].length);
+            bucketCount[b]++;
+            bucketSize[b] += corpus.keys[n].length;
+    }   }
+
+    DISPLAYLEVEL(2, "%u keys, %u bytes, measuring %s \n", (U32)corpus.nbKeys, (U32)corpus.totalSize, modeName);
+    if (g_outputFormat == BMK_format_json) {
+        DISPLAYRESULT("{\n  \"keys\": ");
+        BMK_displayJsonString(fileName);
+        DISPLAYRESULT(",\n  \"mode\": ");
+        BMK_displayJsonString(modeName);
+        DISPLAYRESULT(",\n  \"results\": [");
+    }
+
+    for (idx=0; idx<NB_HASH_CANDIDATES; idx++) {
+        const BMK_hashCandidate* const candidate = g_hashCandidates + idx;
+        double nsPerKey;
+        U32 b;
+
+        DISPLAYLEVEL(2, "\r%70s\r%s ...\r", "", candidate->name);
+        nsPerKey = BMK_measureKeys(candidate->func, corpus.keys, corpus.nbKeys, targetNanos);
+        BMK_displayKeysResult(candidate->name, "sequential", "all", corpus.nbKeys, corpus.totalSize, nsPerKey, first);
+        first = 0;
+        nsPerKey = BMK_measureKeys(candidate->func, corpus.shuffled, corpus.nbKeys, targetNanos);
+        BMK_displayKeysResult(candidate->name, "shuffled", "all", corpus.nbKeys, corpus.totalSize, nsPerKey, 0);
+
+        for (b=0; b<KEYS_NB_BUCKETS; b++) {
+            char bucketName[32];
+            size_t n, nbBucketKeys = 0;
+            if (bucketCount[b] == 0) continue;
+            for (n=0; n<corpus.nbKeys; n++)
+                if (BMK_keyBucket(corpus.shuffled[n].length) == b)
+                    bucketKeys[nbBucketKeys++] = corpus.shuffled[n];
+            if (b == KEYS_NB_BUCKETS-1)
+                sprintf(bucketName, ">%u", (U32)g_keyBucketMax[b-1]);
+            else
+                sprintf(bucketName, "%u-%u", b ? (U32)g_keyBucketMax[b-1]+1 : 1U, (U32)g_keyBucketMax[b]);
+            nsPerKey = BMK_measureKeys(candidate->func, bucketKeys, nbBucketKeys, targetNanos);
+            BMK_displayKeysResult(candidate->name, "shuffled", bucketName, bucketCount[b], bucketSize[b], nsPerKey, 0);
+        }
+        DISPLAYLEVEL(2, "\r%70s\r", "");
+    }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+    free(bucketKeys);
+    BMK_freeKeys(&corpus);
+    return 0;
+}
+
+
+/* ********************************************************
+*  Repeated measurements
+**********************************************************/
+
+/* BMK_runOp_f :
+ * runs operation `op` of workload `variant` once.
+ * *nbOps : nb of elementary operations measured
+ * @return : duration, in ns, or 0 on failure */
+typedef U64 (*BMK_runOp_f)(void* bench, int variant, int op, size_t* nbOps);
+
+/* BMK_minOfRuns() :
+ * runs the `nbOps` operations of `variant` g_nbIterations times, interleaved,
+ * and keeps the fastest run of each into nsPerOp[op], in ns per elementary operation.
+ * `opNames` : NULL for a single unnamed operation.
+ * @return : 0 on success, 1 if a run failed */
+static int BMK_minOfRuns(BMK_runOp_f run, void* bench, int variant, const char* variantName,
+                         const char* const* opNames, int nbOps, double* nsPerOp)
+{
+    U32 iterationNb;
+    int op;
+    for (op=0; op<nbOps; op++) nsPerOp[op] = 1e30;
+    if (g_nbIterations<1) g_nbIterations=1;
+    for (iterationNb=1; iterationNb<=g_nbIterations; iterationNb++) {
+        for (op=0; op<nbOps; op++) {
+            const char* const opName = opNames ? opNames[op] : "";
+            size_t nbCalls = 1;
+            U64 nanos;
+            DISPLAYLEVEL(2, "\r%70s\r%u-%s%s%s ...\r", "", iterationNb, variantName,
+                         (variantName[0] && opName[0]) ? " " : "", opName);
+            nanos = run(bench, variant, op, &nbCalls);
+            if (nanos == 0) { DISPLAYLEVEL(2, "\r%70s\r", ""); return 1; }
+            if ((double)nanos / (double)nbCalls < nsPerOp[op]) nsPerOp[op] = (double)nanos / (double)nbCalls;
+    }   }
+    DISPLAYLEVEL(2, "\r%70s\r", "");
+    return 0;
+}
+
+
+/* ********************************************************
+*  Hash table workload
+**********************************************************/
+
+#define TABLE_DEFAULT_NB_KEYS (1 << 20)
+#define TABLE_DEFAULT_MIN_LENGTH 8
+#define TABLE_DEFAULT_MAX_LENGTH 64
+
+/* BMK_generateKeys() :
+ * `nbKeys` random keys, with lengths uniformly distributed in [minLength, maxLength].
+ * Different `seed` values produce different key sets.
+ * @return : 0 on success, 12 if allocation failed */
+static int BMK_generateKeys(BMK_keyCorpus* corpus, size_t nbKeys, size_t minLength, size_t maxLength, U32 seed)
+{
+    U32 rand32 = seed * 2654435761U + 1;
+    size_t n, pos = 0;
+
+    memset(corpus, 0, sizeof(*corpus));
+    corpus->arena = (BYTE*)malloc(nbKeys * maxLength + 1);
+    corpus->keys = (BMK_key*)malloc(nbKeys * sizeof(BMK_key));
+    corpus->shuffled = (BMK_key*)malloc(nbKeys * sizeof(BMK_key));
+    if (!corpus->arena || !corpus->keys || !corpus->shuffled) {
+        BMK_freeKeys(corpus);
+        return 12;
+    }
+    for (n=0; n<nbKeys; n++) {
+        size_t length, i;
+        rand32 = rand32 * 1103515245U + 12345U;
+        length = minLength + (size_t)((rand32 >> 8) % (U32)(maxLength - minLength + 1));
+        for (i=0; i<length; i++) {
+            rand32 = rand32 * 1103515245U + 12345U;
+            corpus->arena[pos+i] = (BYTE)(rand32 >> 24);
+        }
+        corpus->keys[n].start = corpus->arena + pos;
+        corpus->keys[n].length = length;
+        pos += length;
+    }
+    corpus->nbKeys = nbKeys;
+    corpus->totalSize = pos;
+    memcpy(corpus->shuffled, corpus->keys, nbKeys * sizeof(BMK_key));
+    return 0;
+}
+
+/* BMK_deriveAbsentKeys() :
+ * same keys as `present`, with their last byte modified, so that they are not in `present`
+ * (unless `present` contains such pairs of keys).
+ * @return : 0 on success, 12 if allocation failed */
+static int BMK_deriveAbsentKeys(BMK_keyCorpus* absent, const BMK_keyCorpus* present)
+{
+    size_t n;
+    memset(absent, 0, sizeof(*absent));
+    absent->arena = (BYTE*)malloc(present->totalSize + 1);
+    absent->keys = (BMK_key*)malloc(present->nbKeys * sizeof(BMK_key));
+    if (!absent->arena || !absent->keys) {
+        BMK_freeKeys(absent);
+        return 12;
+    }
+    memcpy(absent->arena, present->arena, present->totalSize);
+    for (n=0; n<present->nbKeys; n++) {
+        size_t const pos = (size_t)(present->keys[n].start - present->arena);
+        size_t const length = present->keys[n].length;
+        if (length) absent->arena[pos + length - 1] ^= 0x80;
+        absent->keys[n].start = absent->arena + pos;
+        absent->keys[n].length = length;
+    }
+    absent->nbKeys = present->nbKeys;
+    absent->totalSize = present->totalSize;
+    return 0;
+}
+
+static int BMK_keyEqual(const BMK_key* a, const BMK_key* b)
+{
+    return (a->length == b->length) && !memcmp(a->start, b->start, a->length);
+}
+
+/* BMK_separateAbsentKeys() :
+ * modifies the last byte of `absent` keys which are also in `present`, until they are not.
+ * Short key spaces can make it impossible : such keys are left unchanged.
+ * @return : nb of `absent` keys still in `present`, or (size_t)-1 if allocation failed */
+static size_t BMK_separateAbsentKeys(BMK_keyCorpus* absent, const BMK_keyCorpus* present)
+{
+    size_t mask = 1;
+    U32* slots;   /* set of present keys : 0 == empty, index+1 otherwise */
+    size_t n, nbCollisions = 0;
+
+    while (mask < 2 * present->nbKeys) mask = 2*mask + 1;
+    slots = (U32*)calloc(mask + 1, sizeof(U32));
+    if (!slots) return (size_t)-1;
+    for (n=0; n<present->nbKeys; n++) {
+        size_t pos = (size_t)XXH64(present->keys[n].start, present->keys[n].length, 0) & mask;
+        while (slots[pos]) pos = (pos + 1) & mask;
+        slots[pos] = (U32)n + 1;
+    }
+    for (n=0; n<absent->nbKeys; n++) {
+        const BMK_key* const key = absent->keys + n;
+        U32 attempt;
+        for (attempt=0; attempt<=8; attempt++) {
+            size_t pos = (size_t)XXH64(key->start, key->length, 0) & mask;
+            int found = 0;
+            while (slots[pos] && !found) {
+                found = BMK_keyEqual(present->keys + slots[pos] - 1, key);
+                pos = (pos + 1) & mask;
+            }
+            if (!found) break;
+            if ((attempt == 8) || (key->length == 0)) { nbCollisions++; break; }
+            absent->arena[(size_t)(key->start - absent->arena) + key->length - 1] ^= (BYTE)(0x80 >> attempt);   /* last byte */
+    }   }
+    free(slots);
+    return nbCollisions;
+}
+
+/* BMK_prepareLookupKeys() :
+ * Keys for lookup workloads : `present` keys come from `keysFileName` when provided,
+ * and are generated otherwise (`*nbKeys` keys of `*minLength`-`*maxLength` bytes).
+ * `absent` keys are derived from them, or generated with another seed.
+ * Generated keys are distinguished by the top bit of their first byte,
+ * and absent keys are then checked against present ones, so that lookups miss.
+ * present->shuffled is in random order, for successful lookups.
+ * *nbKeys, *minLength and *maxLength are updated to describe the key set.
+ * @return : 0 on success, error code otherwise */
+static int BMK_prepareLookupKeys(BMK_keyCorpus* present, BMK_keyCorpus* absent,
+                                 size_t* nbKeys, size_t* minLength, size_t* maxLength,
+                                 const char* keysFileName, BMK_keysFormat_e keysFormat)
+{
+    if (keysFileName) {
+        int const loadError = BMK_loadKeys(present, keysFileName, keysFormat);
+        if (loadError) return loadError;
+        *nbKeys = present->nbKeys;
+        *minLength = (size_t)-1; *maxLength = 0;
+        {   size_t n;
+            for (n=0; n<*nbKeys; n++) {
+                *minLength = MIN(*minLength, present->keys[n].length);
+                *maxLength = MAX(*maxLength, present->keys[n].length);
+        }   }
+    } else if (BMK_generateKeys(present, *nbKeys, *minLength, *maxLength, 1)) {
+        DISPLAY("\nError: not enough memory!\n");
+        return 12;
+    }
+    if ( keysFileName ? BMK_deriveAbsentKeys(absent, present)
+                      : BMK_generateKeys(absent, *nbKeys, *minLength, *maxLength, 2) ) {
+        DISPLAY("\nError: not enough memory!\n");
+        BMK_freeKeys(present);
+        return 12;
+    }
+    if (!keysFileName) {
+        size_t n;
+        for (n=0; n<*nbKeys; n++) {
+            if (present->keys[n].length) present->arena[present->keys[n].start - present->arena] &= 0x7F;
+            if (absent->keys[n].length) absent->arena[absent->keys[n].start - absent->arena] |= 0x80;
+    }   }
+    {   size_t const nbCollisions = BMK_separateAbsentKeys(absent, present);
+        if (nbCollisions == (size_t)-1) {
+            DISPLAY("\nError: not enough memory!\n");
+            BMK_freeKeys(present); BMK_freeKeys(absent);
+            return 12;
+        }
+        if (nbCollisions)
+            DISPLAY("Warning: %u of %u absent keys are also present (key space too small) : "
+                    "misses are partly hits \n", (U32)nbCollisions, (U32)*nbKeys);
+    }
+    /* lookups in random order */
+    {   U32 rand32 = 2654435761U;
+        size_t n;
+        for (n = *nbKeys - 1; n > 0; n--) {
+            size_t j;
+            BMK_key tmp;
+            rand32 = rand32 * 1103515245U + 12345U;
+            j = (size_t)(((U64)(rand32 >> 1) * (n+1)) >> 31);
+            tmp = present->shuffled[n]; present->shuffled[n] = present->shuffled[j]; present->shuffled[j] = tmp;
+    }   }
+    return 0;
+}
+
+/* Open addressing, linear probing.
+ * Slots store the full hash, so that most mismatches are resolved without reading keys. */
+typedef struct {
+    U32 hash;
+    U32 keyId;   /* 0 == empty, index+1 otherwise */
+} BMK_slot;
+
+typedef struct {
+    BMK_slot* slots;
+    size_t mask;
+    const BMK_key* keys;   /* keys referenced by keyId */
+} BMK_table;
+
+/* BMK_tableInsert() : @return : nb of probes (slots examined) */
+static size_t BMK_tableInsert(BMK_table* table, hashFunction h, U32 keyIdx)
+{
+    const BMK_key* const key = table->keys + keyIdx;
+    U32 const hash = h(key->start, key->length, 0);
+    size_t pos = hash & table->mask;
+    size_t nbProbes = 1;
+    while (table->slots[pos].keyId) {
+        const BMK_slot* const slot = table->slots + pos;
+        if ((slot->hash == hash) && BMK_keyEqual(table->keys + slot->keyId - 1, key)) return nbProbes;  /* duplicate */
+        pos = (pos + 1) & table->mask;
+        nbProbes++;
+    }
+    table->slots[pos].hash = hash;
+    table->slots[pos].keyId = keyIdx + 1;
+    return nbProbes;
+}
+
+/* BMK_tableFind() :
+ * @return : nb of probes (slots examined); *found is set to 1 if key is present */
+static size_t BMK_tableFind(const BMK_table* table, hashFunction h, const BMK_key* key, int* found)
+{
+    U32 const hash = h(key->start, key->length, 0);
+    size_t pos = hash & table->mask;
+    size_t nbProbes = 1;
+    while (table->slots[pos].keyId) {
+        const BMK_slot* const slot = table->slots + pos;
+        if ((slot->hash == hash) && BMK_keyEqual(table->keys + slot->keyId - 1, key)) { *found = 1; return nbProbes; }
+        pos = (pos + 1) & table->mask;
+        nbProbes++;
+    }
+    *found = 0;
+    return nbProbes;
+}
+
+typedef enum { BMK_op_insert, BMK_op_hit, BMK_op_miss, BMK_op_max } BMK_tableOp_e;
+static const char* const g_tableOpNames[BMK_op_max] = { "insert", "lookup-hit", "lookup-miss" };
+
+typedef struct {
+    double nsPerOp;
+    double avgProbes;
+    size_t maxProbes;
+    size_t nbFound;
+} BMK_tableResult;
+
+typedef struct {
+    BMK_table* table;                    /* BMK_runTableOp() */
+    hashFunction h;
+    XXH_map_t* map;                      /* BMK_runMapOp() */
+    const U64* keys64;
+    const BMK_keyCorpus* present;
+    const BMK_keyCorpus* absent;
+    BMK_tableResult stats[BMK_op_max];   /* of the last run : they don't depend on timing */
+} BMK_tableBench;
+
+/* BMK_runTableOp() :
+ * runs one operation over all keys, once.
+ * insert starts from an empty table; lookups use the table filled by a previous insert.
+ * @return : duration, in ns */
+static U64 BMK_runTableOp(void* bench, int variant, int op, size_t* nbOps)
+{
+    BMK_tableBench* const b = (BMK_tableBench*)bench;
+    BMK_table* const table = b->table;
+    hashFunction const h = b->h;
+    size_t const nbKeys = b->present->nbKeys;
+    size_t totalProbes = 0, maxProbes = 0, nbFound = 0;
+    BMK_time_t tStart;
+    U64 nanos;
+    size_t n;
+
+    (void)variant;
+    if (op == BMK_op_insert) memset(table->slots, 0, (table->mask+1) * sizeof(BMK_slot));
+    tStart = BMK_getTime();
+    for (n=0; n<nbKeys; n++) {
+        size_t nbProbes;
+        if (op == BMK_op_insert) {
+            nbProbes = BMK_tableInsert(table, h, (U32)n);
+        } else {
+            const BMK_key* const key = (op == BMK_op_hit) ? b->present->shuffled + n : b->absent->keys + n;
+            int found;
+            nbProbes = BMK_tableFind(table, h, key, &found);
+            nbFound += (size_t)found;
+        }
+        totalProbes += nbProbes;
+        if (nbProbes > maxProbes) maxProbes = nbProbes;
+    }
+    nanos = BMK_clockSpanNano(tStart);
+    b->stats[op].avgProbes = (double)totalProbes / (double)nbKeys;
+    b->stats[op].maxProbes = maxProbes;
+    b->stats[op].nbFound = nbFound;
+    *nbOps = nbKeys;
+    return nanos ? nanos : 1;
+}
+
+static void BMK_displayTableResult(const char* algoName, BMK_tableOp_e op, size_t nbKeys, double load,
+                                   const BMK_tableResult* r, int first)
+{
+    double const mops = 1000. / r->nsPerOp;
+    if (g_outputFormat == BMK_format_human) {
+        DISPLAYRESULT("%-12s %-11s : %8.2f ns/op %8.2f Mops/s", algoName, g_tableOpNames[op], r->nsPerOp, mops);
+        if (r->maxProbes) DISPLAYRESULT("   probes avg %5.2f max %4u", r->avgProbes, (U32)r->maxProbes);
+        if ((op == BMK_op_miss) && r->nbFound) DISPLAYRESULT("   warning : %u keys found", (U32)r->nbFound);
+        DISPLAYRESULT(" \n");
+    } else {
+        BMK_field fields[9];
+        BMK_setStr(fields+0, "algorithm", algoName);
+        BMK_setStr(fields+1, "operation", g_tableOpNames[op]);
+        BMK_setNum(fields+2, "nb_keys", (double)nbKeys, 0);
+        BMK_setNum(fields+3, "load", load, 3);
+        BMK_setNum(fields+4, "ns_per_op", r->nsPerOp, 3);
+        BMK_setNum(fields+5, "Mops", mops, 3);
+        BMK_setNum(fields+6, "avg_probes", r->avgProbes, 3);
+        BMK_setNum(fields+7, "max_probes", (double)r->maxProbes, 0);
+        BMK_setNum(fields+8, "found", (double)r->nbFound, 0);
+        BMK_displayFields(fields, 9, first);
+    }
+}
+
+/* BMK_runMapOp() :
+ * same as BMK_runTableOp(), with the Swiss table of xxh_map.h.
+ * `keys64` : NULL for byte-string keys, or BMK_op_max * nbKeys 8-byte keys, indexed by operation.
+ * Probes are not counted. */
+static U64 BMK_runMapOp(void* bench, int variant, int op, size_t* nbOps)
+{
+    BMK_tableBench* const b = (BMK_tableBench*)bench;
+    XXH_map_t* const map = b->map;
+    size_t const nbKeys = b->present->nbKeys;
+    size_t nbFound = 0;
+    BMK_time_t tStart;
+    U64 nanos;
+    size_t n;
+
+    (void)variant;
+    if (op == BMK_op_insert) XXH_map_clear(map);
+    tStart = BMK_getTime();
+    if (b->keys64) {
+        const U64* const keys = b->keys64 + (size_t)op * nbKeys;
+        for (n=0; n<nbKeys; n++) {
+            if (op == BMK_op_insert) (void)XXH_map_findOrInsert(map, keys + n, sizeof(U64), NULL);
+            else nbFound += (XXH_map_find(map, keys + n, sizeof(U64)) != NULL);
+        }
+    } else {
+        const BMK_key* const keys = (op == BMK_op_insert) ? b->present->keys
+                                  : (op == BMK_op_hit) ? b->present->shuffled : b->absent->keys;
+        for (n=0; n<nbKeys; n++) {
+            if (op == BMK_op_insert) (void)XXH_map_findOrInsert(map, keys[n].start, keys[n].length, NULL);
+            else nbFound += (XXH_map_find(map, keys[n].start, keys[n].length) != NULL);
+        }
+    }
+    nanos = BMK_clockSpanNano(tStart);
+    b->stats[op].avgProbes = 0.;
+    b->stats[op].maxProbes = 0;
+    b->stats[op].nbFound = nbFound;
+    *nbOps = nbKeys;
+    return nanos ? nanos : 1;
+}
+
+/* BMK_displayTableResults() : all operations of one algorithm, measured by BMK_minOfRuns() */
+static void BMK_displayTableResults(const char* algoName, BMK_tableBench* b, const double* nsPerOp,
+                                    double load, int* first)
+{
+    int op;
+    for (op=0; op<BMK_op_max; op++) {
+        b->stats[op].nsPerOp = nsPerOp[op];
+        BMK_displayTableResult(algoName, (BMK_tableOp_e)op, b->present->nbKeys, load, b->stats + op, *first);
+        *first = 0;
+    }
+}
+
+/* BMK_benchTableMap() :
+ * Runs the BMK_benchTable() workload on xxh_map.h, sized for nbKeys :
+ * with the same byte-string keys ("xxh_map"),
+ * then with as many 8-byte keys ("xxh_map u64") : present keys are odd multiples
+ * of an odd constant, absent keys even multiples, so that they are all distinct.
+ * @return : 0 on success, 12 if allocation failed */
+static int BMK_benchTableMap(BMK_tableBench* b, int* first)
+{
+    static const char* const mapNames[2] = { "xxh_map", "xxh_map u64" };
+    size_t const nbKeys = b->present->nbKeys;
+    U64* const keys64 = (U64*)malloc(BMK_op_max * nbKeys * sizeof(U64));
+    int variant;
+
+    if (keys64 == NULL) return 12;
+    {   U32 rand32 = 2654435761U;
+        size_t n;
+        for (n=0; n<nbKeys; n++) {
+            keys64[n] = (2*(U64)n + 1) * 0x9E3779B97F4A7C15ULL;
+            keys64[2*nbKeys + n] = (2*(U64)n + 2) * 0x9E3779B97F4A7C15ULL;
+        }
+        memcpy(keys64 + nbKeys, keys64, nbKeys * sizeof(U64));
+        for (n = nbKeys - 1; n > 0; n--) {   /* lookups in random order */
+            size_t j;
+            U64 tmp;
+            rand32 = rand32 * 1103515245U + 12345U;
+            j = (size_t)(((U64)(rand32 >> 1) * (n+1)) >> 31);
+            tmp = keys64[nbKeys + n]; keys64[nbKeys + n] = keys64[nbKeys + j]; keys64[nbKeys + j] = tmp;
+    }   }
+
+    for (variant=0; variant<2; variant++) {
+        double nsPerOp[BMK_op_max];
+        b->map = XXH_map_create(variant ? sizeof(U64) : 0, nbKeys, 0);
+        b->keys64 = variant ? keys64 : NULL;
+        if (b->map == NULL) { free(keys64); return 12; }
+        BMK_minOfRuns(BMK_runMapOp, b, variant, mapNames[variant], g_tableOpNames, BMK_op_max, nsPerOp);
+        BMK_displayTableResults(mapNames[variant], b, nsPerOp, (double)nbKeys / (double)b->map->capacity, first);
+        XXH_map_free(b->map);
+        b->map = NULL;
+    }
+    free(keys64);
+    return 0;
+}
+
+/* BMK_benchTable() :
+ * Drives an open-addressing hash table with each algorithm :
+ * insert all keys, look them all up in random order, then look up as many absent keys.
+ * Keys come from `keysFileName` when provided (absent keys are then derived from them),
+ * and are generated otherwise.
+ * Table capacity is the next power of 2 >= nbKeys * 10/7 (load <= 0.7).
+ * @return : 0 on success, error code otherwise */
+static int BMK_benchTable(size_t nbKeys, size_t minLength, size_t maxLength,
+                          const char* keysFileName, BMK_keysFormat_e keysFormat)
+{
+    BMK_keyCorpus present, absent;
+    BMK_table table;
+    BMK_tableBench b;
+    size_t capacity = 16;
+    int first = 1;
+    U32 idx;
+
+    {   int const prepError = BMK_prepareLookupKeys(&present, &absent, &nbKeys, &minLength, &maxLength,
+                                                    keysFileName, keysFormat);
+        if (prepError) return prepError;
+    }
+
+    while (capacity < nbKeys + nbKeys * 3 / 7) capacity *= 2;
+    table.mask = capacity - 1;
+    table.keys = present.keys;
+    table.slots = (BMK_slot*)malloc(capacity * sizeof(BMK_slot));
+    if (!table.slots) {
+        DISPLAY("\nError: not enough memory!\n");
+        BMK_freeKeys(&present); BMK_freeKeys(&absent);
+        return 12;
+    }
+    memset(&b, 0, sizeof(b));
+    b.table = &table;
+    b.present = &present;
+    b.absent = &absent;
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("{\n  \"results\": [");
+    else if (g_outputFormat == BMK_format_human)
+        DISPLAYRESULT("%u keys of %u-%u bytes, %u slots (load %.2f) \n", (U32)nbKeys, (U32)minLength, (U32)maxLength,
+                      (U32)capacity, (double)nbKeys / (double)capacity);
+
+    for (idx=0; idx<NB_HASH_CANDIDATES; idx++) {
+        const BMK_hashCandidate* const candidate = g_hashCandidates + idx;
+        double nsPerOp[BMK_op_max];
+        b.h = candidate->func;
+        BMK_minOfRuns(BMK_runTableOp, &b, (int)idx, candidate->name, g_tableOpNames, BMK_op_max, nsPerOp);
+        BMK_displayTableResults(candidate->name, &b, nsPerOp, (double)nbKeys / (double)capacity, &first);
+    }
+    if (BMK_benchTableMap(&b, &first)) DISPLAY("\nError: not enough memory for xxh_map!\n");
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+    free(table.slots);
+    BMK_freeKeys(&present);
+    BMK_freeKeys(&absent);
+    return 0;
+}
+
+
+/* ********************************************************
+*  Bloom filter workload
+**********************************************************/
+
+#define BLOOM_DEFAULT_BITS_PER_KEY 10
+
+/* Classic Bloom filter, as usually written around XXH64() :
+ * one seeded hash per probe, each probe in a different cache line.
+ * Reference for xxh_bloom.h, with the same size and number of probes. */
+typedef struct {
+    BYTE* bits;
+    U64 nbBits;
+    U32 nbProbes;
+} BMK_classicBloom;
+
+static void BMK_classicAdd(BMK_classicBloom* bf, const void* key, size_t length)
+{
+    U32 i;
+    for (i=0; i<bf->nbProbes; i++) {
+        U64 const bit = XXH64(key, length, i) % bf->nbBits;
+        bf->bits[bit >> 3] |= (BYTE)(1 << (bit & 7));
+    }
+}
+
+static int BMK_classicMayContain(const BMK_classicBloom* bf, const void* key, size_t length)
+{
+    U32 i;
+    for (i=0; i<bf->nbProbes; i++) {
+        U64 const bit = XXH64(key, length, i) % bf->nbBits;
+        if (!(bf->bits[bit >> 3] & (1 << (bit & 7)))) return 0;
+    }
+    return 1;
+}
+
+typedef enum { BMK_bloom_classic, BMK_bloom_blocked, BMK_bloom_batch, BMK_bloom_max } BMK_bloomVariant_e;
+static const char* const g_bloomVariantNames[BMK_bloom_max] = { "classic", "blocked", "blocked-batch" };
+
+typedef struct {
+    BMK_classicBloom classic;
+    XXH_bloom_t* blocked;
+    const void** keyPtrs;        /* batch arguments, BMK_op_max * nbKeys, indexed by operation */
+    size_t* keyLengths;
+    unsigned char* results;
+    const BMK_keyCorpus* present;
+    const BMK_keyCorpus* absent;
+    size_t positives[BMK_op_max];   /* nb of keys reported as possibly present (lookups only) */
+} BMK_bloomBench;
+
+/* BMK_runBloomOp() :
+ * runs one operation over all keys, once. insert starts from an empty filter.
+ * @return : duration, in ns */
+static U64 BMK_runBloomOp(void* bench, int variant, int op, size_t* nbOps)
+{
+    BMK_bloomBench* const b = (BMK_bloomBench*)bench;
+    size_t const nbKeys = b->present->nbKeys;
+    const BMK_key* const keys = (op == BMK_op_insert) ? b->present->keys
+                              : (op == BMK_op_hit) ? b->present->shuffled : b->absent->keys;
+    size_t positives = 0;
+    BMK_time_t tStart;
+    U64 nanos;
+    size_t n;
+
+    if (op == BMK_op_insert) {
+        memset(b->classic.bits, 0, (size_t)(b->classic.nbBits / 8));
+        XXH_bloom_clear(b->blocked);
+    }
+    tStart = BMK_getTime();
+    switch (variant)
+    {
+    case BMK_bloom_classic:
+        for (n=0; n<nbKeys; n++) {
+            if (op == BMK_op_insert) BMK_classicAdd(&b->classic, keys[n].start, keys[n].length);
+            else positives += (size_t)BMK_classicMayContain(&b->classic, keys[n].start, keys[n].length);
+        }
+        break;
+    case BMK_bloom_blocked:
+        for (n=0; n<nbKeys; n++) {
+            if (op == BMK_op_insert) XXH_bloom_add(b->blocked, keys[n].start, keys[n].length);
+            else positives += (size_t)XXH_bloom_mayContain(b->blocked, keys[n].start, keys[n].length);
+        }
+        break;
+    case BMK_bloom_batch:
+        {   const void** const ptrs = b->keyPtrs + (size_t)op * nbKeys;
+            const size_t* const lengths = b->keyLengths + (size_t)op * nbKeys;
+            if (op == BMK_op_insert) XXH_bloom_addBatch(b->blocked, ptrs, lengths, nbKeys);
+            else positives = XXH_bloom_mayContainBatch(b->blocked, ptrs, lengths, nbKeys, b->results);
+        }
+        break;
+    case BMK_bloom_max:
+    default:
+        break;
+    }
+    nanos = BMK_clockSpanNano(tStart);
+    b->positives[op] = positives;
+    *nbOps = nbKeys;
+    return nanos ? nanos : 1;
+}
+
+static void BMK_displayBloomResult(const char* variantName, BMK_tableOp_e op, size_t nbKeys,
+                                   double nsPerOp, size_t nbPositives, int first)
+{
+    double const mops = 1000. / nsPerOp;
+    double const positivePct = (op == BMK_op_insert) ? 0. : (double)nbPositives * 100. / (double)nbKeys;
+    if (g_outputFormat == BMK_format_human) {
+        DISPLAYRESULT("%-14s %-11s : %8.2f ns/op %8.2f Mops/s", variantName, g_tableOpNames[op], nsPerOp, mops);
+        if (op != BMK_op_insert) DISPLAYRESULT("   positives %7.3f%%", positivePct);
+        DISPLAYRESULT(" \n");
+    } else {
+        BMK_field fields[6];
+        BMK_setStr(fields+0, "filter", variantName);
+        BMK_setStr(fields+1, "operation", g_tableOpNames[op]);
+        BMK_setNum(fields+2, "nb_keys", (double)nbKeys, 0);
+        BMK_setNum(fields+3, "ns_per_op", nsPerOp, 3);
+        BMK_setNum(fields+4, "Mops", mops, 3);
+        BMK_setNum(fields+5, "positive_pct", positivePct, 4);
+        BMK_displayFields(fields, 6, first);
+    }
+}
+
+/* BMK_benchBloom() :
+ * Compares the cache-blocked Bloom filter of xxh_bloom.h, with single and batch calls,
+ * to a classic Bloom filter of the same size : insert all keys,
+ * look them all up in random order, then look up as many absent keys.
+ * Positives of lookup-miss are the false positive rate.
+ * Keys are the same as for BMK_benchTable().
+ * @return : 0 on success, error code otherwise */
+static int BMK_benchBloom(size_t nbKeys, U32 bitsPerKey, size_t minLength, size_t maxLength,
+                          const char* keysFileName, BMK_keysFormat_e keysFormat)
+{
+    BMK_keyCorpus present, absent;
+    BMK_bloomBench b;
+    int first = 1;
+    int variant;
+
+    {   int const prepError = BMK_prepareLookupKeys(&present, &absent, &nbKeys, &minLength, &maxLength,
+                                                    keysFileName, keysFormat);
+        if (prepError) return prepError;
+    }
+
+    memset(&b, 0, sizeof(b));
+    b.present = &present;
+    b.absent = &absent;
+    b.blocked = XXH_bloom_create(nbKeys, bitsPerKey, 0);
+    if (b.blocked) {
+        b.classic.nbBits = (U64)b.blocked->nbBlocks * XXH_BLOOM_BLOCK_SIZE * 8;
+        b.classic.nbProbes = b.blocked->nbProbes;
+        b.classic.bits = (BYTE*)malloc(b.blocked->nbBlocks * XXH_BLOOM_BLOCK_SIZE);
+    }
+    b.keyPtrs = (const void**)malloc(BMK_op_max * nbKeys * sizeof(*b.keyPtrs));
+    b.keyLengths = (size_t*)malloc(BMK_op_max * nbKeys * sizeof(*b.keyLengths));
+    b.results = (unsigned char*)malloc(nbKeys);
+    if (!b.blocked || !b.classic.bits || !b.keyPtrs || !b.keyLengths || !b.results) {
+        DISPLAY("\nError: not enough memory!\n");
+        XXH_bloom_free(b.blocked); free(b.classic.bits);
+        free(b.keyPtrs); free(b.keyLengths); free(b.results);
+        BMK_freeKeys(&present); BMK_freeKeys(&absent);
+        return 12;
+    }
+    {   size_t n;
+        for (n=0; n<nbKeys; n++) {
+            b.keyPtrs[n] = present.keys[n].start;
+            b.keyLengths[n] = present.keys[n].length;
+            b.keyPtrs[nbKeys + n] = present.shuffled[n].start;
+            b.keyLengths[nbKeys + n] = present.shuffled[n].length;
+            b.keyPtrs[2*nbKeys + n] = absent.keys[n].start;
+            b.keyLengths[2*nbKeys + n] = absent.keys[n].length;
+    }   }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("{\n  \"results\": [");
+    else if (g_outputFormat == BMK_format_human)
+        DISPLAYRESULT("%u keys of %u-%u bytes, %u bits per key : %u KB, %u probes per key \n",
+                      (U32)nbKeys, (U32)minLength, (U32)maxLength, bitsPerKey,
+                      (U32)((b.blocked->nbBlocks * XXH_BLOOM_BLOCK_SIZE) >> 10), b.blocked->nbProbes);
+
+    for (variant=0; variant<BMK_bloom_max; variant++) {
+        double nsPerOp[BMK_op_max];
+        int op;
+        BMK_minOfRuns(BMK_runBloomOp, &b, variant, g_bloomVariantNames[variant], g_tableOpNames, BMK_op_max, nsPerOp);
+        for (op=0; op<BMK_op_max; op++) {
+            BMK_displayBloomResult(g_bloomVariantNames[variant], (BMK_tableOp_e)op, nbKeys, nsPerOp[op], b.positives[op], first);
+            first = 0;
+    }   }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+    XXH_bloom_free(b.blocked);
+    free(b.classic.bits);
+    free(b.keyPtrs);
+    free(b.keyLengths);
+    free(b.results);
+    BMK_freeKeys(&present);
+    BMK_freeKeys(&absent);
+    return 0;
+}
+
+
+/* ********************************************************
+*  HyperLogLog workload
+**********************************************************/
+
+#define HLL_DEFAULT_PRECISION 14
+#define HLL_NB_SHARDS         64
+#define HLL_NB_ESTIMATES      64   /* per measurement : a single estimate is too short to time */
+
+typedef enum { BMK_hll_add, BMK_hll_addBatch, BMK_hll_merge, BMK_hll_estimate, BMK_hll_max } BMK_hllOp_e;
+static const char* const g_hllOpNames[BMK_hll_max] = { "add", "add-batch", "merge", "estimate" };
+
+typedef struct {
+    XXH_hll_t* sketch;                 /* add, add-batch */
+    XXH_hll_t* shards[HLL_NB_SHARDS];  /* dense, merged into `merged` */
+    XXH_hll_t* merged;
+    const void** keyPtrs;
+    size_t* keyLengths;
+    const BMK_keyCorpus* keys;
+    unsigned precision;
+    double estimateSum;
+} BMK_hllBench;
+
+/* BMK_runHllOp() :
+ * add and add-batch insert all keys into a new sketch, merge merges all shards into an empty sketch,
+ * estimate estimates the merged sketch HLL_NB_ESTIMATES times.
+ * *nbOps : nb of operations measured
+ * @return : duration, in ns, or 0 on allocation failure */
+static U64 BMK_runHllOp(void* bench, int variant, int op, size_t* nbOps)
+{
+    BMK_hllBench* const b = (BMK_hllBench*)bench;
+    const BMK_keyCorpus* const keys = b->keys;
+    size_t const nbKeys = keys->nbKeys;
+    BMK_time_t tStart;
+    U64 nanos;
+    size_t n;
+    int error = 0;
+
+    (void)variant;
+    if ((op == BMK_hll_add) || (op == BMK_hll_addBatch)) {
+        XXH_hll_free(b->sketch);
+        b->sketch = XXH_hll_create(b->precision, 0);
+        if (b->sketch == NULL) return 0;
+    }
+    if (op == BMK_hll_merge) XXH_hll_clear(b->merged);
+    tStart = BMK_getTime();
+    switch (op)
+    {
+    case BMK_hll_add:
+        for (n=0; n<nbKeys; n++) error |= XXH_hll_add(b->sketch, keys->keys[n].start, keys->keys[n].length);
+        *nbOps = nbKeys;
+        break;
+    case BMK_hll_addBatch:
+        error = XXH_hll_addBatch(b->sketch, b->keyPtrs, b->keyLengths, nbKeys);
+        *nbOps = nbKeys;
+        break;
+    case BMK_hll_merge:
+        for (n=0; n<HLL_NB_SHARDS; n++) error |= XXH_hll_merge(b->merged, b->shards[n]);
+        *nbOps = HLL_NB_SHARDS;
+        break;
+    case BMK_hll_estimate:
+        {   double total = 0.;
+            for (n=0; n<HLL_NB_ESTIMATES; n++) total += XXH_hll_estimate(b->merged);
+            b->estimateSum = total;   /* keeps estimates alive */
+        }
+        *nbOps = HLL_NB_ESTIMATES;
+        break;
+    case BMK_hll_max:
+    default:
+        *nbOps = 1;
+        break;
+    }
+    nanos = BMK_clockSpanNano(tStart);
+    if (error) return 0;
+    return nanos ? nanos : 1;
+}
+
+static void BMK_displayHllResult(BMK_hllOp_e op, size_t nbKeys, unsigned precision,
+                                 double nsPerOp, double estimate, int first)
+{
+    double const mops = 1000. / nsPerOp;
+    double const errorPct = (op == BMK_hll_estimate) ? (estimate - (double)nbKeys) * 100. / (double)nbKeys : 0.;
+    if (g_outputFormat == BMK_format_human) {
+        DISPLAYRESULT("%-10s : %10.2f ns/op %8.2f Mops/s", g_hllOpNames[op], nsPerOp, mops);
+        if (op == BMK_hll_merge)
+            DISPLAYRESULT("   %6.2f GB/s", (double)((size_t)1 << precision) / nsPerOp);
+        if (op == BMK_hll_estimate)
+            DISPLAYRESULT("   %.0f distinct, error %+.3f%%", estimate, errorPct);
+        DISPLAYRESULT(" \n");
+    } else {
+        BMK_field fields[6];
+        BMK_setStr(fields+0, "operation", g_hllOpNames[op]);
+        BMK_setNum(fields+1, "nb_keys", (double)nbKeys, 0);
+        BMK_setNum(fields+2, "precision", (double)precision, 0);
+        BMK_setNum(fields+3, "ns_per_op", nsPerOp, 3);
+        BMK_setNum(fields+4, "Mops", mops, 3);
+        BMK_setNum(fields+5, "error_pct", errorPct, 4);
+        BMK_displayFields(fields, 6, first);
+    }
+}
+
+/* BMK_benchHll() :
+ * Measures the HyperLogLog sketch of xxh_hll.h : adding all keys one by one, then by batch,
+ * merging HLL_NB_SHARDS dense shards (keys distributed round-robin), and estimating the merged sketch.
+ * The estimation error is relative to the nb of keys, which are assumed distinct.
+ * Keys are the same as for BMK_benchTable().
+ * @return : 0 on success, error code otherwise */
+static int BMK_benchHll(size_t nbKeys, unsigned precision, size_t minLength, size_t maxLength,
+                        const char* keysFileName, BMK_keysFormat_e keysFormat)
+{
+    BMK_keyCorpus present, absent;
+    BMK_hllBench b;
+    double nsPerOp[BMK_hll_max];
+    double estimate;
+    size_t serializedSize = 0;
+    int error = 0;
+    int op;
+
+    {   int const prepError = BMK_prepareLookupKeys(&present, &absent, &nbKeys, &minLength, &maxLength,
+                                                    keysFileName, keysFormat);
+        if (prepError) return prepError;
+        BMK_freeKeys(&absent);
+    }
+
+    memset(&b, 0, sizeof(b));
+    b.keys = &present;
+    b.precision = precision;
+    b.merged = XXH_hll_create(precision, 0);
+    b.keyPtrs = (const void**)malloc(nbKeys * sizeof(*b.keyPtrs));
+    b.keyLengths = (size_t*)malloc(nbKeys * sizeof(*b.keyLengths));
+    error = !b.merged || !b.keyPtrs || !b.keyLengths;
+    {   int s;
+        for (s=0; s<HLL_NB_SHARDS; s++) {
+            b.shards[s] = XXH_hll_create(precision, 0);
+            error |= (b.shards[s] == NULL) || XXH_hll_densify(b.shards[s]);
+    }   }
+    if (!error) {
+        size_t n;
+        for (n=0; n<nbKeys; n++) {
+            b.keyPtrs[n] = present.keys[n].start;
+            b.keyLengths[n] = present.keys[n].length;
+            error |= XXH_hll_add(b.shards[n % HLL_NB_SHARDS], b.keyPtrs[n], b.keyLengths[n]);
+        }
+        error |= XXH_hll_densify(b.merged);
+    }
+
+    if (!error) error = BMK_minOfRuns(BMK_runHllOp, &b, 0, "", g_hllOpNames, BMK_hll_max, nsPerOp);
+
+    if (error) {
+        DISPLAY("\nError: not enough memory!\n");
+    } else {
+        estimate = XXH_hll_estimate(b.merged);
+        serializedSize = XXH_hll_serializedSize(b.merged);
+        if (g_outputFormat == BMK_format_json) DISPLAYRESULT("{\n  \"results\": [");
+        else if (g_outputFormat == BMK_format_human)
+            DISPLAYRESULT("%u keys of %u-%u bytes, precision %u : %u registers, %u bytes serialized \n",
+                          (U32)nbKeys, (U32)minLength, (U32)maxLength, precision,
+                          1U << precision, (U32)serializedSize);
+        for (op=0; op<BMK_hll_max; op++)
+            BMK_displayHllResult((BMK_hllOp_e)op, nbKeys, precision, nsPerOp[op], estimate, op==0);
+        if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+    }
+
+    XXH_hll_free(b.sketch);
+    XXH_hll_free(b.merged);
+    {   int s;
+        for (s=0; s<HLL_NB_SHARDS; s++) XXH_hll_free(b.shards[s]);
+    }
+    free(b.keyPtrs);
+    free(b.keyLengths);
+    BMK_freeKeys(&present);
+    return error ? 12 : 0;
+}
+
+
+/* ********************************************************
+*  Frequency sketch workload
+**********************************************************/
+
+#define CMS_DEFAULT_WIDTH (1 << 16)
+#define CMS_DEFAULT_DEPTH 4
+#define CMS_TOPK          10
+#define CMS_TOPK_TRACKED  1024   /* SpaceSaving needs many spare entries for a good recall */
+#define CMS_KEY_PREFIX    16                /* bytes kept per tracked item */
+
+/* Count-min sketch as usually written around XXH64() :
+ * one seeded hash per row. Reference for xxh_cms.h, with the same width and depth. */
+static void BMK_seededCmsUpdate(U32* counters, size_t width, U32 depth, const void* key, size_t length)
+{
+    U32 i;
+    for (i=0; i<depth; i++) counters[i*width + (size_t)(XXH64(key, length, i) & (width-1))]++;
+}
+
+static U32 BMK_seededCmsEstimate(const U32* counters, size_t width, U32 depth, const void* key, size_t length)
+{
+    U32 minCount = (U32)-1;
+    U32 i;
+    for (i=0; i<depth; i++) minCount = MIN(minCount, counters[i*width + (size_t)(XXH64(key, length, i) & (width-1))]);
+    return minCount;
+}
+
+typedef enum { BMK_cms_seeded, BMK_cms_countMin, BMK_cms_batch, BMK_cms_conservative,
+               BMK_cms_countSketch, BMK_cms_topk, BMK_cms_max } BMK_cmsVariant_e;
+static const char* const g_cmsVariantNames[BMK_cms_max] = { "XXH64 x depth", "count-min", "count-min batch",
+                                                            "conservative", "count-sketch", "conservative+top-k" };
+
+typedef struct {
+    U32* seeded;                 /* BMK_cms_seeded counters */
+    XXH_cms_t* countMin;         /* count-min, batch, conservative, top-k */
+    XXH_cms_t* countSketch;
+    XXH_topk_t* topk;
+    const void** eventPtrs;
+    size_t* eventLengths;
+    size_t nbEvents;
+} BMK_cmsBench;
+
+/* BMK_runCmsOp() :
+ * counts all events once, into empty sketches.
+ * @return : duration, in ns */
+static U64 BMK_runCmsOp(void* bench, int variant, int op, size_t* nbOps)
+{
+    BMK_cmsBench* const b = (BMK_cmsBench*)bench;
+    size_t const nbEvents = b->nbEvents;
+    BMK_time_t tStart;
+    U64 nanos;
+    size_t n;
+
+    (void)op;
+    memset(b->seeded, 0, b->countMin->width * b->countMin->depth * sizeof(U32));
+    XXH_cms_clear(b->countMin);
+    XXH_cms_clear(b->countSketch);
+    XXH_topk_clear(b->topk);
+    tStart = BMK_getTime();
+    switch (variant)
+    {
+    case BMK_cms_seeded:
+        for (n=0; n<nbEvents; n++)
+            BMK_seededCmsUpdate(b->seeded, b->countMin->width, b->countMin->depth, b->eventPtrs[n], b->eventLengths[n]);
+        break;
+    case BMK_cms_countMin:
+        for (n=0; n<nbEvents; n++) XXH_cms_update(b->countMin, b->eventPtrs[n], b->eventLengths[n], 1);
+        break;
+    case BMK_cms_batch:
+        XXH_cms_updateBatch(b->countMin, b->eventPtrs, b->eventLengths, nbEvents, 1);
+        break;
+    case BMK_cms_conservative:
+        for (n=0; n<nbEvents; n++) XXH_cms_updateConservative(b->countMin, b->eventPtrs[n], b->eventLengths[n], 1);
+        break;
+    case BMK_cms_countSketch:
+        for (n=0; n<nbEvents; n++) XXH_cms_update(b->countSketch, b->eventPtrs[n], b->eventLengths[n], 1);
+        break;
+    case BMK_cms_topk:
+        for (n=0; n<nbEvents; n++) {
+            XXH64_hash_t const h = XXH64(b->eventPtrs[n], b->eventLengths[n], 0);
+            XXH_cms_updateConservativeHash(b->countMin, h, 1);
+            XXH_topk_addHash(b->topk, h, b->eventPtrs[n], b->eventLengths[n], 1);
+        }
+        break;
+    case BMK_cms_max:
+    default:
+        break;
+    }
+    nanos = BMK_clockSpanNano(tStart);
+    *nbOps = nbEvents;
+    return nanos ? nanos : 1;
+}
+
+/* BMK_cmsAverageError() : average absolute estimation error over all keys, after BMK_runCmsOp(variant) */
+static double BMK_cmsAverageError(const BMK_cmsBench* b, BMK_cmsVariant_e variant,
+                                  const BMK_keyCorpus* keys, const U32* truth)
+{
+    double total = 0.;
+    size_t n;
+    for (n=0; n<keys->nbKeys; n++) {
+        const BMK_key* const k = keys->keys + n;
+        long long estimate;
+        if (variant == BMK_cms_seeded)
+            estimate = BMK_seededCmsEstimate(b->seeded, b->countMin->width, b->countMin->depth, k->start, k->length);
+        else
+            estimate = XXH_cms_estimate((variant == BMK_cms_countSketch) ? b->countSketch : b->countMin, k->start, k->length);
+        total += (estimate > (long long)truth[n]) ? (double)(estimate - truth[n]) : (double)((long long)truth[n] - estimate);
+    }
+    return total / (double)keys->nbKeys;
+}
+
+typedef struct { U32 count; U32 keyNb; } BMK_keyCount;
+
+static int BMK_compareKeyCounts(const void* a, const void* b)
+{
+    U32 const ca = ((const BMK_keyCount*)a)->count;
+    U32 const cb = ((const BMK_keyCount*)b)->count;
+    return (ca < cb) - (ca > cb);   /* decreasing counts */
+}
+
+/* BMK_topkRecall() : nb of the CMS_TOPK most frequent keys among the CMS_TOPK first entries of b->topk
+ * @return : recall, in %, or -1 on allocation failure */
+static double BMK_topkRecall(const BMK_cmsBench* b, const BMK_keyCorpus* keys, const U32* truth)
+{
+    BMK_keyCount* const counts = (BMK_keyCount*)malloc(keys->nbKeys * sizeof(BMK_keyCount));
+    XXH_topk_entry_t entries[CMS_TOPK];
+    size_t const nbTop = MIN(keys->nbKeys, CMS_TOPK);
+    size_t nbEntries, found = 0, n, e;
+    if (counts == NULL) return -1.;
+    for (n=0; n<keys->nbKeys; n++) { counts[n].count = truth[n]; counts[n].keyNb = (U32)n; }
+    qsort(counts, keys->nbKeys, sizeof(BMK_keyCount), BMK_compareKeyCounts);
+    nbEntries = XXH_topk_list(b->topk, entries, CMS_TOPK);
+    for (n=0; n<nbTop; n++) {
+        const BMK_key* const k = keys->keys + counts[n].keyNb;
+        XXH64_hash_t const h = XXH64(k->start, k->length, 0);
+        for (e=0; e<nbEntries; e++) if (entries[e].hash == h) { found++; break; }
+    }
+    free(counts);
+    return (double)found * 100. / (double)nbTop;
+}
+
+static void BMK_displayCmsResult(BMK_cmsVariant_e variant, size_t nbEvents, size_t width, U32 depth,
+                                 double nsPerEvent, double avgError, double recall, int first)
+{
+    double const mops = 1000. / nsPerEvent;
+    if (g_outputFormat == BMK_format_human) {
+        DISPLAYRESULT("%-18s : %8.2f ns/event %8.2f Mevents/s   avg error %8.2f", g_cmsVariantNames[variant],
+                      nsPerEvent, mops, avgError);
+        if (recall >= 0.) DISPLAYRESULT("   top-%u recall %5.1f%%", CMS_TOPK, recall);
+        DISPLAYRESULT(" \n");
+    } else {
+        BMK_field fields[8];
+        BMK_setStr(fields+0, "variant", g_cmsVariantNames[variant]);
+        BMK_setNum(fields+1, "nb_events", (double)nbEvents, 0);
+        BMK_setNum(fields+2, "width", (double)width, 0);
+        BMK_setNum(fields+3, "depth", (double)depth, 0);
+        BMK_setNum(fields+4, "ns_per_event", nsPerEvent, 3);
+        BMK_setNum(fields+5, "Mevents", mops, 3);
+        BMK_setNum(fields+6, "avg_error", avgError, 3);
+        BMK_setNum(fields+7, "topk_recall_pct", recall, (recall >= 0.) ? 1 : BMK_FIELD_ABSENT);
+        BMK_displayFields(fields, 8, first);
+    }
+}
+
+/* BMK_benchCms() :
+ * Counts a skewed stream of events with the frequency sketches of xxh_cms.h,
+ * and with a count-min sketch using one seeded XXH64() per row.
+ * Events are drawn from the keys of BMK_benchTable(), the key of rank nbKeys * u^3 (u uniform in [0,1)),
+ * so that a few keys are very frequent. There are as many events as keys.
+ * Average error is measured over all keys, against exact counts.
+ * The top-k tracker follows CMS_TOPK_TRACKED items, and its recall is measured on the CMS_TOPK first ones.
+ * @return : 0 on success, error code otherwise */
+static int BMK_benchCms(size_t nbKeys, size_t width, U32 depth, size_t minLength, size_t maxLength,
+                        const char* keysFileName, BMK_keysFormat_e keysFormat)
+{
+    BMK_keyCorpus present, absent;
+    BMK_cmsBench b;
+    U32* truth;
+    int variant;
+
+    {   int const prepError = BMK_prepareLookupKeys(&present, &absent, &nbKeys, &minLength, &maxLength,
+                                                    keysFileName, keysFormat);
+        if (prepError) return prepError;
+        BMK_freeKeys(&absent);
+    }
+
+    memset(&b, 0, sizeof(b));
+    b.nbEvents = nbKeys;
+    b.countMin = XXH_cms_create(width, depth, XXH_cms_countMin, 0);
+    b.countSketch = XXH_cms_create(width, depth, XXH_cms_countSketch, 0);
+    b.topk = XXH_topk_create(CMS_TOPK_TRACKED, CMS_KEY_PREFIX, 0);
+    if (b.countMin) b.seeded = (U32*)malloc(b.countMin->width * depth * sizeof(U32));
+    b.eventPtrs = (const void**)malloc(nbKeys * sizeof(*b.eventPtrs));
+    b.eventLengths = (size_t*)malloc(nbKeys * sizeof(*b.eventLengths));
+    truth = (U32*)calloc(nbKeys, sizeof(U32));
+    if (!b.countMin || !b.countSketch || !b.topk || !b.seeded
+      || !b.eventPtrs || !b.eventLengths || !truth) {
+        DISPLAY("\nError: not enough memory!\n");
+        XXH_cms_free(b.countMin); XXH_cms_free(b.countSketch); XXH_topk_free(b.topk); free(b.seeded);
+        free(b.eventPtrs); free(b.eventLengths); free(truth);
+        BMK_freeKeys(&present);
+        return 12;
+    }
+    {   U32 rand32 = 2654435761U;
+        size_t n;
+        for (n=0; n<nbKeys; n++) {
+            double u;
+            size_t keyNb;
+            rand32 = rand32 * 1103515245U + 12345U;
+            u = (double)(rand32 >> 8) / (double)(1 << 24);
+            keyNb = MIN((size_t)((double)nbKeys * u * u * u), nbKeys - 1);
+            b.eventPtrs[n] = present.keys[keyNb].start;
+            b.eventLengths[n] = present.keys[keyNb].length;
+            truth[keyNb]++;
+    }   }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("{\n  \"results\": [");
+    else if (g_outputFormat == BMK_format_human)
+        DISPLAYRESULT("%u events over %u keys of %u-%u bytes, %u x %u counters : %u KB \n",
+                      (U32)nbKeys, (U32)nbKeys, (U32)minLength, (U32)maxLength, depth, (U32)b.countMin->width,
+                      (U32)((b.countMin->width * depth * sizeof(U32)) >> 10));
+
+    for (variant=0; variant<BMK_cms_max; variant++) {
+        double nsPerEvent;
+        double avgError, recall = -1.;
+        BMK_minOfRuns(BMK_runCmsOp, &b, variant, g_cmsVariantNames[variant], NULL, 1, &nsPerEvent);
+        avgError = BMK_cmsAverageError(&b, (BMK_cmsVariant_e)variant, &present, truth);
+        if (variant == BMK_cms_topk) recall = BMK_topkRecall(&b, &present, truth);
+        BMK_displayCmsResult((BMK_cmsVariant_e)variant, nbKeys, b.countMin->width, depth,
+                             nsPerEvent, avgError, recall, variant==0);
+    }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+    XXH_cms_free(b.countMin);
+    XXH_cms_free(b.countSketch);
+    XXH_topk_free(b.topk);
+    free(b.seeded);
+    free(b.eventPtrs);
+    free(b.eventLengths);
+    free(truth);
+    BMK_freeKeys(&present);
+    return 0;
+}
+
+
+/* ********************************************************
+*  MinHash workload
+**********************************************************/
+
+#define MINHASH_DEFAULT_SLOTS 128
+#define MINHASH_DOC_TOKENS    1000
+#define MINHASH_BBIT          8      /* b of the b-bit error column */
+
+/* MinHash as usually written around XXH64() :
+ * one seeded hash per slot. Reference for xxh_minhash.h, with the same nb of slots. */
+static void BMK_seededMinhashAdd(U32* signature, size_t nbSlots, const void* token, size_t length)
+{
+    size_t i;
+    for (i=0; i<nbSlots; i++) {
+        U32 const v = (U32)XXH64(token, length, i);
+        if (v < signature[i]) signature[i] = v;
+    }
+}
+
+typedef enum { BMK_mh_seeded, BMK_mh_kPerm, BMK_mh_kPermBatch, BMK_mh_onePerm, BMK_mh_max } BMK_minhashVariant_e;
+static const char* const g_minhashVariantNames[BMK_mh_max] = { "XXH64 x slots", "k-permutation",
+                                                               "k-permutation batch", "one-permutation" };
+
+typedef struct {
+    XXH_minhash_t* kPerm;
+    XXH_minhash_t* onePerm;
+    U32* signatures;          /* 2 per pair, nbSlots each */
+    const void** tokenPtrs;   /* batch arguments, in key order */
+    size_t* tokenLengths;
+    size_t nbSlots;
+    size_t nbPairs;
+    size_t docTokens;
+    size_t* shifts;           /* second document of pair p starts shifts[p] keys after the first */
+    const BMK_keyCorpus* keys;
+} BMK_minhashBench;
+
+/* BMK_runMinhashOp() :
+ * computes the signatures of both documents of all pairs, once.
+ * @return : duration, in ns */
+static U64 BMK_runMinhashOp(void* bench, int variant, int op, size_t* nbOps)
+{
+    BMK_minhashBench* const b = (BMK_minhashBench*)bench;
+    const BMK_keyCorpus* const keys = b->keys;
+    BMK_time_t tStart;
+    U64 nanos;
+    size_t p;
+    int d;
+
+    (void)op;
+    tStart = BMK_getTime();
+    for (p=0; p<b->nbPairs; p++) {
+        for (d=0; d<2; d++) {
+            size_t const first = p * 2 * b->docTokens + (d ? b->shifts[p] : 0);
+            U32* const sig = b->signatures + (2*p + (size_t)d) * b->nbSlots;
+            size_t n;
+            switch (variant)
+            {
+            case BMK_mh_seeded:
+                for (n=0; n<b->nbSlots; n++) sig[n] = XXH_MINHASH_EMPTY;
+                for (n=first; n<first + b->docTokens; n++)
+                    BMK_seededMinhashAdd(sig, b->nbSlots, keys->keys[n].start, keys->keys[n].length);
+                break;
+            case BMK_mh_kPerm:
+                XXH_minhash_init(b->kPerm, sig);
+                for (n=first; n<first + b->docTokens; n++)
+                    XXH_minhash_add(b->kPerm, sig, keys->keys[n].start, keys->keys[n].length);
+                break;
+            case BMK_mh_kPermBatch:
+                XXH_minhash_init(b->kPerm, sig);
+                XXH_minhash_addBatch(b->kPerm, sig, b->tokenPtrs + first, b->tokenLengths + first, b->docTokens);
+                break;
+            case BMK_mh_onePerm:
+                XXH_minhash_init(b->onePerm, sig);
+                for (n=first; n<first + b->docTokens; n++)
+                    XXH_minhash_add(b->onePerm, sig, keys->keys[n].start, keys->keys[n].length);
+                XXH_minhash_finalize(b->onePerm, sig);
+                break;
+            case BMK_mh_max:
+            default:
+                break;
+    }   }   }
+    nanos = BMK_clockSpanNano(tStart);
+    *nbOps = 2 * b->nbPairs * b->docTokens;
+    return nanos ? nanos : 1;
+}
+
+/* BMK_minhashErrors() : average absolute error of Jaccard estimates, over all pairs,
+ * from full signatures and from MINHASH_BBIT-bit signatures */
+static void BMK_minhashErrors(const BMK_minhashBench* b, double* error, double* bbitError)
+{
+    size_t const bbitSize = XXH_minhash_bbitSize(b->nbSlots, MINHASH_BBIT);
+    unsigned char* const bbit1 = (unsigned char*)malloc(bbitSize);
+    unsigned char* const bbit2 = (unsigned char*)malloc(bbitSize);
+    double total = 0., bbitTotal = 0.;
+    size_t p;
+    for (p=0; p<b->nbPairs; p++) {
+        const U32* const sig1 = b->signatures + 2*p * b->nbSlots;
+        const U32* const sig2 = sig1 + b->nbSlots;
+        double const jaccard = (double)(b->docTokens - b->shifts[p]) / (double)(b->docTokens + b->shifts[p]);
+        double const estimate = XXH_minhash_similarity(sig1, sig2, b->nbSlots);
+        total += (estimate > jaccard) ? estimate - jaccard : jaccard - estimate;
+        if (bbit1 && bbit2) {
+            double bbitEstimate;
+            XXH_minhash_toBbit(sig1, b->nbSlots, MINHASH_BBIT, bbit1);
+            XXH_minhash_toBbit(sig2, b->nbSlots, MINHASH_BBIT, bbit2);
+            bbitEstimate = XXH_minhash_similarityBbit(bbit1, bbit2, b->nbSlots, MINHASH_BBIT);
+            bbitTotal += (bbitEstimate > jaccard) ? bbitEstimate - jaccard : jaccard - bbitEstimate;
+    }   }
+    *error = total / (double)b->nbPairs;
+    *bbitError = (bbit1 && bbit2) ? bbitTotal / (double)b->nbPairs : -1.;
+    free(bbit1);
+    free(bbit2);
+}
+
+static void BMK_displayMinhashResult(BMK_minhashVariant_e variant, size_t nbTokens, size_t nbSlots,
+                                     double nsPerToken, double error, double bbitError, int first)
+{
+    double const mops = 1000. / nsPerToken;
+    if (g_outputFormat == BMK_format_human) {
+        DISPLAYRESULT("%-19s : %9.2f ns/token %8.2f Mtokens/s   avg error %.4f (%u-bit %.4f) \n",
+                      g_minhashVariantNames[variant], nsPerToken, mops, error, MINHASH_BBIT, bbitError);
+    } else {
+        char bbitKey[32];
+        BMK_field fields[7];
+        sprintf(bbitKey, "avg_error_%ubit", MINHASH_BBIT);
+        BMK_setStr(fields+0, "variant", g_minhashVariantNames[variant]);
+        BMK_setNum(fields+1, "nb_tokens", (double)nbTokens, 0);
+        BMK_setNum(fields+2, "slots", (double)nbSlots, 0);
+        BMK_setNum(fields+3, "ns_per_token", nsPerToken, 3);
+        BMK_setNum(fields+4, "Mtokens", mops, 3);
+        BMK_setNum(fields+5, "avg_error", error, 4);
+        BMK_setNum(fields+6, bbitKey, bbitError, 4);
+        BMK_displayFields(fields, 7, first);
+    }
+}
+
+/* BMK_benchMinhash() :
+ * Computes MinHash signatures of pairs of documents with xxh_minhash.h,
+ * and with one seeded XXH64() per slot.
+ * Documents are runs of MINHASH_DOC_TOKENS consecutive keys (the keys of BMK_benchTable()),
+ * the second document of each pair being shifted, for Jaccard similarities from 0.9 down to 0.1.
+ * Average errors compare estimated similarities with exact ones, assuming keys are distinct.
+ * @return : 0 on success, error code otherwise */
+static int BMK_benchMinhash(size_t nbKeys, size_t nbSlots, size_t minLength, size_t maxLength,
+                            const char* keysFileName, BMK_keysFormat_e keysFormat)
+{
+    static const double targets[] = { 0.9, 0.7, 0.5, 0.3, 0.1 };
+    BMK_keyCorpus present, absent;
+    BMK_minhashBench b;
+    int variant;
+
+    {   int const prepError = BMK_prepareLookupKeys(&present, &absent, &nbKeys, &minLength, &maxLength,
+                                                    keysFileName, keysFormat);
+        if (prepError) return prepError;
+        BMK_freeKeys(&absent);
+    }
+    if (nbKeys < 4) {
+        DISPLAY("\nError: not enough keys for a pair of documents!\n");
+        BMK_freeKeys(&present);
+        return 1;
+    }
+
+    memset(&b, 0, sizeof(b));
+    b.keys = &present;
+    b.nbSlots = nbSlots;
+    b.docTokens = MIN(MINHASH_DOC_TOKENS, nbKeys / 2);
+    b.nbPairs = nbKeys / (2 * b.docTokens);
+    b.kPerm = XXH_minhash_create(nbSlots, XXH_minhash_kPermutations, 0);
+    b.onePerm = XXH_minhash_create(nbSlots, XXH_minhash_onePermutation, 0);
+    b.signatures = (U32*)malloc(2 * b.nbPairs * nbSlots * sizeof(U32));
+    b.tokenPtrs = (const void**)malloc(nbKeys * sizeof(*b.tokenPtrs));
+    b.tokenLengths = (size_t*)malloc(nbKeys * sizeof(*b.tokenLengths));
+    b.shifts = (size_t*)malloc(b.nbPairs * sizeof(*b.shifts));
+    if (!b.kPerm || !b.onePerm || !b.signatures || !b.tokenPtrs || !b.tokenLengths || !b.shifts) {
+        DISPLAY("\nError: not enough memory!\n");
+        XXH_minhash_free(b.kPerm); XXH_minhash_free(b.onePerm); free(b.signatures);
+        free(b.tokenPtrs); free(b.tokenLengths); free(b.shifts);
+        BMK_freeKeys(&present);
+        return 12;
+    }
+    {   size_t n;
+        for (n=0; n<nbKeys; n++) {
+            b.tokenPtrs[n] = present.keys[n].start;
+            b.tokenLengths[n] = present.keys[n].length;
+        }
+        /* Jaccard (docTokens - shift) / (docTokens + shift) */
+        for (n=0; n<b.nbPairs; n++) {
+            double const j = targets[n % (sizeof(targets) / sizeof(targets[0]))];
+            b.shifts[n] = (size_t)((double)b.docTokens * (1. - j) / (1. + j) + 0.5);
+    }   }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("{\n  \"results\": [");
+    else if (g_outputFormat == BMK_format_human)
+        DISPLAYRESULT("%u pairs of %u-token documents, tokens of %u-%u bytes, %u slots \n",
+                      (U32)b.nbPairs, (U32)b.docTokens, (U32)minLength, (U32)maxLength, (U32)nbSlots);
+
+    for (variant=0; variant<BMK_mh_max; variant++) {
+        size_t const nbTokens = 2 * b.nbPairs * b.docTokens;
+        double nsPerToken;
+        double error, bbitError;
+        BMK_minOfRuns(BMK_runMinhashOp, &b, variant, g_minhashVariantNames[variant], NULL, 1, &nsPerToken);
+        BMK_minhashErrors(&b, &error, &bbitError);
+        BMK_displayMinhashResult((BMK_minhashVariant_e)variant, nbTokens, nbSlots, nsPerToken, error, bbitError, variant==0);
+    }
+
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+    XXH_minhash_free(b.kPerm);
+    XXH_minhash_free(b.onePerm);
+    free(b.signatures);
+    free(b.tokenPtrs);
+    free(b.tokenLengths);
+    free(b.shifts);
+    BMK_freeKeys(&present);
+    return 0;
+}
+
+
+/* ********************************************************
+*  Companion modules self-test (--selftest)
+**********************************************************/
+
+#define SELFTEST_NB_KEYS 20000
+#define SELFTEST_SLOTS   128   /* MinHash signature length */
+
+typedef struct {
+    U64 values[2*SELFTEST_NB_KEYS];   /* SELFTEST_NB_KEYS keys, then as many keys never inserted */
+    const void* ptrs[2*SELFTEST_NB_KEYS];
+    size_t lengths[2*SELFTEST_NB_KEYS];
+} BMK_selfTestKeys;
+
+/* BMK_selfCheck() :
+ * @return : 0 if `ok`, 1 otherwise, after reporting the failed `check` */
+static int BMK_selfCheck(int ok, const char* module, const char* check)
+{
+    if (ok) return 0;
+    DISPLAY("Error: %s : %s \n", module, check);
+    return 1;
+}
+
+static int BMK_selfTestBloom(BMK_selfTestKeys* k)
+{
+    size_t const half = SELFTEST_NB_KEYS / 2;
+    XXH_bloom_t* const bf = XXH_bloom_create(SELFTEST_NB_KEYS, 10, 1);
+    XXH_bloom_t* const second = XXH_bloom_create(SELFTEST_NB_KEYS, 10, 1);
+    XXH_bloom_t* const otherSeed = XXH_bloom_create(SELFTEST_NB_KEYS, 10, 2);
+    BYTE* const results = (BYTE*)malloc(4*SELFTEST_NB_KEYS);   /* 2 result sets, present then absent keys */
+    int errors = 0;
+
+    if (!bf || !second || !otherSeed || !results) {
+        XXH_bloom_free(bf); XXH_bloom_free(second); XXH_bloom_free(otherSeed); free(results);
+        return BMK_selfCheck(0, "bloom", "not enough memory");
+    }
+
+    /* first half with batches, second half with single additions, merged */
+    XXH_bloom_addBatch(bf, k->ptrs, k->lengths, half);
+    {   size_t n, nbFound = 0;
+        for (n=half; n<SELFTEST_NB_KEYS; n++) XXH_bloom_add(second, k->ptrs[n], k->lengths[n]);
+        for (n=half; n<SELFTEST_NB_KEYS; n++) nbFound += (size_t)XXH_bloom_mayContain(second, k->ptrs[n], k->lengths[n]);
+        errors += BMK_selfCheck(nbFound == SELFTEST_NB_KEYS - half, "bloom", "false negative after XXH_bloom_add()");
+        errors += BMK_selfCheck(XXH_bloom_mayContainBatch(bf, k->ptrs, k->lengths, half, results) == half,
+                                "bloom", "false negative after XXH_bloom_addBatch()");
+    }
+    errors += BMK_selfCheck(XXH_bloom_merge(bf, second) == 0, "bloom", "merge of compatible filters failed");
+    errors += BMK_selfCheck(XXH_bloom_merge(bf, otherSeed) == 1, "bloom", "merge of filters with different seeds accepted");
+    {   size_t n, nbFound = 0, nbMismatches = 0, nbFalsePositives;
+        nbFalsePositives = XXH_bloom_mayContainBatch(bf, k->ptrs + SELFTEST_NB_KEYS, k->lengths + SELFTEST_NB_KEYS,
+                                                     SELFTEST_NB_KEYS, results + SELFTEST_NB_KEYS);
+        for (n=0; n<2*SELFTEST_NB_KEYS; n++) {
+            int const r = XXH_bloom_mayContain(bf, k->ptrs[n], k->lengths[n]);
+            if (n < SELFTEST_NB_KEYS) nbFound += (size_t)r;
+            else nbMismatches += (r != results[n]);
+        }
+        errors += BMK_selfCheck(nbFound == SELFTEST_NB_KEYS, "bloom", "false negative after XXH_bloom_merge()");
+        errors += BMK_selfCheck(nbMismatches == 0, "bloom", "XXH_bloom_mayContainBatch() differs from XXH_bloom_mayContain()");
+        errors += BMK_selfCheck(nbFalsePositives < SELFTEST_NB_KEYS / 30, "bloom", "false positive rate above 3%");   /* ~1% expected */
+    }
+
+    /* serialize -> deserialize -> serialize */
+    {   size_t const frameSize = XXH_bloom_serializedSize(bf);
+        BYTE* const frame1 = (BYTE*)malloc(frameSize);
+        BYTE* const frame2 = (BYTE*)malloc(frameSize);
+        XXH_bloom_t* copy = NULL;
+        if (frame1 && frame2) {
+            errors += BMK_selfCheck(XXH_bloom_serialize(bf, frame1, frameSize - 1) == 0, "bloom", "serialized into a too small buffer");
+            errors += BMK_selfCheck(XXH_bloom_serialize(bf, frame1, frameSize) == frameSize, "bloom", "serialized size");
+            errors += BMK_selfCheck(XXH_bloom_deserialize(frame1, frameSize - 1) == NULL, "bloom", "truncated frame accepted");
+            copy = XXH_bloom_deserialize(frame1, frameSize);
+        }
+        if (copy == NULL) {
+            errors += BMK_selfCheck(0, "bloom", "deserialization failed");
+        } else {
+            size_t n, nbMismatches = 0;
+            errors += BMK_selfCheck((XXH_bloom_serialize(copy, frame2, frameSize) == frameSize) && !memcmp(frame1, frame2, frameSize),
+                                    "bloom", "serialize -> deserialize -> serialize is not identical");
+            XXH_bloom_mayContainBatch(copy, k->ptrs, k->lengths, 2*SELFTEST_NB_KEYS, results + 2*SELFTEST_NB_KEYS);
+            for (n=0; n<SELFTEST_NB_KEYS; n++) nbMismatches += !results[2*SELFTEST_NB_KEYS + n];
+            for (n=SELFTEST_NB_KEYS; n<2*SELFTEST_NB_KEYS; n++) nbMismatches += (results[2*SELFTEST_NB_KEYS + n] != results[n]);
+            errors += BMK_selfCheck(nbMismatches == 0, "bloom", "deserialized filter answers differently");
+        }
+        XXH_bloom_free(copy);
+        free(frame1);
+        free(frame2);
+    }
+
+    XXH_bloom_free(bf);
+    XXH_bloom_free(second);
+    XXH_bloom_free(otherSeed);
+    free(results);
+    return errors;
+}
+
+static int BMK_selfTestMap(BMK_selfTestKeys* k)
+{
+    XXH_map_t* const map = XXH_map_create(sizeof(U64), 16, 1);   /* grows several times */
+    XXH_map_t* const strMap = XXH_map_create(0, 0, 1);
+    char* const strKeys = (char*)malloc(SELFTEST_NB_KEYS * 8);   /* decimal numbers, and copies */
+    BYTE* const visited = (BYTE*)calloc(SELFTEST_NB_KEYS, 1);
+    int errors = 0;
+
+    if (!map || !strMap || !strKeys || !visited) {
+        XXH_map_free(map); XXH_map_free(strMap); free(strKeys); free(visited);
+        return BMK_selfCheck(0, "map", "not enough memory");
+    }
+
+    {   size_t n, nbWrong = 0;
+        for (n=0; n<SELFTEST_NB_KEYS; n++) nbWrong += (XXH_map_insert(map, k->ptrs[n], k->lengths[n], k->values + n) != 1);
+        errors += BMK_selfCheck(nbWrong == 0, "map", "insertion of a new key");
+        for (n=0; n<SELFTEST_NB_KEYS; n++) nbWrong += (XXH_map_insert(map, k->ptrs[n], k->lengths[n], k->values + n) != 0);
+        errors += BMK_selfCheck(nbWrong == 0, "map", "insertion of a present key");
+        errors += BMK_selfCheck(XXH_map_size(map) == SELFTEST_NB_KEYS, "map", "size after insertions");
+        for (n=0; n<2*SELFTEST_NB_KEYS; n++) {
+            void** const v = XXH_map_find(map, k->ptrs[n], k->lengths[n]);
+            if (n < SELFTEST_NB_KEYS) nbWrong += (v == NULL) || (*v != k->values + n);
+            else nbWrong += (v != NULL);
+        }
+        errors += BMK_selfCheck(nbWrong == 0, "map", "find after insertion");
+        errors += BMK_selfCheck(XXH_map_findOrInsert(map, k->ptrs[0], 4, NULL) == NULL, "map", "key of wrong size accepted");
+    }
+
+    /* erase even keys, then find and iterate */
+    {   size_t n, nbWrong = 0;
+        for (n=0; n<SELFTEST_NB_KEYS; n+=2) nbWrong += (XXH_map_erase(map, k->ptrs[n], k->lengths[n]) != 1);
+        for (n=0; n<SELFTEST_NB_KEYS; n+=2) nbWrong += (XXH_map_erase(map, k->ptrs[n], k->lengths[n]) != 0);
+        errors += BMK_selfCheck(nbWrong == 0, "map", "erasure");
+        errors += BMK_selfCheck(XXH_map_size(map) == SELFTEST_NB_KEYS / 2, "map", "size after erasures");
+        for (n=0; n<SELFTEST_NB_KEYS; n++) {
+            void** const v = XXH_map_find(map, k->ptrs[n], k->lengths[n]);
+            if (n & 1) nbWrong += (v == NULL) || (*v != k->values + n);
+            else nbWrong += (v != NULL);
+        }
+        errors += BMK_selfCheck(nbWrong == 0, "map", "find after erasure");
+    }
+    {   size_t pos = 0, nbEntries = 0, nbWrong = 0;
+        const void* key;
+        size_t length;
+        void* value;
+        while (XXH_map_next(map, &pos, &key, &length, &value)) {
+            size_t const n = (size_t)((U64*)value - k->values);
+            nbEntries++;
+            if ((n >= SELFTEST_NB_KEYS) || !(n & 1) || visited[n] || (length != sizeof(U64)) || memcmp(key, k->ptrs[n], length)) {
+                nbWrong++;
+                continue;
+            }
+            visited[n] = 1;
+        }
+        errors += BMK_selfCheck((nbWrong == 0) && (nbEntries == SELFTEST_NB_KEYS / 2), "map", "XXH_map_next() entries");
+    }
+
+    /* re-insert erased keys, then erase everything while iterating */
+    {   size_t n, pos = 0, nbWrong = 0;
+        const void* key;
+        size_t length;
+        void* value;
+        for (n=0; n<SELFTEST_NB_KEYS; n+=2) nbWrong += (XXH_map_insert(map, k->ptrs[n], k->lengths[n], k->values + n) != 1);
+        errors += BMK_selfCheck((nbWrong == 0) && (XXH_map_size(map) == SELFTEST_NB_KEYS), "map", "insertion after erasure");
+        while (XXH_map_next(map, &pos, &key, &length, &value))
+            nbWrong += (XXH_map_erase(map, key, length) != 1);
+        errors += BMK_selfCheck((nbWrong == 0) && (XXH_map_size(map) == 0), "map", "erasure during iteration");
+    }
+
+    /* byte-string keys, compared by content */
+    {   size_t n, nbWrong = 0;
+        char* const copies = strKeys + SELFTEST_NB_KEYS / 2 * 8;
+        for (n=0; n<SELFTEST_NB_KEYS/2; n++) {
+            sprintf(strKeys + 8*n, "%u", (unsigned)n);
+            memcpy(copies + 8*n, strKeys + 8*n, 8);
+        }
+        nbWrong += (XXH_map_insert(strMap, "", 0, k->values) != 1);
+        for (n=0; n<SELFTEST_NB_KEYS/2; n++)
+            nbWrong += (XXH_map_insert(strMap, strKeys + 8*n, strlen(strKeys + 8*n), k->values + n) != 1);
+        for (n=0; n<SELFTEST_NB_KEYS/2; n++) {
+            void** const v = XXH_map_find(strMap, copies + 8*n, strlen(copies + 8*n));
+            nbWrong += (v == NULL) || (*v != k->values + n);
+            nbWrong += (XXH_map_find(strMap, copies + 8*n, strlen(copies + 8*n) + 1) != NULL);   /* with its terminating 0 */
+        }
+        errors += BMK_selfCheck(nbWrong == 0, "map", "byte-string keys");
+        errors += BMK_selfCheck(XXH_map_erase(strMap, copies, 0) && (XXH_map_find(strMap, "", 0) == NULL)
+                                && (XXH_map_size(strMap) == SELFTEST_NB_KEYS / 2), "map", "empty key");
+    }
+
+    XXH_map_free(map);
+    XXH_map_free(strMap);
+    free(strKeys);
+    free(visited);
+    return errors;
+}
+
+/* BMK_hllFrame() :
+ * serializes `hll` into `frame`, of XXH_hll_denseSize() bytes.
+ * @return : serialized size, 0 on failure */
+static size_t BMK_hllFrame(XXH_hll_t* hll, BYTE* frame)
+{
+    return XXH_hll_serialize(hll, frame, XXH_hll_denseSize(hll));
+}
+
+static int BMK_hllWithin(XXH_hll_t* hll, double exact, double tolerance)
+{
+    double const estimate = XXH_hll_estimate(hll);
+    return (estimate > exact * (1. - tolerance)) && (estimate < exact * (1. + tolerance));
+}
 
-    /* XXH64a bench */
-    if ((specificTest==0) | (specificTest==7))
-        BMK_benchHash(localXXH64a, "XXH64a", buffer, bufferSize);
+static int BMK_selfTestHll(BMK_selfTestKeys* k)
+{
+    size_t const quarter = SELFTEST_NB_KEYS / 4;
+    XXH_hll_t* const a = XXH_hll_create(14, 1);
+    XXH_hll_t* const b = XXH_hll_create(14, 1);
+    XXH_hll_t* const u = XXH_hll_create(14, 1);
+    XXH_hll_t* const sparse = XXH_hll_create(14, 1);
+    XXH_hll_t* const otherPrecision = XXH_hll_create(12, 1);
+    BYTE* const frame1 = a ? (BYTE*)malloc(XXH_hll_denseSize(a)) : NULL;
+    BYTE* const frame2 = a ? (BYTE*)malloc(XXH_hll_denseSize(a)) : NULL;
+    int errors = 0;
+
+    if (!a || !b || !u || !sparse || !otherPrecision || !frame1 || !frame2) {
+        XXH_hll_free(a); XXH_hll_free(b); XXH_hll_free(u); XXH_hll_free(sparse); XXH_hll_free(otherPrecision);
+        free(frame1); free(frame2);
+        return BMK_selfCheck(0, "hll", "not enough memory");
+    }
 
-    /* Bench XXH64a on Unaligned input */
-    if ((specificTest==0) | (specificTest==8))
-        BMK_benchHash(localXXH64a, "XXH64a unaligned", ((const char*)buffer)+1, bufferSize);
+    /* a : [0, 2q), b : [q, 3q), u : [0, 3q) */
+    {   size_t n;
+        int addError = XXH_hll_addBatch(a, k->ptrs, k->lengths, 2*quarter);
+        for (n=quarter; n<3*quarter; n++) addError |= XXH_hll_add(b, k->ptrs[n], k->lengths[n]);
+        addError |= XXH_hll_addBatch(u, k->ptrs, k->lengths, 3*quarter);
+        for (n=0; n<100; n++) addError |= XXH_hll_add(sparse, k->ptrs[n], k->lengths[n]);
+        errors += BMK_selfCheck(addError == 0, "hll", "addition failed");
+    }
+    /* standard error : 0.8% */
+    errors += BMK_selfCheck(BMK_hllWithin(a, (double)(2*quarter), 0.05), "hll", "estimate error above 5%");
+    errors += BMK_selfCheck(BMK_hllWithin(u, (double)(3*quarter), 0.05), "hll", "estimate error above 5%");
+    errors += BMK_selfCheck(BMK_hllWithin(sparse, 100., 0.05), "hll", "sparse estimate error above 5%");
+
+    errors += BMK_selfCheck(XXH_hll_merge(a, b) == 0, "hll", "merge of compatible sketches failed");
+    errors += BMK_selfCheck(XXH_hll_merge(a, otherPrecision) == 1, "hll", "merge of sketches with different precisions accepted");
+    errors += BMK_selfCheck(!XXH_hll_densify(a) && !XXH_hll_densify(u) && (BMK_hllFrame(a, frame1) == BMK_hllFrame(u, frame2))
+                            && !memcmp(frame1, frame2, XXH_hll_denseSize(a)), "hll", "merge differs from the sketch of the union");
+
+    /* serialize -> deserialize -> serialize, dense then sparse */
+    {   XXH_hll_t* const sketches[2] = { u, sparse };
+        int s;
+        for (s=0; s<2; s++) {
+            size_t const frameSize = BMK_hllFrame(sketches[s], frame1);
+            XXH_hll_t* const copy = frameSize ? XXH_hll_deserialize(frame1, frameSize) : NULL;
+            if (copy == NULL) {
+                errors += BMK_selfCheck(0, "hll", "deserialization failed");
+                continue;
+            }
+            errors += BMK_selfCheck((BMK_hllFrame(copy, frame2) == frameSize) && !memcmp(frame1, frame2, frameSize),
+                                    "hll", "serialize -> deserialize -> serialize is not identical");
+            errors += BMK_selfCheck(XXH_hll_deserialize(frame1, frameSize - 1) == NULL, "hll", "truncated frame accepted");
+            XXH_hll_free(copy);
+        }
+        errors += BMK_selfCheck(BMK_hllFrame(sparse, frame1) < XXH_hll_denseSize(sparse), "hll", "sparse sketch serialized as dense");
+    }
 
-    /* XXH64a bench */
-    if ((specificTest==0) | (specificTest==9))
-        BMK_benchHash(localXXH_auto, "XXH auto", buffer, bufferSize);
+    XXH_hll_free(a);
+    XXH_hll_free(b);
+    XXH_hll_free(u);
+    XXH_hll_free(sparse);
+    XXH_hll_free(otherPrecision);
+    free(frame1);
+    free(frame2);
+    return errors;
+}
 
-    /* Bench XXH64a on Unaligned input */
-    if ((specificTest==0) | (specificTest==10))
-        BMK_benchHash(localXXH_auto, "XXH auto unaligned", ((const char*)buffer)+1, bufferSize);
+/* stream : key n of [0, SELFTEST_NB_KEYS) counts (n % 16) + 1, key n of [q, 3q) counts 1 more (q = SELFTEST_NB_KEYS / 4) */
+#define SELFTEST_CMS_WIDTH 4096
+#define SELFTEST_CMS_COUNT(n) ((U32)((n) % 16) + 1 + ((n) >= SELFTEST_NB_KEYS/4 && (n) < 3*SELFTEST_NB_KEYS/4))
 
-    /* XXH64a bench */
-    if ((specificTest==0) | (specificTest==11))
-        BMK_benchHash(localXXH32_auto, "XXH32 auto", buffer, bufferSize);
+static int BMK_selfTestCms(BMK_selfTestKeys* k)
+{
+    size_t const quarter = SELFTEST_NB_KEYS / 4;
+    XXH_cms_t* const cm = XXH_cms_create(SELFTEST_CMS_WIDTH, 4, XXH_cms_countMin, 1);
+    XXH_cms_t* const cu = XXH_cms_create(SELFTEST_CMS_WIDTH, 4, XXH_cms_countMin, 1);
+    XXH_cms_t* const cs = XXH_cms_create(SELFTEST_CMS_WIDTH, 4, XXH_cms_countSketch, 1);
+    XXH_cms_t* const a = XXH_cms_create(SELFTEST_CMS_WIDTH, 4, XXH_cms_countMin, 1);
+    XXH_cms_t* const b = XXH_cms_create(SELFTEST_CMS_WIDTH, 4, XXH_cms_countMin, 1);
+    XXH_topk_t* const tk = XXH_topk_create(64, sizeof(U64), 1);   /* keeps items above N / 64 ~ 375 */
+    long long* const estimates = (long long*)malloc(2*SELFTEST_NB_KEYS * sizeof(long long));
+    double total = 0;
+    int errors = 0;
+
+    if (!cm || !cu || !cs || !a || !b || !tk || !estimates) {
+        XXH_cms_free(cm); XXH_cms_free(cu); XXH_cms_free(cs); XXH_cms_free(a); XXH_cms_free(b);
+        XXH_topk_free(tk); free(estimates);
+        return BMK_selfCheck(0, "cms", "not enough memory");
+    }
 
-    /* Bench XXH64a on Unaligned input */
-    if ((specificTest==0) | (specificTest==12))
-        BMK_benchHash(localXXH32_auto, "XXH32 auto unaligned", ((const char*)buffer)+1, bufferSize);
+    {   size_t n;
+        for (n=0; n<SELFTEST_NB_KEYS; n++) {
+            U32 const count = SELFTEST_CMS_COUNT(n);
+            XXH_cms_update(cm, k->ptrs[n], k->lengths[n], count);
+            XXH_cms_updateConservative(cu, k->ptrs[n], k->lengths[n], count);
+            XXH_cms_update(cs, k->ptrs[n], k->lengths[n], count);
+            XXH_cms_update(a, k->ptrs[n], k->lengths[n], (U32)(n % 16) + 1);
+            total += count;
+        }
+        XXH_cms_updateBatch(b, k->ptrs + quarter, k->lengths + quarter, 2*quarter, 1);
+    }
+    errors += BMK_selfCheck(XXH_cms_merge(a, b) == 0, "cms", "merge of compatible sketches failed");
+    errors += BMK_selfCheck(XXH_cms_merge(a, cs) == 1, "cms", "merge of sketches of different kinds accepted");
+    errors += BMK_selfCheck(!memcmp(a->counters, cm->counters, cm->width * cm->depth * sizeof(*cm->counters)),
+                            "cms", "merge differs from the sketch of both streams");
+
+    /* count-min overestimates by at most e * N / width, with probability 1 - e^-depth (~98%) */
+    {   double const bound = 2.72 * total / SELFTEST_CMS_WIDTH;
+        size_t n, nbUnder = 0, nbAbove = 0, nbAboveCu = 0, nbAboveCs = 0, nbMismatches = 0;
+        XXH_cms_estimateBatch(cm, k->ptrs, k->lengths, 2*SELFTEST_NB_KEYS, estimates);
+        for (n=0; n<2*SELFTEST_NB_KEYS; n++) {
+            long long const exact = (n < SELFTEST_NB_KEYS) ? (long long)SELFTEST_CMS_COUNT(n) : 0;
+            long long const eCm = XXH_cms_estimate(cm, k->ptrs[n], k->lengths[n]);
+            long long const eCu = XXH_cms_estimate(cu, k->ptrs[n], k->lengths[n]);
+            long long const eCs = XXH_cms_estimate(cs, k->ptrs[n], k->lengths[n]);
+            nbMismatches += (eCm != estimates[n]);
+            nbUnder += (eCm < exact) + (eCu < exact);
+            nbAbove += ((double)(eCm - exact) > bound);
+            nbAboveCu += (eCu > eCm);   /* conservative updates never estimate more */
+            nbAboveCs += ((double)(eCs > exact ? eCs - exact : exact - eCs) > bound);
+        }
+        errors += BMK_selfCheck(nbMismatches == 0, "cms", "XXH_cms_estimateBatch() differs from XXH_cms_estimate()");
+        errors += BMK_selfCheck(nbUnder == 0, "cms", "count-min underestimates");
+        errors += BMK_selfCheck(nbAbove < SELFTEST_NB_KEYS / 10, "cms", "count-min error above e * N / width for more than 5% of items");
+        errors += BMK_selfCheck(nbAboveCu == 0, "cms", "conservative update estimates more than count-min");
+        errors += BMK_selfCheck(nbAboveCs < SELFTEST_NB_KEYS / 10, "cms", "count sketch error above e * N / width for more than 5% of items");
+    }
 
+    /* heavy hitters : keys 0-3 count 1000, the others 1 */
+    {   XXH_topk_entry_t entries[4];
+        size_t n, nbWrong = 0;
+        for (n=0; n<SELFTEST_NB_KEYS; n++) XXH_topk_add(tk, k->ptrs[n], k->lengths[n], (n < 4) ? 1000 : 1);
+        if (XXH_topk_list(tk, entries, 4) != 4) nbWrong++;
+        else for (n=0; n<4; n++) {
+            U64 key;
+            memcpy(&key, entries[n].key, sizeof(key));
+            nbWrong += (entries[n].length != sizeof(U64)) || (key != k->values[0] && key != k->values[1]
+                        && key != k->values[2] && key != k->values[3]) || (entries[n].count - entries[n].error > 1000);
+        }
+        errors += BMK_selfCheck(nbWrong == 0, "cms", "top-k heavy hitters");
+    }
 
-    /* XXH64a bench */
-    if ((specificTest==0) | (specificTest==13))
-        BMK_benchHash(localXXH64_auto, "XXH64 auto", buffer, bufferSize);
+    XXH_cms_free(cm);
+    XXH_cms_free(cu);
+    XXH_cms_free(cs);
+    XXH_cms_free(a);
+    XXH_cms_free(b);
+    XXH_topk_free(tk);
+    free(estimates);
+    return errors;
+}
 
-    /* Bench XXH64a on Unaligned input */
-    if ((specificTest==0) | (specificTest==14))
-        BMK_benchHash(localXXH64_auto, "XXH64 auto unaligned", ((const char*)buffer)+1, bufferSize);
+static int BMK_selfTestMinhash(BMK_selfTestKeys* k, XXH_minhash_method_e method)
+{
+    static const char* const names[] = { "minhash k-permutations", "minhash one-permutation" };
+    const char* const name = names[method == XXH_minhash_onePermutation];
+    XXH_minhash_t* const mh = XXH_minhash_create(SELFTEST_SLOTS, method, 1);
+    XXH32_hash_t sigA[SELFTEST_SLOTS], sigB[SELFTEST_SLOTS], sigU[SELFTEST_SLOTS], sigM[SELFTEST_SLOTS];
+    XXH32_hash_t sigNear[SELFTEST_SLOTS], sigFar[SELFTEST_SLOTS];
+    XXH64_hash_t keysA[SELFTEST_SLOTS], keysM[SELFTEST_SLOTS], keysNear[SELFTEST_SLOTS], keysFar[SELFTEST_SLOTS];
+    BYTE bbitA[SELFTEST_SLOTS], bbitB[SELFTEST_SLOTS];
+    size_t const nbBands = SELFTEST_SLOTS / 4;
+    int errors = 0;
+
+    if (mh == NULL) return BMK_selfCheck(0, name, "not enough memory");
+
+    /* A : [0, 1000), B : [500, 1500) : Jaccard 1/3. Near : [10, 1000) : 0.99 to A. Far : [2000, 3000) : 0 to A */
+    XXH_minhash_init(mh, sigA); XXH_minhash_init(mh, sigB); XXH_minhash_init(mh, sigU);
+    XXH_minhash_init(mh, sigNear); XXH_minhash_init(mh, sigFar);
+    XXH_minhash_addBatch(mh, sigA, k->ptrs, k->lengths, 1000);
+    {   size_t n;
+        for (n=500; n<1500; n++) XXH_minhash_add(mh, sigB, k->ptrs[n], k->lengths[n]);
+    }
+    XXH_minhash_addBatch(mh, sigU, k->ptrs, k->lengths, 1500);
+    XXH_minhash_addBatch(mh, sigNear, k->ptrs + 10, k->lengths + 10, 990);
+    XXH_minhash_addBatch(mh, sigFar, k->ptrs + 2000, k->lengths + 2000, 1000);
+    memcpy(sigM, sigA, sizeof(sigM));
+    XXH_minhash_merge(mh, sigM, sigB);
+    errors += BMK_selfCheck(!memcmp(sigM, sigU, sizeof(sigM)), name, "merge differs from the signature of the union");
+    XXH_minhash_finalize(mh, sigA); XXH_minhash_finalize(mh, sigB); XXH_minhash_finalize(mh, sigM);
+    XXH_minhash_finalize(mh, sigNear); XXH_minhash_finalize(mh, sigFar);
+
+    /* standard error : sqrt(J (1-J) / 128) ~ 0.04 */
+    {   double const j = XXH_minhash_similarity(sigA, sigB, SELFTEST_SLOTS);
+        errors += BMK_selfCheck((j > 1./3 - 0.15) && (j < 1./3 + 0.15), name, "similarity error above 0.15");
+        errors += BMK_selfCheck(XXH_minhash_similarity(sigA, sigA, SELFTEST_SLOTS) > 0.999, name, "similarity of a set with itself");
+    }
 
+    {   size_t const bbitSize = XXH_minhash_bbitSize(SELFTEST_SLOTS, 8);
+        double j;
+        errors += BMK_selfCheck((bbitSize == SELFTEST_SLOTS) && (XXH_minhash_toBbit(sigA, SELFTEST_SLOTS, 8, bbitA) == bbitSize)
+                                && (XXH_minhash_toBbit(sigB, SELFTEST_SLOTS, 8, bbitB) == bbitSize), name, "b-bit signature size");
+        j = XXH_minhash_similarityBbit(bbitA, bbitB, SELFTEST_SLOTS, 8);
+        errors += BMK_selfCheck((j > 1./3 - 0.15) && (j < 1./3 + 0.15), name, "b-bit similarity error above 0.15");
+        errors += BMK_selfCheck((XXH_minhash_bbitSize(SELFTEST_SLOTS, 0) == 0) && (XXH_minhash_bbitSize(SELFTEST_SLOTS, 17) == 0)
+                                && (XXH_minhash_toBbit(sigA, SELFTEST_SLOTS, 0, bbitA) == 0)
+                                && (XXH_minhash_toBbit(sigA, SELFTEST_SLOTS, 17, bbitA) == 0)
+                                && (XXH_minhash_similarityBbit(bbitA, bbitB, SELFTEST_SLOTS, 0) < 0)
+                                && (XXH_minhash_similarityBbit(bbitA, bbitB, SELFTEST_SLOTS, 17) < 0),
+                                name, "b outside 1-16 accepted");
+    }
 
-    if (specificTest > 14) {
-        DISPLAY("benchmark mode invalid \n");
-        return 1;
+    /* bands of 4 slots : candidates at 0.99 with probability ~1, at 0 never */
+    {   size_t n, nbNear = 0, nbFar = 0, nbEqualBands = 0;
+        errors += BMK_selfCheck((XXH_minhash_bandKeys(mh, sigA, 3, keysA) == 1) && (XXH_minhash_bandKeys(mh, sigA, 0, keysA) == 1),
+                                name, "number of bands not dividing the signature accepted");
+        memcpy(sigM, sigA, sizeof(sigM));
+        errors += BMK_selfCheck(!XXH_minhash_bandKeys(mh, sigA, nbBands, keysA) && !XXH_minhash_bandKeys(mh, sigM, nbBands, keysM)
+                                && !XXH_minhash_bandKeys(mh, sigNear, nbBands, keysNear) && !XXH_minhash_bandKeys(mh, sigFar, nbBands, keysFar),
+                                name, "band keys failed");
+        errors += BMK_selfCheck(!memcmp(keysA, keysM, nbBands * sizeof(*keysA)), name, "band keys of identical signatures differ");
+        XXH_minhash_init(mh, sigM);   /* empty set : all bands are equal, their keys must not be */
+        XXH_minhash_bandKeys(mh, sigM, nbBands, keysM);
+        for (n=1; n<nbBands; n++) nbEqualBands += (keysM[n] == keysM[0]);
+        errors += BMK_selfCheck(nbEqualBands == 0, name, "band number not part of band keys");
+        for (n=0; n<nbBands; n++) {
+            nbNear += (keysA[n] == keysNear[n]);
+            nbFar += (keysA[n] == keysFar[n]);
+        }
+        errors += BMK_selfCheck(nbNear > 0, name, "no band key shared by similar sets");
+        errors += BMK_selfCheck(nbFar == 0, name, "band key shared by disjoint sets");
     }
-    return 0;
+
+    XXH_minhash_free(mh);
+    return errors;
 }
 
+/* BMK_selfTest() :
+ * Checks properties of companion modules : no false negative, find after erasure, bounded errors,
+ * merge equal to the union, stable serialization.
+ * @return : 0 if all checks pass, 1 otherwise */
+static int BMK_selfTest(void)
+{
+    BMK_selfTestKeys* const k = (BMK_selfTestKeys*)malloc(sizeof(BMK_selfTestKeys));
+    int errors = 0;
+    size_t n;
 
-static size_t BMK_selectBenchedSize(const char* fileName)
-{   U64 const inFileSize = BMK_GetFileSize(fileName);
-    size_t benchedSize = (size_t) BMK_findMaxMem(inFileSize);
-    if ((U64)benchedSize > inFileSize) benchedSize = (size_t)inFileSize;
-    if (benchedSize < inFileSize) {
-        DISPLAY("Not enough memory for '%s' full size; testing %i MB only...\n", fileName, (int)(benchedSize>>20));
+    if (k == NULL) {
+        DISPLAY("\nError: not enough memory!\n");
+        return 12;
     }
-    return benchedSize;
+    for (n=0; n<2*SELFTEST_NB_KEYS; n++) {
+        k->values[n] = (U64)n * 0x9E3779B97F4A7C15ULL + 1;   /* odd multiplier : distinct keys */
+        k->ptrs[n] = k->values + n;
+        k->lengths[n] = sizeof(U64);
+    }
+    errors += BMK_selfTestBloom(k);
+    errors += BMK_selfTestMap(k);
+    errors += BMK_selfTestHll(k);
+    errors += BMK_selfTestCms(k);
+    errors += BMK_selfTestMinhash(k, XXH_minhash_kPermutations);
+    errors += BMK_selfTestMinhash(k, XXH_minhash_onePermutation);
+    free(k);
+
+    if (errors) {
+        DISPLAY("Self-test -- %i checks failed\n", errors);
+        return 1;
+    }
+    DISPLAYLEVEL(2, "Self-test -- all checks ok\n");
+    return 0;
 }
 
 
-static int BMK_benchFiles(const char** fileNamesTable, int nbFiles, U32 specificTest)
-{
-    int result = 0;
-    int fileIdx;
-
-    for (fileIdx=0; fileIdx<nbFiles; fileIdx++) {
-        const char* const inFileName = fileNamesTable[fileIdx];
-        assert(inFileName != NULL);
-        {
-            size_t const benchedSize = BMK_selectBenchedSize(inFileName);
-            char* const buffer = (char*)calloc(benchedSize+16+3, 1);
-            void* const alignedBuffer = (buffer+15) - (((size_t)(buffer+15)) & 0xF);  /* align on next 16 bytes */
-            FILE* const inFile = fopen( inFileName, "rb" );
+/* ********************************************************
+*  Auto selection audit
+**********************************************************/
 
-            /* Checks */
-            if (inFile==NULL){
-                DISPLAY("Could not open %s: %s\n", inFileName, strerror(errno));
-                free(buffer);
-                return 11;
-            }
-            if(!buffer) {
-                DISPLAY("\nError: not enough memory!\n");
-                fclose(inFile);
-                return 12;
-            }
+#define AUDIT_DEFAULT_MAX (64 KB)
+#define AUDIT_MAX_RUNGS   128
+#define AUDIT_NB_KERNELS  4   /* XXH_kernel_e */
 
-            /* Fill input buffer */
-            DISPLAYLEVEL(1, "\rLoading %s...        \n", inFileName);
-            {   size_t const readSize = fread(alignedBuffer, 1, benchedSize, inFile);
-                if(readSize != benchedSize) {
-                    DISPLAY("\nError: Could not read %s: %s\n", inFileName, strerror(errno));
-                    fclose(inFile);
-                    free(buffer);
-                    return 13;
-                }
-                fclose(inFile);
-            }
+/* concrete kernels, indexed by XXH_kernel_e.
+ * 64-bit results are truncated to 32 bits : the fold of XXH32_auto() only costs a few instructions */
+static const hashFunction g_kernelFuncs[AUDIT_NB_KERNELS] = { localXXH32, localXXH64, localXXH32a, localXXH64a };
 
-            /* bench */
-            result |= BMK_benchMem(alignedBuffer, benchedSize, specificTest);
+typedef struct {
+    const char*  name;
+    XXH_kernel_e (*select)(size_t len);
+    int          wide;   /* 64-bit result : only 64-bit kernels are eligible */
+} BMK_autoVariant;
+
+static const BMK_autoVariant g_autoVariants[] = {
+    { "XXH32 auto", XXH32_autoKernel,    0 },
+    { "XXH64 auto", XXH64_autoKernel,    1 },
+    { "XXH auto",   localXXH_autoKernel, sizeof(size_t) >= sizeof(U64) },
+};
+#define NB_AUTO_VARIANTS ((U32)(sizeof(g_autoVariants) / sizeof(g_autoVariants[0])))
+
+static int BMK_kernelEligible(const BMK_autoVariant* variant, U32 kernel)
+{
+    if (!variant->wide) return 1;
+    return (kernel == XXH_kernel_xxh64) || (kernel == XXH_kernel_xxh64a);
+}
 
-            free(buffer);
-        }
+static U32 BMK_bestKernel(const BMK_autoVariant* variant, const double* nsPerKernel)
+{
+    U32 best = AUDIT_NB_KERNELS, k;
+    for (k=0; k<AUDIT_NB_KERNELS; k++) {
+        if (!BMK_kernelEligible(variant, k)) continue;
+        if ((best == AUDIT_NB_KERNELS) || (nsPerKernel[k] < nsPerKernel[best])) best = k;
     }
-
-    return result;
+    return best;
 }
 
-
-
-static int BMK_benchInternal(size_t keySize, int specificTest)
+/* BMK_auditAuto() :
+ * Measures each concrete kernel over the sweep ladder of sizes, up to `maxSize`,
+ * and compares the kernel selected by each _auto variant with the fastest eligible one.
+ * Cumulative loss is weighted by the length distribution of `keysFileName` when provided
+ * (each key counts for the first size >= its length), and gives each size the same weight otherwise.
+ * Measures latency instead of throughput with --latency.
+ * @return : 0 on success, error code otherwise */
+static int BMK_auditAuto(size_t maxSize, const char* keysFileName, BMK_keysFormat_e keysFormat)
 {
-    void* const buffer = calloc(keySize+16+3, 1);
-    if(!buffer) {
+    size_t sizes[AUDIT_MAX_RUNGS];
+    double weights[AUDIT_MAX_RUNGS];
+    double ns[AUDIT_MAX_RUNGS][AUDIT_NB_KERNELS];
+    U32 nbRungs = 0;
+    U32 r, k, v;
+    void* buffer;
+    const char* alignedBuffer;
+
+    {   size_t size;
+        for (size = 1; (size <= maxSize) && (nbRungs < AUDIT_MAX_RUNGS); size = BMK_nextSweepSize(size)) {
+            sizes[nbRungs] = size;
+            weights[nbRungs] = 1.;
+            nbRungs++;
+    }   }
+    if (keysFileName) {
+        BMK_keyCorpus corpus;
+        int const loadError = BMK_loadKeys(&corpus, keysFileName, keysFormat);
+        size_t n;
+        if (loadError) return loadError;
+        for (r=0; r<nbRungs; r++) weights[r] = 0.;
+        for (n=0; n<corpus.nbKeys; n++) {
+            for (r=0; (r < nbRungs-1) && (sizes[r] < corpus.keys[n].length); r++) ;
+            weights[r] += 1.;
+        }
+        BMK_freeKeys(&corpus);
+    }
+
+    buffer = malloc(sizes[nbRungs-1] + 16);
+    if (!buffer) {
         DISPLAY("\nError: not enough memory!\n");
         return 12;
     }
-
-    {   void* const alignedBuffer = ((char*)buffer+15) - (((size_t)((char*)buffer+15)) & 0xF);  /* align on next 16 bytes */
-
-        /* bench */
-        DISPLAYLEVEL(1, "Sample of ");
-        if (keySize > 10 KB) {
-            DISPLAYLEVEL(1, "%u KB", (U32)(keySize >> 10));
-        } else {
-            DISPLAYLEVEL(1, "%u bytes", (U32)keySize);
+    alignedBuffer = (const char*)buffer + 15 - (((size_t)((char*)buffer+15)) & 0xF);
+    BMK_fillBuffer(buffer, sizes[nbRungs-1] + 16);
+
+    for (r=0; r<nbRungs; r++) {
+        for (k=0; k<AUDIT_NB_KERNELS; k++) {
+            DISPLAYLEVEL(2, "\r%70s\r%-8s %10u ...\r", "", g_kernelNames[k], (U32)sizes[r]);
+            ns[r][k] = BMK_measureHash(g_kernelFuncs[k], NULL, alignedBuffer, sizes[r], TIMELOOP_NS / 20, (int)g_benchLatency);
+    }   }
+    DISPLAYLEVEL(2, "\r%70s\r", "");
+
+    /* per size : time of each kernel, then choice of each variant */
+    switch (g_outputFormat)
+    {
+    case BMK_format_csv:
+        DISPLAYRESULT("size,variant,weight,chosen,best,loss_pct,suboptimal");
+        for (k=0; k<AUDIT_NB_KERNELS; k++) DISPLAYRESULT(",%s_%s", g_kernelNames[k], g_benchLatency ? "latency_ns" : "ns");
+        DISPLAYRESULT("\n");
+        break;
+    case BMK_format_json:
+        DISPLAYRESULT("{\n  \"metric\": \"%s\",\n  \"weighting\": \"%s\",\n  \"sizes\": [",
+                      g_benchLatency ? "latency_ns" : "ns_per_hash", keysFileName ? "key_lengths" : "uniform");
+        break;
+    case BMK_format_human:
+    default:
+        DISPLAYRESULT("%10s", g_benchLatency ? "ns latency" : "ns/hash");
+        for (k=0; k<AUDIT_NB_KERNELS; k++) DISPLAYRESULT(" %8s", g_kernelNames[k]);
+        for (v=0; v<NB_AUTO_VARIANTS; v++) DISPLAYRESULT(" | %-22s", g_autoVariants[v].name);
+        DISPLAYRESULT("\n");
+        break;
+    }
+    for (r=0; r<nbRungs; r++) {
+        if (g_outputFormat == BMK_format_json) {
+            DISPLAYRESULT("%s\n    { \"size\": %u, \"weight\": %.0f, \"ns\": {", r ? "," : "", (U32)sizes[r], weights[r]);
+            for (k=0; k<AUDIT_NB_KERNELS; k++)
+                DISPLAYRESULT("%s \"%s\": %.3f", k ? "," : "", g_kernelNames[k], ns[r][k]);
+            DISPLAYRESULT(" },\n      \"variants\": [");
+        } else if (g_outputFormat == BMK_format_human) {
+            DISPLAYRESULT("%10u", (U32)sizes[r]);
+            for (k=0; k<AUDIT_NB_KERNELS; k++) DISPLAYRESULT(" %8.1f", ns[r][k]);
         }
-        DISPLAYLEVEL(1, "...        \n");
+        for (v=0; v<NB_AUTO_VARIANTS; v++) {
+            U32 const chosen = (U32)g_autoVariants[v].select(sizes[r]);
+            U32 const best = BMK_bestKernel(g_autoVariants + v, ns[r]);
+            double const lossPct = (ns[r][chosen] - ns[r][best]) * 100. / ns[r][best];
+            switch (g_outputFormat)
+            {
+            case BMK_format_csv:
+                DISPLAYRESULT("%u,%s,%.0f,%s,%s,%.2f,%u", (U32)sizes[r], g_autoVariants[v].name, weights[r],
+                              g_kernelNames[chosen], g_kernelNames[best], lossPct, chosen != best);
+                for (k=0; k<AUDIT_NB_KERNELS; k++) DISPLAYRESULT(",%.3f", ns[r][k]);
+                DISPLAYRESULT("\n");
+                break;
+            case BMK_format_json:
+                DISPLAYRESULT("%s\n        { \"variant\": ", v ? "," : "");
+                BMK_displayJsonString(g_autoVariants[v].name);
+                DISPLAYRESULT(", \"chosen\": ");
+                BMK_displayJsonString(g_kernelNames[chosen]);
+                DISPLAYRESULT(", \"best\": ");
+                BMK_displayJsonString(g_kernelNames[best]);
+                DISPLAYRESULT(", \"loss_pct\": %.2f }", lossPct);
+                break;
+            case BMK_format_human:
+            default:
+                {   char verdict[32];
+                    if (chosen == best) sprintf(verdict, "best");
+                    else sprintf(verdict, "+%.1f%% vs %s", lossPct, g_kernelNames[best]);
+                    DISPLAYRESULT(" | %-6s %-15s", g_kernelNames[chosen], verdict);
+                }
+                break;
+            }
+        }
+        if (g_outputFormat == BMK_format_json) DISPLAYRESULT(" ] }");
+        else if (g_outputFormat == BMK_format_human) DISPLAYRESULT("\n");
+    }
 
-        {   int const result = BMK_benchMem(alignedBuffer, keySize, specificTest);
-            free(buffer);
-            return result;
+    /* cumulative loss of each variant, and of always using the same kernel */
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ],\n  \"summary\": [");
+    else if (g_outputFormat == BMK_format_human)
+        DISPLAYRESULT("\nCumulative loss vs fastest kernel at each size (%s) :\n",
+                      keysFileName ? "weighted by key lengths" : "each size weighted equally");
+    for (v=0; v<NB_AUTO_VARIANTS; v++) {
+        const BMK_autoVariant* const variant = g_autoVariants + v;
+        double bestTotal = 0., autoTotal = 0., totalWeight = 0., fixedTotal[AUDIT_NB_KERNELS];
+        U32 nbMissed = 0;
+        size_t firstMissed = 0;
+        for (k=0; k<AUDIT_NB_KERNELS; k++) fixedTotal[k] = 0.;
+        for (r=0; r<nbRungs; r++) {
+            U32 const chosen = (U32)variant->select(sizes[r]);
+            U32 const best = BMK_bestKernel(variant, ns[r]);
+            bestTotal += weights[r] * ns[r][best];
+            autoTotal += weights[r] * ns[r][chosen];
+            totalWeight += weights[r];
+            for (k=0; k<AUDIT_NB_KERNELS; k++) fixedTotal[k] += weights[r] * ns[r][k];
+            if ((chosen != best) && (weights[r] > 0.)) {
+                if (!nbMissed) firstMissed = sizes[r];
+                nbMissed++;
+        }   }
+        if (bestTotal <= 0.) bestTotal = 1.;
+        switch (g_outputFormat)
+        {
+        case BMK_format_csv:
+            DISPLAYRESULT("all,%s,%.0f,auto,,%.2f,%u\n", variant->name, totalWeight,
+                          (autoTotal - bestTotal) * 100. / bestTotal, nbMissed);
+            for (k=0; k<AUDIT_NB_KERNELS; k++) {
+                if (!BMK_kernelEligible(variant, k)) continue;
+                DISPLAYRESULT("all,%s,%.0f,%s,,%.2f,\n", variant->name, totalWeight, g_kernelNames[k],
+                              (fixedTotal[k] - bestTotal) * 100. / bestTotal);
+            }
+            break;
+        case BMK_format_json:
+            DISPLAYRESULT("%s\n    { \"variant\": ", v ? "," : "");
+            BMK_displayJsonString(variant->name);
+            DISPLAYRESULT(", \"loss_pct\": %.2f, \"suboptimal\": %u, \"nb_sizes\": %u, \"first_suboptimal\": ",
+                          (autoTotal - bestTotal) * 100. / bestTotal, nbMissed, nbRungs);
+            if (nbMissed) DISPLAYRESULT("%u", (U32)firstMissed); else DISPLAYRESULT("null");
+            DISPLAYRESULT(", \"always_loss_pct\": {");
+            {   int firstKernel = 1;
+                for (k=0; k<AUDIT_NB_KERNELS; k++) {
+                    if (!BMK_kernelEligible(variant, k)) continue;
+                    DISPLAYRESULT("%s \"%s\": %.2f", firstKernel ? "" : ",", g_kernelNames[k],
+                                  (fixedTotal[k] - bestTotal) * 100. / bestTotal);
+                    firstKernel = 0;
+            }   }
+            DISPLAYRESULT(" } }");
+            break;
+        case BMK_format_human:
+        default:
+            DISPLAYRESULT("%-10s : %+6.1f%%, suboptimal at %u of %u sizes", variant->name,
+                          (autoTotal - bestTotal) * 100. / bestTotal, nbMissed, nbRungs);
+            if (nbMissed) DISPLAYRESULT(" (first : %u bytes)", (U32)firstMissed);
+            DISPLAYRESULT("; always");
+            for (k=0; k<AUDIT_NB_KERNELS; k++) {
+                if (!BMK_kernelEligible(variant, k)) continue;
+                DISPLAYRESULT(" %s %+.1f%%", g_kernelNames[k], (fixedTotal[k] - bestTotal) * 100. / bestTotal);
+            }
+            DISPLAYRESULT("\n");
+            break;
         }
     }
+    if (g_outputFormat == BMK_format_json) DISPLAYRESULT("\n  ]\n}\n");
+
+    free(buffer);
+    return 0;
 }
 
+
 static void BMK_checkResult(U32 r1, U32 r2, const char* hashName, const char* testName)
 {
     if (r1==r2) {
@@ -654,6 +5339,117 @@ static void BMK_sanityCheck(void)
 }
 
 
+/* ********************************************************
+*  Run profile (--profile)
+**********************************************************/
+
+#define PROFILE_DEFAULT_SLOWEST  5
+#define PROFILE_MAX_SLOWEST     64
+#define PROFILE_NAME_MAX       128
+
+typedef enum { BMK_prof_meta, BMK_prof_read, BMK_prof_hash, BMK_prof_output, BMK_prof_parse, BMK_prof_max } BMK_profPhase_e;
+static const char* const g_profPhaseNames[BMK_prof_max] = { "metadata", "read", "hash", "output", "parse" };
+
+typedef struct {
+    char name[PROFILE_NAME_MAX];   /* truncated */
+    U64  nanos;
+    U64  bytes;
+} BMK_profFile;
+
+typedef struct {
+    U32 enabled;
+    U32 nbSlowest;
+    U64 nanos[BMK_prof_max];
+    U64 bytes;
+    U32 files;
+    BMK_time_t fileStart;
+    U64 fileBytes;
+    U32 nbRecorded;
+    BMK_profFile slowest[PROFILE_MAX_SLOWEST];   /* slowest first */
+} BMK_profile;
+
+static BMK_profile g_profile;   /* enabled by --profile */
+
+/* BMK_profStart(), BMK_profEnd() :
+ * Account the time spent since BMK_profStart() to `phase`.
+ * Timestamps are only taken when profiling. */
+static BMK_time_t BMK_profStart(void)
+{
+    BMK_time_t t;
+    if (g_profile.enabled) return BMK_getTime();
+    memset(&t, 0, sizeof(t));
+    return t;
+}
+
+static void BMK_profEnd(BMK_profPhase_e phase, BMK_time_t start)
+{
+    if (g_profile.enabled) g_profile.nanos[phase] += BMK_clockSpanNano(start);
+}
+
+static void BMK_profBytes(size_t nbBytes)
+{
+    g_profile.bytes += nbBytes;
+    g_profile.fileBytes += nbBytes;
+}
+
+static void BMK_profFileBegin(void)
+{
+    if (!g_profile.enabled) return;
+    g_profile.fileStart = BMK_getTime();
+    g_profile.fileBytes = 0;
+}
+
+/* BMK_profFileEnd() :
+ * Counts one file, and keeps it if it is among the g_profile.nbSlowest slowest ones */
+static void BMK_profFileEnd(const char* fileName)
+{
+    U64 nanos;
+    U32 pos;
+    if (!g_profile.enabled) return;
+    nanos = BMK_clockSpanNano(g_profile.fileStart);
+    g_profile.files++;
+    for (pos = g_profile.nbRecorded; (pos > 0) && (g_profile.slowest[pos-1].nanos < nanos); pos--) ;
+    if (pos >= g_profile.nbSlowest) return;
+    if (g_profile.nbRecorded < g_profile.nbSlowest) g_profile.nbRecorded++;
+    memmove(g_profile.slowest + pos + 1, g_profile.slowest + pos,
+            (g_profile.nbRecorded - 1 - pos) * sizeof(BMK_profFile));
+    strncpy(g_profile.slowest[pos].name, fileName, PROFILE_NAME_MAX-1);
+    g_profile.slowest[pos].name[PROFILE_NAME_MAX-1] = '\0';
+    g_profile.slowest[pos].nanos = nanos;
+    g_profile.slowest[pos].bytes = g_profile.fileBytes;
+}
+
+/* BMK_displayProfile() :
+ * `wallNanos` : duration of the whole run; time outside of measured phases is reported as "other" */
+static void BMK_displayProfile(U64 wallNanos)
+{
+    U64 accounted = 0;
+    U32 n;
+    int p;
+
+    if (!wallNanos) wallNanos = 1;
+    DISPLAY("\r%70s\r", "");
+    DISPLAY("Profile : %u files, %.1f MB in %.3f s (%.1f MB/s) \n", g_profile.files,
+            (double)g_profile.bytes / (1 MB), (double)wallNanos / 1000000000.,
+            ((double)g_profile.bytes / (1 MB)) * 1000000000. / (double)wallNanos);
+    for (p=0; p<BMK_prof_max; p++) {
+        accounted += g_profile.nanos[p];
+        DISPLAY("  %-9s: %10.3f ms %5.1f%% \n", g_profPhaseNames[p],
+                (double)g_profile.nanos[p] / 1000000., (double)g_profile.nanos[p] * 100. / (double)wallNanos);
+    }
+    if (accounted > wallNanos) accounted = wallNanos;
+    DISPLAY("  %-9s: %10.3f ms %5.1f%% \n", "other",
+            (double)(wallNanos - accounted) / 1000000., (double)(wallNanos - accounted) * 100. / (double)wallNanos);
+    if (g_profile.nbRecorded) DISPLAY("Slowest files : \n");
+    for (n=0; n<g_profile.nbRecorded; n++) {
+        const BMK_profFile* const f = g_profile.slowest + n;
+        DISPLAY("  %10.3f ms %10.1f MB %8.1f MB/s  %s \n", (double)f->nanos / 1000000.,
+                (double)f->bytes / (1 MB),
+                ((double)f->bytes / (1 MB)) * 1000000000. / (double)(f->nanos ? f->nanos : 1), f->name);
+    }
+}
+
+
 /* ********************************************************
 *  File Hashing
 **********************************************************/
@@ -681,6 +5477,7 @@ static void BMK_hashStream(void* xxhHashValue, const algoType hashType, FILE* in
     XXH32_state_t state32;
     XXH64a_state_t state64a;
     size_t readSize;
+    BMK_time_t tStart;
 
     /* Init */
     (void)XXH32_reset(&state32, XXHSUM32_DEFAULT_SEED);
@@ -691,7 +5488,13 @@ static void BMK_hashStream(void* xxhHashValue, const algoType hashType, FILE* in
     /* Load file & update hash */
     readSize = 1;
     while (readSize) {
+        BMK_PROBE0(read_start);
+        tStart = BMK_profStart();
         readSize = fread(buffer, 1, blockSize, inFile);
+        BMK_profEnd(BMK_prof_read, tStart);
+        BMK_profBytes(readSize);
+        BMK_PROBE1(read_done, readSize);
+        tStart = BMK_profStart();
         switch(hashType)
         {
         case algo_xxh32:
@@ -709,33 +5512,40 @@ static void BMK_hashStream(void* xxhHashValue, const algoType hashType, FILE* in
         default:
             break;
         }
+        BMK_profEnd(BMK_prof_hash, tStart);
     }
 
+    tStart = BMK_profStart();
     switch(hashType)
     {
     case algo_xxh32:
         {   U32 const h32 = XXH32_digest(&state32);
+            BMK_PROBE2(digest, (int)hashType, h32);
             memcpy(xxhHashValue, &h32, sizeof(h32));
             break;
         }
     case algo_xxh32a:
         {   U32 const h32 = XXH32a_digest(&state32a);
+            BMK_PROBE2(digest, (int)hashType, h32);
             memcpy(xxhHashValue, &h32, sizeof(h32));
             break;
         }
     case algo_xxh64:
         {   U64 const h64 = XXH64_digest(&state64);
+            BMK_PROBE2(digest, (int)hashType, h64);
             memcpy(xxhHashValue, &h64, sizeof(h64));
             break;
         }
     case algo_xxh64a:
         {   U64 const h64 = XXH64a_digest(&state64a);
+            BMK_PROBE2(digest, (int)hashType, h64);
             memcpy(xxhHashValue, &h64, sizeof(h64));
             break;
         }
     default:
             break;
     }
+    BMK_profEnd(BMK_prof_hash, tStart);
 }
 
 
@@ -750,29 +5560,30 @@ static int BMK_hash(const char* fileName,
     void*  buffer;
     U32    h32 = 0;
     U64    h64 = 0;
+    BMK_time_t tStart;
 
     /* Check file existence */
+    BMK_profFileBegin();
+    tStart = BMK_profStart();
     if (fileName == stdinName) {
         inFile = stdin;
         SET_BINARY_MODE(stdin);
     }
     else
         inFile = fopen( fileName, "rb" );
+    BMK_profEnd(BMK_prof_meta, tStart);
     if (inFile==NULL) {
         DISPLAY( "Could not open %s: %s\n", fileName, strerror(errno));
         return 1;
     }
+    BMK_PROBE1(file_open, fileName);
 
     /* Memory allocation & restrictions */
     buffer = malloc(blockSize);
-    if(!buffer) {
-        DISPLAY("\nError: not enough memory!\n");
-        fclose(inFile);
-        return 1;
-    }
 
     /* loading notification */
-    {   const size_t fileNameSize = strlen(fileName);
+    if (buffer) {
+        const size_t fileNameSize = strlen(fileName);
         const char* const fileNameEnd = fileName + fileNameSize;
         const int maxInfoFilenameSize = (int)(fileNameSize > 30 ? 30 : fileNameSize);
         int infoFilenameSize = 1;
@@ -800,13 +5611,21 @@ static int BMK_hash(const char* fileName,
         default:
             break;
         }
-
-        fclose(inFile);
-        free(buffer);
         DISPLAY("%s             \r", fileNameEnd - infoFilenameSize);  /* erase line */
     }
 
+    tStart = BMK_profStart();
+    fclose(inFile);
+    BMK_profEnd(BMK_prof_meta, tStart);
+    BMK_PROBE1(file_close, fileName);
+    if (!buffer) {
+        DISPLAY("\nError: not enough memory!\n");
+        return 1;
+    }
+    free(buffer);
+
     /* display Hash */
+    tStart = BMK_profStart();
     switch(hashType)
     {
     case algo_xxh32:
@@ -844,6 +5663,8 @@ static int BMK_hash(const char* fileName,
     default:
             break;
     }
+    BMK_profEnd(BMK_prof_output, tStart);
+    BMK_profFileEnd(fileName);
 
     return 0;
 }
@@ -864,6 +5685,38 @@ static int BMK_hashFiles(const char** fnList, int fnTotal,
     return result;
 }
 
+#ifdef XXH_STATS
+/* BMK_displayStats() :
+ * Displays library counters (--stats), for algorithms which have been used */
+static void BMK_displayStats(void)
+{
+    static const char* const pathNames[XXH_path_count] =
+        { "aligned", "unaligned", "shld", "simd", "neon", "fallback" };
+    XXH_stats_t stats;
+    int k;
+
+    XXH_getStats(&stats);
+    for (k=0; k<4; k++) {
+        const XXH_algoStats_t* const a = stats.algo + k;
+        int i;
+        if (!a->calls && !a->updates) continue;
+        DISPLAY("%-7s: %llu calls, %llu updates (%llu staged, %llu flushes), %llu bytes \n", g_kernelNames[k],
+                (unsigned long long)a->calls, (unsigned long long)a->updates,
+                (unsigned long long)a->staged, (unsigned long long)a->flushes, (unsigned long long)a->bytes);
+        DISPLAY("%9s", "loops :");
+        for (i=0; i<XXH_path_count; i++) DISPLAY(" %s %llu", pathNames[i], (unsigned long long)a->paths[i]);
+        DISPLAY(" \n");
+        if (!a->calls) continue;
+        DISPLAY("%9s", "sizes :");
+        for (i=0; i<XXH_STATS_NB_LENGTHS; i++) {
+            if (i < XXH_STATS_NB_LENGTHS-1) DISPLAY(" <=%u:%llu", 8U << i, (unsigned long long)a->lengths[i]);
+            else DISPLAY(" >%u:%llu", 8U << (i-1), (unsigned long long)a->lengths[i]);
+        }
+        DISPLAY(" \n");
+    }
+}
+#endif
+
 
 typedef enum {
     GetLine_ok,
@@ -1117,6 +5970,7 @@ static void parseFile1(ParseFileArg* parseFileArg)
         LineStatus lineStatus = LineStatus_hashFailed;
         GetLineResult getLineResult;
         ParsedLine parsedLine;
+        BMK_time_t tStart = BMK_profStart();
         memset(&parsedLine, 0, sizeof(parsedLine));
 
         lineNumber++;
@@ -1130,6 +5984,7 @@ static void parseFile1(ParseFileArg* parseFileArg)
 
         getLineResult = getLine(&parseFileArg->lineBuf, &parseFileArg->lineMax,
                                 parseFileArg->inFile);
+        BMK_profEnd(BMK_prof_parse, tStart);
         if (getLineResult != GetLine_ok) {
             if (getLineResult == GetLine_eof) break;
 
@@ -1157,7 +6012,9 @@ static void parseFile1(ParseFileArg* parseFileArg)
             break;
         }
 
+        tStart = BMK_profStart();
         if (parseLine(&parsedLine, parseFileArg->lineBuf) != ParseLine_ok) {
+            BMK_profEnd(BMK_prof_parse, tStart);
             report->nImproperlyFormattedLines++;
             if (parseFileArg->warn) {
                 DISPLAY("%s:%lu: Error: improperly formatted checksum line\n",
@@ -1168,6 +6025,7 @@ static void parseFile1(ParseFileArg* parseFileArg)
 
         if (report->xxhBits != 0 && report->xxhBits != parsedLine.xxhBits) {
             /* Don't accept xxh32/xxh64 mixed file */
+            BMK_profEnd(BMK_prof_parse, tStart);
             report->nImproperlyFormattedLines++;
             report->nMixedFormatLines++;
             if (parseFileArg->warn) {
@@ -1177,15 +6035,20 @@ static void parseFile1(ParseFileArg* parseFileArg)
             continue;
         }
 
+        BMK_profEnd(BMK_prof_parse, tStart);
         report->nProperlyFormattedLines++;
         if (report->xxhBits == 0) {
             report->xxhBits = parsedLine.xxhBits;
         }
 
+        BMK_profFileBegin();
+        tStart = BMK_profStart();
         fp = fopen(parsedLine.filename, "rb");
+        BMK_profEnd(BMK_prof_meta, tStart);
         if (fp == NULL) {
             lineStatus = LineStatus_failedToOpen;
         } else {
+            BMK_PROBE1(file_open, parsedLine.filename);
             lineStatus = LineStatus_hashFailed;
             switch (parsedLine.xxhBits)
             {
@@ -1209,9 +6072,15 @@ static void parseFile1(ParseFileArg* parseFileArg)
             default:
                 break;
             }
+            tStart = BMK_profStart();
             fclose(fp);
+            BMK_profEnd(BMK_prof_meta, tStart);
+            BMK_PROBE1(file_close, parsedLine.filename);
         }
+        BMK_PROBE2(check_verdict, parsedLine.filename,
+                   (lineStatus == LineStatus_hashOk) ? 0 : (lineStatus == LineStatus_hashFailed) ? 1 : 2);
 
+        tStart = BMK_profStart();
         switch (lineStatus)
         {
         default:
@@ -1243,6 +6112,8 @@ static void parseFile1(ParseFileArg* parseFileArg)
             }   }
             break;
         }
+        BMK_profEnd(BMK_prof_output, tStart);
+        if (lineStatus != LineStatus_failedToOpen) BMK_profFileEnd(parsedLine.filename);
     }   /* while (!report->quit) */
 }
 
@@ -1288,7 +6159,9 @@ static int checkFile(const char* inFileName,
          * Don't set binary mode for stdin */
         inFile = stdin;
     } else {
+        BMK_time_t const tStart = BMK_profStart();
         inFile = fopen( inFileName, "rt" );
+        BMK_profEnd(BMK_prof_meta, tStart);
     }
 
     if (inFile == NULL) {
@@ -1394,8 +6267,43 @@ static int usage_advanced(const char* exename)
     DISPLAY( " --little-endian : Print hash using little endian convention (default: big endian)\n");
     DISPLAY( " -V, --version   : Display version\n");
     DISPLAY( " -h, --help      : Display long help and exit\n");
+#ifdef XXH_STATS
+    DISPLAY( " --stats         : Display library counters after hashing or -b (XXH_STATS build)\n");
+#endif
+    DISPLAY( " --profile[=#]   : Display time spent in metadata, read, hash, output and parse, and # slowest files (default %u)\n", PROFILE_DEFAULT_SLOWEST);
     DISPLAY( " -b  : Run benchmark and sanity test \n");
     DISPLAY( " -i# : number of iterations for benchmark mode (default %u)\n", g_nbIterations);
+    DISPLAY( " --sweep[=#] : benchmark all algorithms over sizes from 1 byte to # bytes (default %u MB)\n",
+                (U32)(SWEEP_DEFAULT_MAX >> 20));
+    DISPLAY( " --auto-audit[=#] : compare kernels selected by _auto variants with the fastest, up to # bytes (default %u KB)\n",
+                (U32)(AUDIT_DEFAULT_MAX >> 10));
+    DISPLAY( " --csv, --json : machine-readable benchmark output\n");
+    DISPLAY( " --populate, --hugepages : map benchmarked files with MAP_POPULATE, MADV_HUGEPAGE\n");
+    DISPLAY( " --latency : also measure latency of dependent hash calls\n");
+    DISPLAY( " --samples[=#] : robust mode : pin, warm up, report distribution of # samples (default %u)\n", SAMPLES_DEFAULT);
+    DISPLAY( " --counters : also collect hardware performance counters (Linux)\n");
+    DISPLAY( " --stream : benchmark streaming API over update sizes from 1 byte to 1 MB (total : -B#)\n");
+    DISPLAY( " --offsets : benchmark input starting at offsets 0 to 63 of a cache line (size : -B#)\n");
+    DISPLAY( " --cold[=MODE] : benchmark with input out of cache (pool, fresh, flush), next to memcpy/read bandwidth\n");
+    DISPLAY( " --save-baseline=FILE : benchmark a fixed matrix of cases, and save results into FILE\n");
+    DISPLAY( " --baseline=FILE : benchmark the same matrix, and fail if a case is slower than in FILE\n");
+    DISPLAY( " --threshold=# : tolerated slow down with --baseline, in %% (default %u)\n", REGRESS_DEFAULT_THRESHOLD);
+    DISPLAY( " --io FILES : hash FILES with buffered, mmap and direct I/O, timing I/O and hashing separately (-H#)\n");
+    DISPLAY( " -T#  : benchmark scaling from 1 to # threads (combine with -b# to select algorithm)\n");
+    DISPLAY( " --keys FILE : benchmark keys from FILE, one per line\n");
+    DISPLAY( " --keys-u32 FILE : same, each key preceded by its 32-bit little-endian length\n");
+    DISPLAY( " --table[=#] : benchmark a hash table with # keys (default %u), or keys from --keys\n", TABLE_DEFAULT_NB_KEYS);
+    DISPLAY( " --bloom[=#] : benchmark xxh_bloom.h against a classic Bloom filter, with # keys (default %u), or keys from --keys\n", TABLE_DEFAULT_NB_KEYS);
+    DISPLAY( " --bloom-bits=# : bits per key of --bloom filters (default %u)\n", BLOOM_DEFAULT_BITS_PER_KEY);
+    DISPLAY( " --hll[=#] : benchmark the HyperLogLog sketch of xxh_hll.h, with # keys (default %u), or keys from --keys\n", TABLE_DEFAULT_NB_KEYS);
+    DISPLAY( " --hll-precision=# : --hll sketches have 2^# registers, %u-%u (default %u)\n", XXH_HLL_MIN_PRECISION, XXH_HLL_MAX_PRECISION, HLL_DEFAULT_PRECISION);
+    DISPLAY( " --cms[=#] : benchmark the frequency sketches of xxh_cms.h over a skewed stream of # events (default %u), or keys from --keys\n", TABLE_DEFAULT_NB_KEYS);
+    DISPLAY( " --cms-width=# : counters per row of --cms sketches (default %u)\n", CMS_DEFAULT_WIDTH);
+    DISPLAY( " --cms-depth=# : rows of --cms sketches, 1-%u (default %u)\n", XXH_CMS_MAX_DEPTH, CMS_DEFAULT_DEPTH);
+    DISPLAY( " --minhash[=#] : benchmark the MinHash signatures of xxh_minhash.h over # tokens (default %u), or keys from --keys\n", TABLE_DEFAULT_NB_KEYS);
+    DISPLAY( " --minhash-slots=# : signature length of --minhash, a multiple of 4 up to %u (default %u)\n", XXH_MINHASH_MAX_SLOTS, MINHASH_DEFAULT_SLOTS);
+    DISPLAY( " --selftest : check companion modules (xxh_bloom.h, xxh_map.h, xxh_hll.h, xxh_cms.h, xxh_minhash.h), exit non-zero on failure\n");
+    DISPLAY( " --key-len=#[-#] : length of generated keys (default %u-%u)\n", TABLE_DEFAULT_MIN_LENGTH, TABLE_DEFAULT_MAX_LENGTH);
     DISPLAY( "\n");
     DISPLAY( "The following four options are useful only when verifying checksums (-c):\n");
     DISPLAY( "--strict : don't print OK for each successfully verified file\n");
@@ -1433,6 +6341,19 @@ static unsigned readU32FromChar(const char** stringPtr)
     return result;
 }
 
+/*! longCommandWArg() :
+ *  check if *stringPtr is the same as longCommand.
+ *  If yes, @return 1 and advances *stringPtr to the position which immediately follows longCommand.
+ *  @return 0 and doesn't modify *stringPtr otherwise.
+ */
+static unsigned longCommandWArg(const char** stringPtr, const char* longCommand)
+{
+    size_t const comSize = strlen(longCommand);
+    int const result = !strncmp(*stringPtr, longCommand, comSize);
+    if (result) *stringPtr += comSize;
+    return result;
+}
+
 int main(int argc, const char** argv)
 {
     int i, filenamesStart = 0;
@@ -1444,9 +6365,41 @@ int main(int argc, const char** argv)
     U32 warn          = 0;
     U32 quiet         = 0;
     U32 specificTest  = 0;
+    U32 sweepMode     = 0;
+    U32 nbThreads     = 0;
+    U32 streamMode    = 0;
+    U32 coldMode      = 0;
+    U32 offsetsMode   = 0;
+    U32 ioMode        = 0;
+    BMK_cold_e coldOnly = BMK_cold_max;
+    const char* baselineName = NULL;
+    const char* saveBaselineName = NULL;
+    U32 regressThreshold = REGRESS_DEFAULT_THRESHOLD;
+    U32 tableMode     = 0;
+    size_t tableNbKeys = TABLE_DEFAULT_NB_KEYS;
+    U32 bloomMode     = 0;
+    U32 bloomBitsPerKey = BLOOM_DEFAULT_BITS_PER_KEY;
+    U32 hllMode       = 0;
+    U32 hllPrecision  = HLL_DEFAULT_PRECISION;
+    U32 cmsMode       = 0;
+    U32 cmsWidth      = CMS_DEFAULT_WIDTH;
+    U32 cmsDepth      = CMS_DEFAULT_DEPTH;
+    U32 minhashMode   = 0;
+    U32 selfTestMode  = 0;
+    U32 minhashSlots  = MINHASH_DEFAULT_SLOTS;
+    size_t keyMinLength = TABLE_DEFAULT_MIN_LENGTH;
+    size_t keyMaxLength = TABLE_DEFAULT_MAX_LENGTH;
+    U32 auditMode     = 0;
+    size_t auditMax   = AUDIT_DEFAULT_MAX;
+    size_t sweepMax   = SWEEP_DEFAULT_MAX;
+    const char* keysFileName = NULL;
+    BMK_keysFormat_e keysFormat = BMK_keys_lines;
     size_t keySize    = XXH_DEFAULT_SAMPLE_SIZE;
     algoType algo     = g_defaultAlgo;
     endianess displayEndianess = big_endian;
+#ifdef XXH_STATS
+    int displayStats = 0;
+#endif
 
     /* special case : xxh32sum default to 32 bits checksum */
     if (strstr(exename, "xxh32sum") != NULL) algo = algo_xxh32;
@@ -1459,6 +6412,9 @@ int main(int argc, const char** argv)
         if(!argument) continue;   /* Protection, if argument empty */
 
         if (!strcmp(argument, "--little-endian")) { displayEndianess = little_endian; continue; }
+#ifdef XXH_STATS
+        if (!strcmp(argument, "--stats")) { displayStats = 1; continue; }
+#endif
         if (!strcmp(argument, "--check")) { fileCheckMode = 1; continue; }
         if (!strcmp(argument, "--strict")) { strictMode = 1; continue; }
         if (!strcmp(argument, "--status")) { statusOnly = 1; continue; }
@@ -1466,6 +6422,177 @@ int main(int argc, const char** argv)
         if (!strcmp(argument, "--warn")) { warn = 1; continue; }
         if (!strcmp(argument, "--help")) { return usage_advanced(exename); }
         if (!strcmp(argument, "--version")) { DISPLAY(WELCOME_MESSAGE(exename)); return 0; }
+        if (!strcmp(argument, "--csv")) { g_outputFormat = BMK_format_csv; continue; }
+        if (!strcmp(argument, "--json")) { g_outputFormat = BMK_format_json; continue; }
+        if (!strcmp(argument, "--latency")) { g_benchLatency = 1; continue; }
+        if (!strcmp(argument, "--counters")) { g_counters = 1; continue; }
+        if (!strcmp(argument, "--populate")) { g_mapPopulate = 1; continue; }
+        if (!strcmp(argument, "--hugepages")) { g_mapHugePages = 1; continue; }
+        if (!strcmp(argument, "--selftest")) { benchmarkMode = 1; selfTestMode = 1; continue; }
+        if (!strcmp(argument, "--stream")) { benchmarkMode = 1; streamMode = 1; continue; }
+        if (!strcmp(argument, "--offsets")) { benchmarkMode = 1; offsetsMode = 1; continue; }
+        if (!strcmp(argument, "--io")) { benchmarkMode = 1; ioMode = 1; continue; }
+        if (!strcmp(argument, "--keys") || !strcmp(argument, "--keys-u32")) {
+            if (i+1 >= argc) return badusage(exename);
+            keysFormat = strcmp(argument, "--keys") ? BMK_keys_u32 : BMK_keys_lines;
+            keysFileName = argv[++i];
+            benchmarkMode = 1;
+            continue;
+        }
+        if (longCommandWArg(&argument, "--baseline=")) { benchmarkMode = 1; baselineName = argument; continue; }
+        if (longCommandWArg(&argument, "--save-baseline=")) { benchmarkMode = 1; saveBaselineName = argument; continue; }
+        if (longCommandWArg(&argument, "--threshold=")) {
+            regressThreshold = readU32FromChar(&argument);
+            if (*argument != 0) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--table")) {
+            benchmarkMode = 1;
+            tableMode = 1;
+            if (*argument == '=') {
+                argument++;
+                tableNbKeys = readU32FromChar(&argument);
+                if (tableNbKeys == 0) return badusage(exename);
+            }
+            if (*argument != 0) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--bloom-bits=")) {
+            bloomBitsPerKey = readU32FromChar(&argument);
+            if ((*argument != 0) || (bloomBitsPerKey == 0)) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--bloom")) {
+            benchmarkMode = 1;
+            bloomMode = 1;
+            if (*argument == '=') {
+                argument++;
+                tableNbKeys = readU32FromChar(&argument);
+                if (tableNbKeys == 0) return badusage(exename);
+            }
+            if (*argument != 0) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--hll-precision=")) {
+            hllPrecision = readU32FromChar(&argument);
+            if ((*argument != 0) || (hllPrecision < XXH_HLL_MIN_PRECISION) || (hllPrecision > XXH_HLL_MAX_PRECISION))
+                return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--hll")) {
+            benchmarkMode = 1;
+            hllMode = 1;
+            if (*argument == '=') {
+                argument++;
+                tableNbKeys = readU32FromChar(&argument);
+                if (tableNbKeys == 0) return badusage(exename);
+            }
+            if (*argument != 0) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--cms-width=")) {
+            cmsWidth = readU32FromChar(&argument);
+            if ((*argument != 0) || (cmsWidth == 0) || (cmsWidth > (1U << XXH_CMS_MAX_WIDTH_LOG))) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--cms-depth=")) {
+            cmsDepth = readU32FromChar(&argument);
+            if ((*argument != 0) || (cmsDepth == 0) || (cmsDepth > XXH_CMS_MAX_DEPTH)) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--cms")) {
+            benchmarkMode = 1;
+            cmsMode = 1;
+            if (*argument == '=') {
+                argument++;
+                tableNbKeys = readU32FromChar(&argument);
+                if (tableNbKeys == 0) return badusage(exename);
+            }
+            if (*argument != 0) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--minhash-slots=")) {
+            minhashSlots = readU32FromChar(&argument);
+            if ((*argument != 0) || (minhashSlots == 0) || (minhashSlots % 4) || (minhashSlots > XXH_MINHASH_MAX_SLOTS))
+                return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--minhash")) {
+            benchmarkMode = 1;
+            minhashMode = 1;
+            if (*argument == '=') {
+                argument++;
+                tableNbKeys = readU32FromChar(&argument);
+                if (tableNbKeys == 0) return badusage(exename);
+            }
+            if (*argument != 0) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--key-len=")) {
+            keyMinLength = keyMaxLength = readU32FromChar(&argument);
+            if (*argument == '-') {
+                argument++;
+                keyMaxLength = readU32FromChar(&argument);
+            }
+            if ((*argument != 0) || (keyMaxLength < keyMinLength)) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--cold")) {
+            benchmarkMode = 1;
+            coldMode = 1;
+            if (*argument == '=') {
+                int m;
+                argument++;
+                for (m=0; m<BMK_cold_max; m++)
+                    if (!strcmp(argument, g_coldNames[m])) coldOnly = (BMK_cold_e)m;
+                if (coldOnly == BMK_cold_max) return badusage(exename);
+            } else if (*argument != 0) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--auto-audit")) {
+            benchmarkMode = 1;
+            auditMode = 1;
+            if (*argument == '=') {
+                argument++;
+                auditMax = readU32FromChar(&argument);
+                if (auditMax == 0) return badusage(exename);
+            }
+            if (*argument != 0) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--profile")) {
+            g_profile.enabled = 1;
+            g_profile.nbSlowest = PROFILE_DEFAULT_SLOWEST;
+            if (*argument == '=') {
+                argument++;
+                g_profile.nbSlowest = readU32FromChar(&argument);
+                if (g_profile.nbSlowest > PROFILE_MAX_SLOWEST) return badusage(exename);
+            }
+            if (*argument != 0) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--samples")) {
+            benchmarkMode = 1;
+            g_nbSamples = SAMPLES_DEFAULT;
+            if (*argument == '=') {
+                argument++;
+                g_nbSamples = readU32FromChar(&argument);
+                if ((g_nbSamples == 0) || (g_nbSamples > BMK_SAMPLES_MAX)) return badusage(exename);
+            }
+            if (*argument != 0) return badusage(exename);
+            continue;
+        }
+        if (longCommandWArg(&argument, "--sweep")) {
+            benchmarkMode = 1;
+            sweepMode = 1;
+            if (*argument == '=') {
+                argument++;
+                sweepMax = readU32FromChar(&argument);
+                if (sweepMax == 0) return badusage(exename);
+            }
+            if (*argument != 0) return badusage(exename);
+            continue;
+        }
 
         if (*argument!='-') {
             if (filenamesStart==0) filenamesStart=i;   /* only supports a continuous list of filenames */
@@ -1517,6 +6644,14 @@ int main(int argc, const char** argv)
                 g_nbIterations = readU32FromChar(&argument);
                 break;
 
+            /* Multi-threaded scaling (benchmark only) */
+            case 'T':
+                argument++;
+                benchmarkMode = 1;
+                nbThreads = readU32FromChar(&argument);
+                if (nbThreads == 0) return badusage(exename);
+                break;
+
             /* Modify Block size (benchmark only) */
             case 'B':
                 argument++;
@@ -1539,7 +6674,34 @@ int main(int argc, const char** argv)
     if (benchmarkMode) {
         DISPLAYLEVEL(2, WELCOME_MESSAGE(exename) );
         BMK_sanityCheck();
-        if (filenamesStart==0) return BMK_benchInternal(keySize, specificTest);
+        if (selfTestMode) return BMK_selfTest();
+#ifdef XXH_STATS
+        XXH_resetStats();   /* only count benchmark calls */
+#endif
+        if (sweepMode) return BMK_sweep(sweepMax);
+        if (auditMode) return BMK_auditAuto(auditMax, keysFileName, keysFormat);
+        if (baselineName || saveBaselineName) return BMK_benchRegress(baselineName, saveBaselineName, regressThreshold);
+        if (tableMode) return BMK_benchTable(tableNbKeys, keyMinLength, keyMaxLength, keysFileName, keysFormat);
+        if (bloomMode) return BMK_benchBloom(tableNbKeys, bloomBitsPerKey, keyMinLength, keyMaxLength, keysFileName, keysFormat);
+        if (minhashMode) return BMK_benchMinhash(tableNbKeys, minhashSlots, keyMinLength, keyMaxLength, keysFileName, keysFormat);
+        if (cmsMode) return BMK_benchCms(tableNbKeys, cmsWidth, cmsDepth, keyMinLength, keyMaxLength, keysFileName, keysFormat);
+        if (hllMode) return BMK_benchHll(tableNbKeys, hllPrecision, keyMinLength, keyMaxLength, keysFileName, keysFormat);
+        if (keysFileName) return BMK_benchKeys(keysFileName, keysFormat);
+        if (nbThreads) return BMK_benchThreads(nbThreads, specificTest);
+        if (streamMode) return BMK_benchStream(keySize);
+        if (coldMode) return BMK_benchCold(keySize, specificTest, coldOnly);
+        if (offsetsMode) return BMK_benchOffsets(keySize);
+        if (ioMode) {
+            if (filenamesStart==0) return badusage(exename);
+            return BMK_benchIO(argv+filenamesStart, argc-filenamesStart, algo);
+        }
+        if (filenamesStart==0) {
+            int const benchResult = BMK_benchInternal(keySize, specificTest);
+#ifdef XXH_STATS
+            if (displayStats) BMK_displayStats();
+#endif
+            return benchResult;
+        }
         return BMK_benchFiles(argv+filenamesStart, argc-filenamesStart, specificTest);
     }
 
@@ -1547,11 +6709,19 @@ int main(int argc, const char** argv)
     if ( (filenamesStart==0) && IS_CONSOLE(stdin) ) return badusage(exename);
 
     if (filenamesStart==0) filenamesStart = argc;
-    if (fileCheckMode) {
-        return checkFiles(argv+filenamesStart, argc-filenamesStart,
-                          displayEndianess, strictMode, statusOnly, warn, quiet);
-    } else {
-        return BMK_hashFiles(argv+filenamesStart, argc-filenamesStart, algo, displayEndianess);
+    {   BMK_time_t const runStart = BMK_profStart();
+        int result;
+        if (fileCheckMode) {
+            result = checkFiles(argv+filenamesStart, argc-filenamesStart,
+                                displayEndianess, strictMode, statusOnly, warn, quiet);
+        } else {
+            result = BMK_hashFiles(argv+filenamesStart, argc-filenamesStart, algo, displayEndianess);
+#ifdef XXH_STATS
+            if (displayStats) BMK_displayStats();
+#endif
+        }
+        if (g_profile.enabled) BMK_displayProfile(BMK_clockSpanNano(runStart));
+        return result;
     }
 }
 